@@ -0,0 +1,93 @@
+/**
+ * Measures how fast we can read a bios CSV.
+ *
+ * Usage: bench/csv_bio_reader_bench DATA.csv
+ *
+ * We compare CsvBioReader (fread() plus memchr()) against MmapCsvBioReader
+ * (mmap() plus CsvStructuralIndex), and we time the structural scan alone.
+ * The file is read once before timing, so the page cache is warm.
+ */
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include "csv_bio_reader.h"
+#include "csv_structural_index.h"
+#include "mapped_file.h"
+#include "mmap_csv_bio_reader.h"
+
+namespace {
+
+const int NRuns = 5;
+
+/**
+ * Runs f NRuns times and prints the best throughput.
+ */
+template<typename F>
+void
+bench(const char* name, size_t nBytes, F f)
+{
+  double bestSeconds = 1e99;
+  size_t result = 0;
+
+  for (int i = 0; i < NRuns; i++) {
+    auto start = std::chrono::steady_clock::now();
+    result = f();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (elapsed.count() < bestSeconds) bestSeconds = elapsed.count();
+  }
+
+  std::cout << name << ": " << (nBytes / bestSeconds / 1e9) << " GB/s (result " << result << ")" << std::endl;
+}
+
+} // namespace ""
+
+int
+main(int argc, char** argv)
+{
+  if (argc != 2) {
+    std::cerr << "Usage: " << argv[0] << " DATA.csv" << std::endl;
+    exit(1);
+  }
+
+  const char* filename = argv[1];
+  twittok::MappedFile file(filename);
+
+  std::cout << "Read " << file.size() << " bytes. CsvStructuralIndex uses " << twittok::CsvStructuralIndex::implementationName() << "." << std::endl;
+
+  bench("CsvStructuralIndex::scanBlock", file.size(), [&]() {
+    size_t n = 0;
+    const char* p = file.begin();
+    for (; p + twittok::CsvStructuralIndex::BlockSize <= file.end(); p += twittok::CsvStructuralIndex::BlockSize) {
+      auto block = twittok::CsvStructuralIndex::scanBlock(p);
+      n += __builtin_popcountll(block.commas | block.quotes | block.newlines);
+    }
+    return n;
+  });
+
+  bench("CsvBioReader", file.size(), [&]() {
+    twittok::CsvBioReader reader(filename);
+    twittok::CsvBioReader::Error error;
+    size_t n = 0;
+    while (true) {
+      auto bio = reader.nextBio(&error);
+      if (error != twittok::CsvBioReader::Error::Success) break;
+      n += bio.utf8.size();
+    }
+    return n;
+  });
+
+  bench("MmapCsvBioReader", file.size(), [&]() {
+    twittok::MmapCsvBioReader reader(file.begin(), file.end());
+    twittok::CsvBioReader::Error error;
+    size_t n = 0;
+    while (true) {
+      auto bio = reader.nextBio(&error);
+      if (error != twittok::CsvBioReader::Error::Success) break;
+      n += bio.utf8.size();
+    }
+    return n;
+  });
+
+  return 0;
+}
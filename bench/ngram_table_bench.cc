@@ -0,0 +1,145 @@
+/**
+ * Measures how fast NgramPass can count ngrams and look up prefixes.
+ *
+ * Usage: bench/ngram_table_bench [N_TOKENS]
+ *
+ * We generate a stream of token ids with a Zipf-like distribution, as in real
+ * bios, and count every bigram in it. We compare the maps NgramPass used to
+ * use (std::unordered_map keyed on space-joined stems, then keyed on
+ * NgramKey) against FlatHashMap. Then we look up every unigram in a set of
+ * frequent prefixes, the same three ways.
+ */
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "flat_hash_map.h"
+#include "ngram.h"
+#include "ngram_info.h"
+
+namespace {
+
+const int NRuns = 3;
+const size_t VocabularySize = 200000;
+const size_t MinCount = 100;
+
+/**
+ * Runs f NRuns times and prints the best throughput.
+ */
+template<typename F>
+void
+bench(const char* name, size_t nOps, F f)
+{
+  double bestSeconds = 1e99;
+  size_t result = 0;
+
+  for (int i = 0; i < NRuns; i++) {
+    auto start = std::chrono::steady_clock::now();
+    result = f();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (elapsed.count() < bestSeconds) bestSeconds = elapsed.count();
+  }
+
+  std::cout << name << ": " << (nOps / bestSeconds / 1e6) << " Mops/s (result " << result << ")" << std::endl;
+}
+
+std::vector<twittok::TokenId>
+generateTokens(size_t n)
+{
+  std::mt19937 random(1);
+  std::uniform_real_distribution<double> uniform(0, 1);
+  const double logV = std::log(static_cast<double>(VocabularySize));
+
+  std::vector<twittok::TokenId> ret(n);
+  for (auto& id : ret) {
+    id = static_cast<twittok::TokenId>(std::exp(uniform(random) * logV)) - 1;
+  }
+  return ret;
+}
+
+std::string
+joined(const std::vector<std::string>& stems, twittok::TokenId a, twittok::TokenId b)
+{
+  return stems[a] + " " + stems[b];
+}
+
+} // namespace ""
+
+int
+main(int argc, char** argv)
+{
+  const size_t nTokens = argc > 1 ? std::strtoull(argv[1], NULL, 10) : 10000000;
+  const size_t nBigrams = nTokens - 1;
+
+  const auto tokens = generateTokens(nTokens);
+  std::vector<std::string> stems(VocabularySize);
+  for (size_t i = 0; i < VocabularySize; i++) stems[i] = "stem" + std::to_string(i);
+
+  typedef twittok::NgramKey<1> Key1;
+  typedef twittok::NgramKey<2> Key2;
+
+  std::cout << "Counting " << nBigrams << " bigrams over " << VocabularySize << " token ids" << std::endl;
+
+  bench("std::unordered_map<std::string, NgramInfo>", nBigrams, [&]() {
+    std::unordered_map<std::string, twittok::NgramInfo> map;
+    for (size_t i = 0; i < nBigrams; i++) map[joined(stems, tokens[i], tokens[i + 1])].nClinton++;
+    return map.size();
+  });
+
+  bench("std::unordered_map<NgramKey<2>, NgramInfo>", nBigrams, [&]() {
+    std::unordered_map<Key2, twittok::NgramInfo, twittok::NgramKeyHash> map;
+    for (size_t i = 0; i < nBigrams; i++) map[Key2{ tokens[i], tokens[i + 1] }].nClinton++;
+    return map.size();
+  });
+
+  size_t flatBytes = 0;
+  bench("FlatHashMap<NgramKey<2>, NgramInfo>", nBigrams, [&]() {
+    twittok::FlatHashMap<Key2, twittok::NgramInfo, twittok::NgramKeyHash> map;
+    for (size_t i = 0; i < nBigrams; i++) map[Key2{ tokens[i], tokens[i + 1] }].nClinton++;
+    flatBytes = map.nBytes();
+    return map.size();
+  });
+  std::cout << "FlatHashMap<NgramKey<2>, NgramInfo> uses " << (flatBytes / 1024 / 1024) << "MB" << std::endl;
+
+  // Prefixes: the unigrams that appear at least MinCount times
+  std::vector<size_t> counts(VocabularySize);
+  for (auto id : tokens) counts[id]++;
+
+  std::unordered_set<std::string> stringPrefixes;
+  std::unordered_set<Key1, twittok::NgramKeyHash> keyPrefixes;
+  twittok::FlatHashSet<Key1, twittok::NgramKeyHash> flatPrefixes;
+  for (size_t i = 0; i < VocabularySize; i++) {
+    if (counts[i] < MinCount) continue;
+    stringPrefixes.insert(stems[i]);
+    keyPrefixes.insert(Key1{ static_cast<twittok::TokenId>(i) });
+    flatPrefixes.insert(Key1{ static_cast<twittok::TokenId>(i) });
+  }
+
+  std::cout << "Looking up " << nTokens << " prefixes in a set of " << flatPrefixes.size() << std::endl;
+
+  bench("std::unordered_set<std::string>", nTokens, [&]() {
+    size_t n = 0;
+    for (auto id : tokens) n += stringPrefixes.count(stems[id]);
+    return n;
+  });
+
+  bench("std::unordered_set<NgramKey<1>>", nTokens, [&]() {
+    size_t n = 0;
+    for (auto id : tokens) n += keyPrefixes.count(Key1{ id });
+    return n;
+  });
+
+  bench("FlatHashSet<NgramKey<1>>", nTokens, [&]() {
+    size_t n = 0;
+    for (auto id : tokens) n += flatPrefixes.contains(Key1{ id });
+    return n;
+  });
+
+  return 0;
+}
@@ -0,0 +1,114 @@
+/**
+ * Measures how fast we can Porter2-stem a vocabulary.
+ *
+ * Usage: bench/porter2_stemmer_bench WORDS.txt
+ *
+ * WORDS.txt holds one word per line: for instance, the distinct words of a
+ * bios CSV, from `tr -cs 'a-z' '\n' < DATA.csv | sort -u`. We keep the words
+ * stemmer::stem() would pass to Porter2: lowercase a-z, up to
+ * stemmer::MaxBytesToStem bytes.
+ *
+ * We check that porter2::stem() (on a stack buffer) stems every word exactly
+ * like Porter2Stemmer::stem() (on a std::string), then time both.
+ */
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "porter2_buffer_stemmer.h"
+#include "porter2_stemmer.h"
+#include "stemmer.h"
+
+namespace {
+
+const int NRuns = 5;
+
+/**
+ * Runs f NRuns times and prints the best throughput.
+ */
+template<typename F>
+void
+bench(const char* name, size_t nWords, F f)
+{
+  double bestSeconds = 1e99;
+  size_t result = 0;
+
+  for (int i = 0; i < NRuns; i++) {
+    auto start = std::chrono::steady_clock::now();
+    result = f();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (elapsed.count() < bestSeconds) bestSeconds = elapsed.count();
+  }
+
+  std::cout << name << ": " << (nWords / bestSeconds / 1e6) << " Mwords/s (result " << result << ")" << std::endl;
+}
+
+bool
+isStemmable(const std::string& word)
+{
+  if (word.empty() || word.size() > twittok::stemmer::MaxBytesToStem) return false;
+  for (char c : word) {
+    if (c < 'a' || c > 'z') return false;
+  }
+  return true;
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+  if (argc != 2) {
+    std::cerr << "Usage: " << argv[0] << " WORDS.txt" << std::endl;
+    return 1;
+  }
+
+  std::vector<std::string> words;
+  std::ifstream in(argv[1]);
+  std::string line;
+  while (std::getline(in, line)) {
+    if (isStemmable(line)) words.push_back(line);
+  }
+  std::cout << "Stemming " << words.size() << " words" << std::endl;
+
+  size_t nMismatches = 0;
+  for (const auto& word : words) {
+    std::string expected(word);
+    Porter2Stemmer::stem(expected);
+
+    twittok::porter2::Buffer buffer;
+    const auto actual = twittok::porter2::stem(word.data(), word.size(), &buffer);
+    if (actual != expected) {
+      if (nMismatches < 10) std::cerr << "Mismatch: " << word << " -> " << expected << " vs " << actual << std::endl;
+      nMismatches++;
+    }
+  }
+  if (nMismatches > 0) {
+    std::cerr << nMismatches << " words stemmed differently" << std::endl;
+    return 1;
+  }
+
+  bench("Porter2Stemmer::stem(std::string&)", words.size(), [&]() {
+    size_t nBytes = 0;
+    for (const auto& word : words) {
+      std::string stemmed(word);
+      Porter2Stemmer::stem(stemmed);
+      nBytes += stemmed.size();
+    }
+    return nBytes;
+  });
+
+  bench("porter2::stem(Buffer*)", words.size(), [&]() {
+    size_t nBytes = 0;
+    twittok::porter2::Buffer buffer;
+    for (const auto& word : words) {
+      nBytes += twittok::porter2::stem(word.data(), word.size(), &buffer).size();
+    }
+    return nBytes;
+  });
+
+  return 0;
+}
@@ -0,0 +1,102 @@
+/**
+ * Measures Porter2 steps 2, 3 and 4's suffix matching on its own.
+ *
+ * Usage: bench/porter2_suffix_table_bench WORDS.txt
+ *
+ * WORDS.txt holds one word per line, as for porter2_stemmer_bench. For each
+ * step, we find the first rule that matches each word, by trying every rule
+ * in order (as Porter2Stemmer does) and with the step's SuffixTable. We look
+ * for suffixes anywhere in the word, as if R1 and R2 started at 0, so every
+ * rule that ends the word matches.
+ */
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "porter2_suffix_table.h"
+
+namespace {
+
+const int NRuns = 5;
+
+/**
+ * Runs f NRuns times and prints the best throughput.
+ */
+template<typename F>
+void
+bench(const char* name, size_t nWords, F f)
+{
+  double bestSeconds = 1e99;
+  size_t result = 0;
+
+  for (int i = 0; i < NRuns; i++) {
+    auto start = std::chrono::steady_clock::now();
+    result = f();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (elapsed.count() < bestSeconds) bestSeconds = elapsed.count();
+  }
+
+  std::cout << name << ": " << (nWords / bestSeconds / 1e6) << " Mwords/s (result " << result << ")" << std::endl;
+}
+
+/**
+ * Returns the index of the first rule that ends word, or NRules.
+ */
+template<size_t NRules>
+size_t
+findLinear(const twittok::porter2::SuffixRule (&rules)[NRules], const std::string& word)
+{
+  for (size_t i = 0; i < NRules; i++) {
+    const auto& rule(rules[i]);
+    if (rule.size <= word.size() && memcmp(word.data() + word.size() - rule.size, rule.suffix, rule.size) == 0) return i;
+  }
+  return NRules;
+}
+
+template<size_t NRules>
+void
+benchStep(const char* name, const twittok::porter2::SuffixRule (&rules)[NRules], const twittok::porter2::SuffixTable<NRules>& table, const std::vector<std::string>& words)
+{
+  std::cout << name << " (" << NRules << " rules)" << std::endl;
+
+  bench("  every rule in order", words.size(), [&]() {
+    size_t nFound = 0;
+    for (const auto& word : words) nFound += findLinear(rules, word) != NRules;
+    return nFound;
+  });
+
+  bench("  SuffixTable", words.size(), [&]() {
+    size_t nFound = 0;
+    for (const auto& word : words) nFound += table.find(word.data(), word.size(), 0) != NULL;
+    return nFound;
+  });
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+  if (argc != 2) {
+    std::cerr << "Usage: " << argv[0] << " WORDS.txt" << std::endl;
+    return 1;
+  }
+
+  std::vector<std::string> words;
+  std::ifstream in(argv[1]);
+  std::string line;
+  while (std::getline(in, line)) {
+    if (!line.empty()) words.push_back(line);
+  }
+  std::cout << "Matching " << words.size() << " words" << std::endl;
+
+  benchStep("Step 2", twittok::porter2::Step2Rules, twittok::porter2::Step2Table, words);
+  benchStep("Step 3", twittok::porter2::Step3Rules, twittok::porter2::Step3Table, words);
+  benchStep("Step 4", twittok::porter2::Step4Rules, twittok::porter2::Step4Table, words);
+
+  return 0;
+}
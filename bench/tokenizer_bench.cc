@@ -0,0 +1,98 @@
+/**
+ * Measures how fast we can tokenize bios, and checks that both Tokenizer
+ * backends agree on them.
+ *
+ * Usage: bench/tokenizer_bench DATA.csv
+ *
+ * We read every bio into memory first, then compare the Re2 backend (RE2
+ * searching from each position) against the Dfa backend (token_dfa.i, with
+ * RE2 for non-ASCII tokens). Before timing, we tokenize every bio both ways
+ * and stop if any bio's tokens differ.
+ */
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "mmap_csv_bio_reader.h"
+#include "tokenizer.h"
+
+namespace {
+
+const int NRuns = 5;
+
+/**
+ * Runs f NRuns times and prints the best throughput.
+ */
+template<typename F>
+void
+bench(const char* name, size_t nBytes, F f)
+{
+  double bestSeconds = 1e99;
+  size_t result = 0;
+
+  for (int i = 0; i < NRuns; i++) {
+    auto start = std::chrono::steady_clock::now();
+    result = f();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (elapsed.count() < bestSeconds) bestSeconds = elapsed.count();
+  }
+
+  std::cout << name << ": " << (nBytes / bestSeconds / 1e6) << " MB/s (result " << result << ")" << std::endl;
+}
+
+size_t
+countTokens(const twittok::Tokenizer& tokenizer, const std::vector<twittok::UntokenizedBioRef>& bios)
+{
+  size_t n = 0;
+  for (const auto& bio : bios) {
+    n += tokenizer.tokenize(re2::StringPiece(bio.utf8.data(), bio.utf8.size())).size();
+  }
+  return n;
+}
+
+} // namespace ""
+
+int
+main(int argc, char** argv)
+{
+  if (argc != 2) {
+    std::cerr << "Usage: " << argv[0] << " DATA.csv" << std::endl;
+    exit(1);
+  }
+
+  twittok::MmapCsvBioReader reader(argv[1]);
+  twittok::CsvBioReader::Error error;
+  std::vector<twittok::UntokenizedBioRef> bios;
+  size_t nBytes = 0;
+  while (true) {
+    auto bio = reader.nextBio(&error);
+    if (error != twittok::CsvBioReader::Error::Success) break;
+    if (bio.empty()) continue;
+    bios.push_back(bio);
+    nBytes += bio.utf8.size();
+  }
+
+  std::cout << "Read " << bios.size() << " bios, " << nBytes << " bytes" << std::endl;
+
+  const twittok::Tokenizer re2Tokenizer(twittok::Tokenizer::Backend::Re2);
+  const twittok::Tokenizer dfaTokenizer(twittok::Tokenizer::Backend::Dfa);
+
+  size_t nMismatches = 0;
+  for (const auto& bio : bios) {
+    const re2::StringPiece text(bio.utf8.data(), bio.utf8.size());
+    if (re2Tokenizer.tokenize(text) != dfaTokenizer.tokenize(text)) {
+      if (nMismatches < 10) std::cerr << "Mismatch: " << text << std::endl;
+      nMismatches++;
+    }
+  }
+  if (nMismatches > 0) {
+    std::cerr << nMismatches << " bios tokenized differently" << std::endl;
+    exit(1);
+  }
+
+  bench("Tokenizer::Backend::Re2", nBytes, [&]() { return countTokens(re2Tokenizer, bios); });
+  bench("Tokenizer::Backend::Dfa", nBytes, [&]() { return countTokens(dfaTokenizer, bios); });
+
+  return 0;
+}
@@ -0,0 +1,371 @@
+#!/usr/bin/env ruby
+
+# Compiles src/token_regex.i into src/token_dfa.i: a DFA, as C++ tables, that
+# finds the same tokens RE2 does, as long as they're ASCII.
+#
+# RE2 matches token_re "leftmost-first": of all the ways to match at a given
+# position, it picks the one a backtracking engine would find first. We build
+# a DFA with the same semantics, the way RE2 itself does: each DFA state is an
+# *ordered* list of NFA threads, highest-priority first, and when a thread
+# matches we drop every thread after it. Scanning, we remember the last
+# position where a state matched and stop when no threads are left.
+#
+# We only handle ASCII input. Every character class is cut down to its ASCII
+# members, and any byte >= 0x80 maps to a "fallback" class: when the tokenizer
+# sees one, it asks RE2 about this token instead. That keeps the DFA small and
+# exact: it never has to know what \pL means outside ASCII.
+#
+# We parse the regex out of src/token_regex.i rather than rebuilding it, so the
+# DFA is guaranteed to describe the same grammar RE2 compiles.
+
+InFile = File.expand_path('../../src/token_regex.i', __FILE__)
+OutFile = File.expand_path('../../src/token_dfa.i', __FILE__)
+
+AllAscii = (1 << 128) - 1
+
+def ascii_range(lo, hi)
+  hi = [hi, 127].min
+  return 0 if lo > hi
+  ((1 << (hi - lo + 1)) - 1) << lo
+end
+
+def ascii_chars(s)
+  s.each_char.reduce(0) { |set, c| set | ascii_range(c.ord, c.ord) }
+end
+
+# ASCII members of the Unicode classes token_re uses
+Properties = {
+  'L' => ascii_chars(('A'..'Z').to_a.join + ('a'..'z').to_a.join),
+  'N' => ascii_chars('0123456789'),
+  'Nd' => ascii_chars('0123456789'),
+  'M' => 0,
+  'Cyrillic' => 0,
+}
+
+# Reads the C string literal out of token_regex.i
+def read_token_re
+  source = File.read(InFile)
+  literal = source[/token_re = "((?:[^"\\]|\\.)*)";/m, 1] or raise "Could not find token_re in #{InFile}"
+  literal.gsub(/\\(.)/) do
+    case $1
+    when '\\', '"' then $1
+    when 't' then "\t"
+    when 'n' then "\n"
+    when 'v' then "\v"
+    when 'f' then "\f"
+    when 'r' then "\r"
+    else raise "Unsupported C escape: \\#{$1}"
+    end
+  end
+end
+
+# Parses the subset of RE2 syntax token_re uses into an AST:
+#
+#   [:set, ascii_bitmask]
+#   [:cat, [node, ...]]
+#   [:alt, [node, ...]]  (leftmost alternative first)
+#   [:star, node], [:plus, node], [:quest, node]  (all greedy)
+class Parser
+  def initialize(re)
+    @re = re
+    @pos = 0
+  end
+
+  def parse
+    node = parse_alt
+    raise "Unexpected #{peek.inspect} at #{@pos}" if @pos < @re.size
+    node
+  end
+
+  private
+
+  def peek
+    @re[@pos]
+  end
+
+  def take
+    c = @re[@pos] or raise 'Unexpected end of regex'
+    @pos += 1
+    c
+  end
+
+  def expect(s)
+    raise "Expected #{s.inspect} at #{@pos}" unless @re[@pos, s.size] == s
+    @pos += s.size
+  end
+
+  def parse_alt
+    alternatives = [parse_cat]
+    while peek == '|'
+      take
+      alternatives << parse_cat
+    end
+    alternatives.size == 1 ? alternatives[0] : [:alt, alternatives]
+  end
+
+  def parse_cat
+    nodes = []
+    while peek && peek != '|' && peek != ')'
+      nodes << parse_repeat
+    end
+    [:cat, nodes]
+  end
+
+  def parse_repeat
+    node = parse_atom
+    while (op = { '*' => :star, '+' => :plus, '?' => :quest }[peek])
+      take
+      raise "Non-greedy repetition at #{@pos} is unsupported" if peek == '?'
+      node = [op, node]
+    end
+    node
+  end
+
+  def parse_atom
+    c = take
+    case c
+    when '('
+      @pos += 2 if @re[@pos, 2] == '?:' # we never capture, so all groups are alike
+      node = parse_alt
+      expect(')')
+      node
+    when '['
+      parse_class
+    when '\\'
+      [:set, parse_escape]
+    when '.', '^', '$', '{'
+      raise "Unsupported #{c.inspect} at #{@pos - 1}"
+    else
+      [:set, ascii_chars(c)]
+    end
+  end
+
+  # Returns an ASCII bitmask
+  def parse_escape
+    c = take
+    case c
+    when 'x'
+      expect('{')
+      hex = ''
+      hex << take while peek != '}'
+      take
+      cp = hex.to_i(16)
+      ascii_range(cp, cp)
+    when 'p'
+      name = if peek == '{'
+        take
+        s = ''
+        s << take while peek != '}'
+        take
+        s
+      else
+        take
+      end
+      Properties[name] or raise "Unsupported property \\p{#{name}}"
+    when /[[:punct:]]/
+      ascii_chars(c)
+    else
+      raise "Unsupported escape \\#{c} at #{@pos - 1}"
+    end
+  end
+
+  # Parses one class member. Returns [codepoint, nil] for a single character,
+  # or [nil, ascii_bitmask] for a \p class.
+  def parse_class_char
+    c = take
+    return [c.ord, nil] unless c == '\\'
+
+    case peek
+    when 'x'
+      take
+      expect('{')
+      hex = ''
+      hex << take while peek != '}'
+      take
+      [hex.to_i(16), nil]
+    when 'p'
+      [nil, parse_escape]
+    else
+      [take.ord, nil]
+    end
+  end
+
+  def parse_class
+    negated = peek == '^'
+    take if negated
+
+    set = 0
+    until peek == ']'
+      lo, lo_set = parse_class_char
+
+      if lo_set
+        set |= lo_set
+      elsif peek == '-' && @re[@pos + 1] != ']'
+        take
+        hi, hi_set = parse_class_char
+        raise "Bad range at #{@pos}" if hi_set || hi < lo
+        set |= ascii_range(lo, hi)
+      else
+        set |= ascii_range(lo, lo)
+      end
+    end
+    take
+
+    [:set, negated ? AllAscii & ~set : set]
+  end
+end
+
+# A Thompson NFA. Instructions are [:char, ascii_bitmask, out],
+# [:split, preferred, other] and [:match].
+class Nfa
+  attr_reader :insts, :start
+
+  def initialize(ast)
+    @insts = []
+    match = add([:match])
+    @start = compile(ast, match)
+  end
+
+  private
+
+  def add(inst)
+    @insts << inst
+    @insts.size - 1
+  end
+
+  def compile(node, out)
+    case node[0]
+    when :set
+      add([:char, node[1], out])
+    when :cat
+      node[1].reverse.reduce(out) { |next_out, child| compile(child, next_out) }
+    when :alt
+      alternatives = node[1].map { |child| compile(child, out) }
+      alternatives.reverse.reduce { |rest, preferred| add([:split, preferred, rest]) }
+    when :star
+      loop = add([:split, nil, out])
+      @insts[loop][1] = compile(node[1], loop)
+      loop
+    when :plus
+      loop = add([:split, nil, out])
+      start = compile(node[1], loop)
+      @insts[loop][1] = start
+      start
+    when :quest
+      add([:split, compile(node[1], out), out])
+    end
+  end
+end
+
+# Builds the leftmost-first DFA, over equivalence classes of ASCII bytes.
+class Dfa
+  attr_reader :n_classes, :byte_classes, :states, :transitions, :accepting, :start
+
+  def initialize(nfa)
+    @nfa = nfa
+    compute_byte_classes
+
+    @states = [[]] # 0 is the dead state: no threads
+    @state_ids = { [] => 0 }
+    @transitions = []
+    @accepting = [false]
+
+    start_threads = add_closure([], {}, nfa.start)
+    raise 'token_re matches the empty string' if start_threads.last == :match
+    @start = state_id(start_threads)
+
+    i = 0
+    while i < @states.size
+      @transitions[i] = @class_reps.map { |byte| state_id(step(@states[i], byte)) }
+      i += 1
+    end
+  end
+
+  private
+
+  # Splits ASCII into classes of bytes that every instruction treats alike
+  def compute_byte_classes
+    sets = @nfa.insts.select { |inst| inst[0] == :char }.map { |inst| inst[1] }.uniq
+    signatures = (0...128).map { |byte| sets.map { |set| set[byte] } }
+    classes = signatures.uniq
+    @n_classes = classes.size
+    @byte_classes = signatures.map { |signature| classes.index(signature) }
+    @class_reps = classes.map { |signature| signatures.index(signature) }
+  end
+
+  def state_id(threads)
+    @state_ids[threads] ||= begin
+      @states << threads
+      @accepting << (threads.last == :match)
+      @states.size - 1
+    end
+  end
+
+  # Appends the threads reachable from pc to threads, in priority order.
+  # Stops at :match: lower-priority threads can never win.
+  def add_closure(threads, seen, pc)
+    return threads if threads.last == :match || seen[pc]
+    seen[pc] = true
+
+    inst = @nfa.insts[pc]
+    case inst[0]
+    when :match then threads << :match
+    when :char then threads << pc
+    when :split
+      add_closure(threads, seen, inst[1])
+      add_closure(threads, seen, inst[2])
+    end
+    threads
+  end
+
+  def step(threads, byte)
+    ret = []
+    seen = {}
+    threads.each do |pc|
+      break if pc == :match || ret.last == :match
+      inst = @nfa.insts[pc]
+      add_closure(ret, seen, inst[2]) if inst[1][byte] == 1
+    end
+    ret
+  end
+end
+
+def c_array(values, per_line)
+  values.each_slice(per_line).map { |line| '  ' + line.join(', ') }.join(",\n")
+end
+
+nfa = Nfa.new(Parser.new(read_token_re).parse)
+dfa = Dfa.new(nfa)
+
+raise "Too many states: #{dfa.states.size}" if dfa.states.size > 65535
+
+byte_classes = dfa.byte_classes + [255] * 128 # 255: not ASCII; ask RE2
+
+puts "Writing to #{OutFile}: #{dfa.states.size} states, #{dfa.n_classes} byte classes"
+
+File.open(OutFile, 'w') do |f|
+  f.write(<<EOT)
+// Generated by ../build-regex/generate-dfa.rb from token_regex.i
+
+static const size_t token_dfa_n_states = #{dfa.states.size};
+static const size_t token_dfa_n_classes = #{dfa.n_classes};
+static const uint16_t token_dfa_dead = 0;
+static const uint16_t token_dfa_start = #{dfa.start};
+static const uint8_t token_dfa_not_ascii = 255;
+
+// token_dfa_byte_classes[byte]: byte's column in token_dfa_transitions
+static const uint8_t token_dfa_byte_classes[256] = {
+#{c_array(byte_classes, 16)}
+};
+
+// token_dfa_accepting[state]: whether a token ends just before the next byte
+static const uint8_t token_dfa_accepting[#{dfa.states.size}] = {
+#{c_array(dfa.accepting.map { |a| a ? 1 : 0 }, 32)}
+};
+
+// token_dfa_transitions[state * token_dfa_n_classes + class]: the next state
+static const uint16_t token_dfa_transitions[#{dfa.states.size * dfa.n_classes}] = {
+#{c_array(dfa.transitions.flatten, dfa.n_classes)}
+};
+EOT
+end
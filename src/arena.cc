@@ -0,0 +1,91 @@
+#include "arena.h"
+
+#include <algorithm>
+
+namespace twittok {
+
+const size_t Arena::BlockSize;
+const size_t Arena::MinClassSize;
+const size_t Arena::MaxClassSize;
+const size_t Arena::NClasses;
+
+thread_local Arena* Arena::current_ = NULL;
+
+Arena::Arena()
+  : blockPos_(NULL)
+  , blockEnd_(NULL)
+  , nAllocations_(0)
+  , nReused_(0)
+  , nLarge_(0)
+{
+  std::fill(free_, free_ + NClasses, static_cast<FreeNode*>(NULL));
+}
+
+Arena::~Arena()
+{
+}
+
+/**
+ * Returns the index of the smallest class that holds size bytes.
+ */
+inline size_t
+Arena::sizeClass(size_t size)
+{
+  size_t ret = 0;
+  while ((MinClassSize << ret) < size) ret++;
+  return ret;
+}
+
+void*
+Arena::allocate(size_t size)
+{
+  if (size > MaxClassSize) {
+    nLarge_++;
+    return ::operator new(size);
+  }
+
+  nAllocations_++;
+
+  const size_t c = sizeClass(size);
+  if (free_[c]) {
+    nReused_++;
+    FreeNode* node = free_[c];
+    free_[c] = node->next;
+    return node;
+  }
+
+  const size_t classSize = MinClassSize << c;
+  if (static_cast<size_t>(blockEnd_ - blockPos_) < classSize) {
+    // Abandon the rest of this block. It's less than MaxClassSize: at most
+    // 1/16 of a block.
+    blocks_.emplace_back(new char[BlockSize]);
+    blockPos_ = blocks_.back().get();
+    blockEnd_ = blockPos_ + BlockSize;
+  }
+
+  void* ret = blockPos_;
+  blockPos_ += classSize;
+  return ret;
+}
+
+void
+Arena::deallocate(void* p, size_t size)
+{
+  if (size > MaxClassSize) {
+    ::operator delete(p);
+    return;
+  }
+
+  FreeNode* node = static_cast<FreeNode*>(p);
+  const size_t c = sizeClass(size);
+  node->next = free_[c];
+  free_[c] = node;
+}
+
+Arena::Stats
+Arena::stats() const
+{
+  return Stats{ blocks_.size(), blocks_.size() * BlockSize, nAllocations_, nReused_, nLarge_ };
+}
+
+} // namespace twittok
@@ -0,0 +1,144 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace twittok {
+
+/**
+ * A bump allocator for many small, short-lived arrays, freed all at once.
+ *
+ * An NgramPass holds millions of NgramInfos, each with a small vector of
+ * original spellings that grows one insert at a time. With malloc, every
+ * growth is a malloc and a free, and destroying the pass frees each vector
+ * separately. Here, we carve allocations out of big blocks. A freed
+ * allocation goes on a free list for its size class (a power of two), and
+ * the next allocation of that class reuses it -- which is just what a
+ * vector's doubling needs. Destroying the Arena frees every block at once.
+ *
+ * Allocations bigger than MaxClassSize go straight to the heap.
+ *
+ * An Arena is not thread-safe: give each thread its own.
+ */
+class Arena {
+public:
+  static const size_t BlockSize = 1024 * 1024;
+  static const size_t MinClassSize = 16;
+  static const size_t MaxClassSize = 64 * 1024;
+
+  struct Stats {
+    size_t nBlocks;
+    size_t nBlockBytes; // bytes of blocks we've allocated
+    size_t nAllocations; // from size classes, including reused ones
+    size_t nReused; // allocations we served from a free list
+    size_t nLarge; // allocations bigger than MaxClassSize
+  };
+
+  /**
+   * Makes an Arena the current thread's default, until the Scope ends.
+   *
+   * ArenaAllocators constructed without an Arena use the current thread's
+   * default, if there is one. That's how containers that are created deep
+   * inside other containers (for instance, by FlatHashMap::operator[]) find
+   * their Arena.
+   */
+  class Scope {
+  public:
+    Scope(Arena* arena) : previous_(current_) { current_ = arena; }
+    ~Scope() { current_ = previous_; }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+  private:
+    Arena* previous_;
+  };
+
+  Arena();
+  ~Arena();
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  void* allocate(size_t size);
+  void deallocate(void* p, size_t size);
+
+  /**
+   * Returns the current thread's default Arena, or NULL.
+   */
+  static inline Arena* current() { return current_; }
+
+  Stats stats() const;
+
+private:
+  static const size_t NClasses = 13; // 16 bytes through MaxClassSize
+
+  static size_t sizeClass(size_t size);
+
+  struct FreeNode {
+    FreeNode* next;
+  };
+
+  static thread_local Arena* current_;
+
+  std::vector<std::unique_ptr<char[]> > blocks_;
+  char* blockPos_; // next free byte in blocks_.back()
+  char* blockEnd_;
+  FreeNode* free_[NClasses];
+  size_t nAllocations_;
+  size_t nReused_;
+  size_t nLarge_;
+};
+
+/**
+ * A C++ allocator that allocates from an Arena, or from the heap if its
+ * Arena is NULL.
+ *
+ * Copying a container gives the copy a heap allocator (see
+ * select_on_container_copy_construction()), so copies may outlive the Arena.
+ * Moving a container keeps its Arena: never move one out of the Arena's
+ * owner.
+ */
+template<typename T>
+class ArenaAllocator {
+public:
+  typedef T value_type;
+  typedef std::true_type propagate_on_container_move_assignment;
+  typedef std::true_type propagate_on_container_swap;
+  typedef std::false_type propagate_on_container_copy_assignment;
+
+  ArenaAllocator() : arena_(Arena::current()) {}
+  explicit ArenaAllocator(Arena* arena) : arena_(arena) {}
+  template<typename U> ArenaAllocator(const ArenaAllocator<U>& rhs) : arena_(rhs.arena()) {}
+
+  inline T* allocate(size_t n) {
+    return static_cast<T*>(arena_ ? arena_->allocate(n * sizeof(T)) : ::operator new(n * sizeof(T)));
+  }
+
+  inline void deallocate(T* p, size_t n) {
+    if (arena_) {
+      arena_->deallocate(p, n * sizeof(T));
+    } else {
+      ::operator delete(p);
+    }
+  }
+
+  inline ArenaAllocator select_on_container_copy_construction() const { return ArenaAllocator(NULL); }
+
+  inline Arena* arena() const { return arena_; }
+
+  template<typename U> inline bool operator==(const ArenaAllocator<U>& rhs) const { return arena_ == rhs.arena(); }
+  template<typename U> inline bool operator!=(const ArenaAllocator<U>& rhs) const { return arena_ != rhs.arena(); }
+
+private:
+  Arena* arena_;
+};
+
+} // namespace twittok
+
+#endif /* ARENA_H */
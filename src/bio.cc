@@ -1,88 +1,159 @@
 #include "bio.h"
 
 #include <algorithm>
-#include <iostream>
 
+#include "bio_store.h"
 #include "ngram.h"
-#include "tokenizer.h"
-#include "stemmer.h"
 
-namespace {
-
-static const size_t MaxStemmedStringBytes = twittok::stemmer::MaxBytesToStem * 4; // hand-wavy...
+namespace twittok {
 
-twittok::Unigram
-tokenToUnigram(const twittok::Tokenizer::Token& token)
+Bio::Bio(const BioStore& store, size_t index)
+  : followsClinton((store.flags_[index] & BioStore::FollowsClinton) != 0)
+  , followsTrump((store.flags_[index] & BioStore::FollowsTrump) != 0)
+  , weight(store.weight(index))
+  , tokenIds_(store.tokenIds_.data() + store.tokenOffsets_[index])
+  , tokenSpans_(store.tokenSpans_.data() + store.tokenOffsets_[index])
+  , nTokens_(store.tokenOffsets_[index + 1] - store.tokenOffsets_[index])
+  , text_(store.texts_[index])
 {
-  std::string stemmed = twittok::stemmer::stem(token.data(), token.size());
+}
 
-  return {
-    { stemmed },
-    twittok::StringRef(token.data(), token.size())
-  };
+namespace {
+
+/*
+ * To find a bio's distinct ngrams, we sort its windows of N tokens and keep
+ * the first of each run of equal ones.
+ *
+ * Comparing windows token by token is slow, so when we can, we pack each
+ * window's ids into one integer: 21 bits per id, so up to 3 ids fit in a
+ * uint64_t and up to 6 in 128 bits. Sliding the window one token is a shift,
+ * an OR and a mask. That works as long as every id in the bio is below 2^21;
+ * otherwise (or for N > 6) we sort by comparing tokens.
+ *
+ * Bios are short, so the windows almost always fit in an array on the stack.
+ */
+
+const size_t PackedBits = 21;
+const TokenId MaxPackedId = (static_cast<TokenId>(1) << PackedBits) - 1;
+const size_t NStackWindows = 64;
+
+typedef unsigned __int128 uint128_t;
+
+/**
+ * PackedKey<N>::type is the smallest integer that holds N packed ids, or void.
+ */
+template<size_t N, bool Fits64 = (N * PackedBits <= 64), bool Fits128 = (N * PackedBits <= 128)>
+struct PackedKey { typedef void type; };
+template<size_t N, bool Fits128> struct PackedKey<N, true, Fits128> { typedef uint64_t type; };
+template<size_t N> struct PackedKey<N, false, true> { typedef uint128_t type; };
+
+template<typename Key>
+struct Window {
+  Key key;
+  uint32_t start;
+
+  inline bool operator<(const Window& rhs) const {
+    return key < rhs.key || (key == rhs.key && start < rhs.start);
+  }
 };
 
-template<int N>
-std::vector<twittok::Ngram<N> >
-unigramsToNgrams(const std::vector<twittok::Unigram>& unigrams)
-{
-  if (unigrams.size() < N) return std::vector<twittok::Ngram<N> >();
+/**
+ * Holds n windows: on the stack if they fit, on the heap if not.
+ */
+template<typename T>
+class WindowBuffer {
+public:
+  WindowBuffer(size_t n) {
+    if (n > NStackWindows) heap_.resize(n);
+    data_ = n > NStackWindows ? heap_.data() : stack_;
+  }
 
-  size_t size = unigrams.size() - N + 1;
-  auto ngrams = std::vector<twittok::Ngram<N> >(size);
+  inline T* data() { return data_; }
 
-  for (size_t i = 0; i < size; i++) {
-    twittok::Ngram<N>& ngram(ngrams[i]); // initialized to zero
+private:
+  T stack_[NStackWindows];
+  std::vector<T> heap_;
+  T* data_;
+};
 
-    for (size_t j = 0; j < N; j++) {
-      ngram.grams[j] = unigrams[i + j].grams[0];
+/**
+ * Sets *starts to the first window of each distinct ngram, by packed keys.
+ * Returns false if the ids don't fit.
+ */
+template<size_t N, typename Key = typename PackedKey<N>::type>
+struct PackedStarts {
+  static bool find(const TokenId* ids, size_t nWindows, std::vector<uint32_t>* starts) {
+    const Key mask = (static_cast<Key>(1) << (N * PackedBits)) - 1;
+
+    WindowBuffer<Window<Key> > buffer(nWindows);
+    Window<Key>* windows = buffer.data();
+
+    Key key = 0;
+    for (size_t i = 0; i + 1 < N; i++) key = (key << PackedBits) | ids[i];
+    for (size_t i = 0; i < nWindows; i++) {
+      key = ((key << PackedBits) | ids[i + N - 1]) & mask;
+      windows[i] = { key, static_cast<uint32_t>(i) };
     }
 
-    const twittok::Unigram& beginUnigram(unigrams[i]);
-    const twittok::Unigram& endUnigram(unigrams[i + N - 1]);
+    std::sort(windows, windows + nWindows);
+    for (size_t i = 0; i < nWindows; i++) {
+      if (i == 0 || windows[i].key != windows[i - 1].key) starts->push_back(windows[i].start);
+    }
 
-    ngram.original = twittok::StringRef(
-      beginUnigram.original.data(),
-      endUnigram.original.data() - beginUnigram.original.data() + endUnigram.original.size()
-    );
+    return true;
   }
+};
 
-  return ngrams;
-}
-
-}; // namespace ""
+template<size_t N>
+struct PackedStarts<N, void> {
+  static bool find(const TokenId*, size_t, std::vector<uint32_t>*) { return false; }
+};
 
-namespace twittok {
+} // namespace
 
-Bio::Bio(const std::vector<Tokenizer::Token>& tokens, bool followsClinton_, bool followsTrump_)
-  : followsClinton(followsClinton_)
-  , followsTrump(followsTrump_)
+template<size_t N>
+void
+Bio::distinctNgramStarts(std::vector<uint32_t>* starts) const
 {
-  unigrams_.reserve(tokens.size());
-  for (const auto& token : tokens) {
-    Unigram unigram = tokenToUnigram(token);
-    if (!unigram.grams[0].empty()) {
-      unigrams_.push_back(unigram);
+  starts->clear();
+  if (nTokens_ < N) return;
+
+  const size_t nWindows = nTokens_ - N + 1;
+
+  TokenId allIds = 0;
+  for (size_t i = 0; i < nTokens_; i++) allIds |= tokenIds_[i];
+  if (allIds <= MaxPackedId && PackedStarts<N>::find(tokenIds_, nWindows, starts)) return;
+
+  // Compare token by token
+  WindowBuffer<uint32_t> buffer(nWindows);
+  uint32_t* windows = buffer.data();
+  for (size_t i = 0; i < nWindows; i++) windows[i] = static_cast<uint32_t>(i);
+
+  const TokenId* ids = tokenIds_;
+  std::sort(windows, windows + nWindows, [ids](uint32_t a, uint32_t b) {
+    for (size_t i = 0; i < N; i++) {
+      if (ids[a + i] != ids[b + i]) return ids[a + i] < ids[b + i];
     }
-  }
-}
+    return a < b;
+  });
 
-Bio
-Bio::buildByTokenizing(const UntokenizedBio& untokenizedBio, const Tokenizer& tokenizer)
-{
-  const re2::StringPiece str(untokenizedBio.utf8);
-  const auto tokens = tokenizer.tokenize(str);
-  return Bio(tokens, untokenizedBio.followsClinton, untokenizedBio.followsTrump);
+  for (size_t i = 0; i < nWindows; i++) {
+    if (i == 0 || !std::equal(ids + windows[i], ids + windows[i] + N, ids + windows[i - 1])) starts->push_back(windows[i]);
+  }
 }
 
 template<size_t N>
 std::vector<Ngram<N> >
 Bio::ngrams() const
 {
-  std::vector<Ngram<N> > ret(unigramsToNgrams<N>(unigrams_));
-  std::sort(ret.begin(), ret.end());
-  auto new_end = std::unique(ret.begin(), ret.end());
-  ret.resize(std::distance(ret.begin(), new_end));
+  std::vector<uint32_t> starts;
+  distinctNgramStarts<N>(&starts);
+
+  std::vector<Ngram<N> > ret;
+  ret.reserve(starts.size());
+  for (const uint32_t start : starts) ret.push_back({ gramsAt<N>(start), originalAt(start, N) });
+
+  std::sort(ret.begin(), ret.end()); // grams are distinct
   return ret;
 }
 
@@ -97,4 +168,15 @@ template std::vector<Ngram<8> > Bio::ngrams() const;
 template std::vector<Ngram<9> > Bio::ngrams() const;
 template std::vector<Ngram<10> > Bio::ngrams() const;
 
+template void Bio::distinctNgramStarts<1>(std::vector<uint32_t>*) const;
+template void Bio::distinctNgramStarts<2>(std::vector<uint32_t>*) const;
+template void Bio::distinctNgramStarts<3>(std::vector<uint32_t>*) const;
+template void Bio::distinctNgramStarts<4>(std::vector<uint32_t>*) const;
+template void Bio::distinctNgramStarts<5>(std::vector<uint32_t>*) const;
+template void Bio::distinctNgramStarts<6>(std::vector<uint32_t>*) const;
+template void Bio::distinctNgramStarts<7>(std::vector<uint32_t>*) const;
+template void Bio::distinctNgramStarts<8>(std::vector<uint32_t>*) const;
+template void Bio::distinctNgramStarts<9>(std::vector<uint32_t>*) const;
+template void Bio::distinctNgramStarts<10>(std::vector<uint32_t>*) const;
+
 }; // namespace twittok
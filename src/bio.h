@@ -1,33 +1,107 @@
 #ifndef BIO_H
 #define BIO_H
 
+#include <cstdint>
 #include <vector>
-#include <iterator>
 
 #include "ngram.h"
-#include "tokenizer.h"
-#include "untokenized_bio.h"
 
 namespace twittok {
 
+class BioStore;
+
+/**
+ * Where a token's original text is, relative to the start of its bio.
+ *
+ * A bio is at most UntokenizedBio::MaxBioBytes long, so 16 bits suffice.
+ */
+struct TokenSpan {
+  uint16_t begin;
+  uint16_t size;
+};
+
+/**
+ * How many followers a stored bio stands for.
+ *
+ * Usually that's one follower, but a BioDeduplicator collapses followers with
+ * identical bios into one bio that counts as all of them.
+ */
+struct BioWeight {
+  uint32_t n; // followers
+  uint32_t nClinton; // of those, how many follow Clinton
+  uint32_t nTrump;
+  uint32_t nBoth;
+
+  /**
+   * Returns the weight of one follower.
+   */
+  static inline BioWeight one(bool followsClinton, bool followsTrump) {
+    return BioWeight{ 1, followsClinton ? 1u : 0u, followsTrump ? 1u : 0u, followsClinton && followsTrump ? 1u : 0u };
+  }
+
+  inline void add(bool followsClinton, bool followsTrump) {
+    n++;
+    if (followsClinton) nClinton++;
+    if (followsTrump) nTrump++;
+    if (followsClinton && followsTrump) nBoth++;
+  }
+};
+
 /**
- * A Twitter bio.
+ * A Twitter bio, as stored in a BioStore.
  *
- * Beware: if the original char* backing the tokens is freed, this Bio and all
- * its return values will be invalid.
+ * This is a cheap view: copy it freely. It and all its return values are
+ * valid until the BioStore is modified or freed.
  */
 class Bio {
 public:
-  Bio(const std::vector<Tokenizer::Token>& tokens, bool followsClinton_, bool followsTrump_);
-  static Bio buildByTokenizing(const UntokenizedBio& untokenizedBio, const Tokenizer& tokenizer);
+  Bio(const BioStore& store, size_t index);
 
+  /**
+   * Returns the bio's distinct ngrams, sorted by grams. When the bio repeats
+   * an ngram, its first spelling wins.
+   *
+   * This allocates: it's handy for tests. Counting loops use
+   * distinctNgramStarts().
+   */
   template<size_t N> std::vector<Ngram<N> > ngrams() const;
 
-  bool followsClinton;
+  /**
+   * Replaces *starts with the position of the first occurrence of each
+   * distinct ngram in the bio, in no particular order.
+   *
+   * Reuse one vector for every bio, and this doesn't allocate.
+   */
+  template<size_t N> void distinctNgramStarts(std::vector<uint32_t>* starts) const;
+
+  /**
+   * Returns the N stems starting at token start.
+   */
+  template<size_t N>
+  inline NgramKey<N> gramsAt(size_t start) const {
+    NgramKey<N> ret;
+    for (size_t i = 0; i < N; i++) ret[i] = tokenIds_[start + i];
+    return ret;
+  }
+
+  /**
+   * Returns the original text of n tokens starting at token start.
+   */
+  inline StringRef originalAt(size_t start, size_t n) const {
+    const TokenSpan& beginSpan(tokenSpans_[start]);
+    const TokenSpan& endSpan(tokenSpans_[start + n - 1]);
+    return StringRef(text_ + beginSpan.begin, endSpan.begin + endSpan.size - beginSpan.begin);
+  }
+
+  bool followsClinton; // true if any of its followers follows Clinton
   bool followsTrump;
+  BioWeight weight;
 
 private:
-  std::vector<Unigram> unigrams_;
+  const TokenId* tokenIds_;
+  const TokenSpan* tokenSpans_;
+  size_t nTokens_;
+  const char* text_;
 };
 
 }; // namespace twittok
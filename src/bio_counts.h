@@ -0,0 +1,53 @@
+#ifndef BIO_COUNTS_H
+#define BIO_COUNTS_H
+
+#include <cstddef>
+#include <ostream>
+
+#include "untokenized_bio.h"
+
+namespace twittok {
+
+/**
+ * How many followers we read, and how many of those have a bio.
+ *
+ * dump() writes the header of our output file.
+ */
+struct BioCounts {
+  size_t nClinton = 0;
+  size_t nTrump = 0;
+  size_t nBoth = 0;
+  size_t n() const { return nClinton + nTrump - nBoth; }
+  size_t nClintonWithBio = 0;
+  size_t nTrumpWithBio = 0;
+  size_t nBothWithBio = 0;
+  size_t nWithBio() const { return nClintonWithBio + nTrumpWithBio - nBothWithBio; }
+
+  void add(const UntokenizedBioRef& bio) {
+    if (bio.followsClinton) nClinton++;
+    if (bio.followsTrump) nTrump++;
+    if (bio.followsClinton && bio.followsTrump) nBoth++;
+
+    if (bio.empty()) return;
+
+    if (bio.followsClinton) nClintonWithBio++;
+    if (bio.followsTrump) nTrumpWithBio++;
+    if (bio.followsClinton && bio.followsTrump) nBothWithBio++;
+  }
+
+  void dump(std::ostream& os) const {
+    os << "n: " << n() << "\n";
+    os << "nClinton: " << nClinton << "\n";
+    os << "nTrump: " << nTrump << "\n";
+    os << "nBoth: " << nBoth << "\n";
+    os << "nWithBio: " << nWithBio() << "\n";
+    os << "nClintonWithBio: " << nClintonWithBio << "\n";
+    os << "nTrumpWithBio: " << nTrumpWithBio << "\n";
+    os << "nBothWithBio: " << nBothWithBio << "\n";
+    os << std::flush;
+  }
+};
+
+} // namespace twittok
+
+#endif /* BIO_COUNTS_H */
@@ -0,0 +1,33 @@
+#include "bio_deduplicator.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace twittok {
+
+bool
+BioDeduplicator::Key::operator<(const Key& rhs) const
+{
+  const int cmp = memcmp(text.data(), rhs.text.data(), std::min(text.size(), rhs.text.size()));
+  return cmp < 0 || (cmp == 0 && text.size() < rhs.text.size());
+}
+
+void
+BioDeduplicator::add(const UntokenizedBioRef& bio)
+{
+  nAdded_++;
+
+  uint32_t& index(indexes_[Key{ StringRef(bio.utf8.data(), bio.utf8.size()) }]);
+  if (index == 0) {
+    if (bios_.size() == std::numeric_limits<uint32_t>::max()) throw std::length_error("Too many distinct bios");
+    bios_.push_back(bio);
+    weights_.push_back(BioWeight{ 0, 0, 0, 0 });
+    index = static_cast<uint32_t>(bios_.size());
+  }
+
+  weights_[index - 1].add(bio.followsClinton, bio.followsTrump);
+}
+
+} // namespace twittok
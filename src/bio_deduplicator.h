@@ -0,0 +1,79 @@
+#ifndef BIO_DEDUPLICATOR_H
+#define BIO_DEDUPLICATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "bio.h"
+#include "flat_hash_map.h"
+#include "string_ref.h"
+#include "untokenized_bio.h"
+
+namespace twittok {
+
+/**
+ * Collapses bios with byte-for-byte identical text into one bio apiece.
+ *
+ * Bots, templates and boilerplate ("Proud American", "God, family,
+ * country") mean many followers share a bio. Each copy would be tokenized,
+ * stemmed and scanned on every pass, only to add the same ngrams. Instead,
+ * we keep the first bio with each text and a BioWeight that counts every
+ * follower who has it. Feed bios() and weights() to BioStore::addBatch(),
+ * and NgramPass and SuffixArrayNgramCounter count each bio as many times as
+ * its weight -- so the counts come out exactly as without deduplication.
+ *
+ * A bio counts each of its ngrams once, with its first spelling, so copies
+ * of one text contribute identical ngrams. That's what makes this exact.
+ *
+ * Like the UntokenizedBioRefs we're given, we point to text we don't own.
+ */
+class BioDeduplicator {
+public:
+  BioDeduplicator() {}
+
+  BioDeduplicator(const BioDeduplicator&) = delete;
+  BioDeduplicator& operator=(const BioDeduplicator&) = delete;
+
+  /**
+   * Adds the bio, or adds its follower to the weight of an earlier bio with
+   * the same text.
+   */
+  void add(const UntokenizedBioRef& bio);
+
+  /**
+   * Returns the first bio with each text, in the order we first saw them.
+   */
+  inline const std::vector<UntokenizedBioRef>& bios() const { return bios_; }
+
+  /**
+   * Returns how many followers each of bios() stands for.
+   */
+  inline const std::vector<BioWeight>& weights() const { return weights_; }
+
+  /**
+   * Returns the number of bios we added, duplicates included.
+   */
+  inline size_t nAdded() const { return nAdded_; }
+
+private:
+  struct Key {
+    StringRef text; // points into the bio
+
+    inline bool operator==(const Key& rhs) const { return text == rhs.text; }
+    bool operator<(const Key& rhs) const; // only called on hash collisions
+  };
+
+  struct KeyHash {
+    inline size_t operator()(const Key& key) const { return key.text.hash(); }
+  };
+
+  FlatHashMap<Key, uint32_t, KeyHash> indexes_; // text => index in bios_, plus one (0 means "new")
+  std::vector<UntokenizedBioRef> bios_;
+  std::vector<BioWeight> weights_;
+  size_t nAdded_ = 0;
+};
+
+} // namespace twittok
+
+#endif /* BIO_DEDUPLICATOR_H */
@@ -0,0 +1,129 @@
+#include "bio_pipeline.h"
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "bounded_queue.h"
+#include "mmap_csv_bio_reader.h"
+
+namespace {
+
+typedef std::vector<twittok::UntokenizedBioRef> UntokenizedBatch;
+typedef twittok::BioStore TokenizedBatch;
+
+// A NULL batch means "no more batches".
+typedef twittok::BoundedQueue<UntokenizedBatch*> UntokenizedQueue;
+typedef twittok::BoundedQueue<TokenizedBatch*> TokenizedQueue;
+
+const size_t QueueBatchesPerTokenizer = 4;
+
+} // namespace ""
+
+namespace twittok {
+
+const size_t BioPipeline::BatchSize;
+
+BioPipeline::BioPipeline(const char* filename, size_t nTokenizers)
+  : file_(new MappedFile(filename))
+  , begin_(file_->begin())
+  , end_(file_->end())
+  , nTokenizers_(std::max(nTokenizers, static_cast<size_t>(1)))
+{
+}
+
+BioPipeline::BioPipeline(const char* begin, const char* end, size_t nTokenizers)
+  : begin_(begin)
+  , end_(end)
+  , nTokenizers_(std::max(nTokenizers, static_cast<size_t>(1)))
+{
+}
+
+void
+BioPipeline::run(BioStore* bios, NgramPass<1>* pass1, Error* error)
+{
+  UntokenizedQueue untokenized(nTokenizers_ * QueueBatchesPerTokenizer);
+  TokenizedQueue tokenized(nTokenizers_ * QueueBatchesPerTokenizer);
+  Vocabulary& vocabulary(bios->vocabulary());
+
+  // The reader must outlive the tokenizers: batches point into it
+  MmapCsvBioReader reader(begin_, end_);
+  *error = Error::Success;
+
+  // 1. Read
+  std::thread readThread([&]() {
+    UntokenizedBatch* batch = new UntokenizedBatch();
+    batch->reserve(BatchSize);
+
+    while (true) {
+      Error readError;
+      const UntokenizedBioRef bio = reader.nextBio(&readError);
+      if (readError != Error::Success) {
+        if (readError != Error::EndOfInput) *error = readError;
+        break;
+      }
+
+      counts_.add(bio);
+      if (bio.empty()) continue;
+
+      batch->push_back(bio);
+      if (batch->size() == BatchSize) {
+        untokenized.push(batch);
+        batch = new UntokenizedBatch();
+        batch->reserve(BatchSize);
+      }
+    }
+
+    if (batch->empty()) {
+      delete batch;
+    } else {
+      untokenized.push(batch);
+    }
+    for (size_t i = 0; i < nTokenizers_; i++) untokenized.push(NULL);
+  });
+
+  // 2. Tokenize and stem
+  std::vector<std::thread> tokenizeThreads;
+  for (size_t i = 0; i < nTokenizers_; i++) {
+    tokenizeThreads.emplace_back([&]() {
+      while (UntokenizedBatch* batch = untokenized.pop()) {
+        TokenizedBatch* out = bios->stemCache()
+          ? new TokenizedBatch(*bios->stemCache())
+          : new TokenizedBatch(vocabulary);
+        size_t nTextBytes = 0;
+        for (const auto& bio : *batch) nTextBytes += bio.utf8.size();
+        out->reserve(batch->size(), nTextBytes);
+
+        out->addBatch(batch->data(), batch->size(), tokenizer_);
+        delete batch;
+
+        tokenized.push(out);
+      }
+      tokenized.push(NULL);
+    });
+  }
+
+  // 3. Store and count, on this thread
+  size_t nFinished = 0;
+  while (nFinished < nTokenizers_) {
+    std::unique_ptr<TokenizedBatch> batch(tokenized.pop());
+    if (!batch) {
+      nFinished++;
+      continue;
+    }
+
+    const size_t begin = bios->size();
+    bios->append(*batch);
+    if (pass1) pass1->scanBios(*bios, begin, bios->size());
+
+    if (begin / 1000000 != bios->size() / 1000000) {
+      std::cerr << "Tokenized and stemmed " << (bios->size() / 1000000) << "M bios" << std::endl;
+    }
+  }
+
+  readThread.join();
+  for (auto& thread : tokenizeThreads) thread.join();
+}
+
+} // namespace twittok
@@ -0,0 +1,77 @@
+#ifndef BIO_PIPELINE_H
+#define BIO_PIPELINE_H
+
+#include <memory>
+
+#include "bio_counts.h"
+#include "bio_store.h"
+#include "csv_bio_reader.h"
+#include "mapped_file.h"
+#include "ngram_pass.h"
+#include "tokenizer.h"
+
+namespace twittok {
+
+/**
+ * Reads, tokenizes and stems a bios CSV -- and counts its unigrams -- all at
+ * once.
+ *
+ * Three stages run concurrently, connected by small BoundedQueues:
+ *
+ * 1. One thread reads the CSV with a MmapCsvBioReader, in batches of
+ *    BatchSize bios.
+ * 2. nTokenizers threads each tokenize and stem a batch into a small BioStore
+ *    of its own.
+ * 3. The calling thread appends each small BioStore to the big one and counts
+ *    its unigrams.
+ *
+ * So tokenizing overlaps reading, we never hold every UntokenizedBioRef at
+ * once, and pass 1 is finished when the last batch is.
+ *
+ * Batches arrive in whatever order the tokenizers finish them, so the bios'
+ * order in the store isn't the file's. Nothing we count depends on it.
+ */
+class BioPipeline {
+public:
+  typedef CsvBioReader::Error Error;
+
+  static const size_t BatchSize = 1024;
+
+  /**
+   * Maps the given file into memory. Throws if that fails.
+   */
+  BioPipeline(const char* filename, size_t nTokenizers);
+
+  /**
+   * Reads [begin, end), which the caller must keep alive until run() returns.
+   */
+  BioPipeline(const char* begin, const char* end, size_t nTokenizers);
+
+  /**
+   * Appends every non-empty bio to *bios and, unless pass1 is NULL, counts
+   * its unigrams.
+   *
+   * If *bios has a StemCache, the tokenizers all stem through it.
+   *
+   * Stops at the first parse error and sets *error; otherwise sets it to
+   * Success. Bios before the error are kept, as with the other readers.
+   */
+  void run(BioStore* bios, NgramPass<1>* pass1, Error* error);
+
+  /**
+   * Returns the counts of every bio run() read, including empty ones.
+   */
+  inline const BioCounts& counts() const { return counts_; }
+
+private:
+  std::unique_ptr<MappedFile> file_; // NULL if the caller owns the bytes
+  const char* begin_;
+  const char* end_;
+  size_t nTokenizers_;
+  Tokenizer tokenizer_;
+  BioCounts counts_;
+};
+
+} // namespace twittok
+
+#endif /* BIO_PIPELINE_H */
@@ -0,0 +1,197 @@
+#include "bio_store.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "stemmer.h"
+
+namespace twittok {
+
+const size_t BioStore::TextChunkSize;
+
+BioStore::BioStore(Vocabulary& vocabulary)
+  : vocabulary_(vocabulary)
+  , stemCache_(NULL)
+  , tokenOffsets_(1, 0)
+  , textChunkSize_(0)
+  , textChunkUsed_(0)
+  , nTextChunkBytes_(0)
+{
+}
+
+BioStore::BioStore(StemCache& stemCache)
+  : vocabulary_(stemCache.vocabulary())
+  , stemCache_(&stemCache)
+  , tokenOffsets_(1, 0)
+  , textChunkSize_(0)
+  , textChunkUsed_(0)
+  , nTextChunkBytes_(0)
+{
+}
+
+void
+BioStore::reserve(size_t nBios, size_t nTextBytes)
+{
+  flags_.reserve(flags_.size() + nBios);
+  tokenOffsets_.reserve(tokenOffsets_.size() + nBios);
+  texts_.reserve(texts_.size() + nBios);
+
+  if (textChunkUsed_ + nTextBytes > textChunkSize_) {
+    textChunks_.emplace_back(new char[nTextBytes]);
+    textChunkSize_ = nTextBytes;
+    textChunkUsed_ = 0;
+    nTextChunkBytes_ += nTextBytes;
+  }
+}
+
+const char*
+BioStore::copyText(const char* utf8, size_t len)
+{
+  if (textChunkUsed_ + len > textChunkSize_) {
+    // A bio is far smaller than a chunk, so the slack we waste is tiny.
+    const size_t size = std::max(len, TextChunkSize);
+    textChunks_.emplace_back(new char[size]);
+    textChunkSize_ = size;
+    textChunkUsed_ = 0;
+    nTextChunkBytes_ += size;
+  }
+
+  char* ret = textChunks_.back().get() + textChunkUsed_;
+  memcpy(ret, utf8, len);
+  textChunkUsed_ += len;
+  return ret;
+}
+
+void
+BioStore::add(const UntokenizedBioRef& untokenizedBio, const Tokenizer& tokenizer)
+{
+  addBatch(&untokenizedBio, 1, tokenizer);
+}
+
+void
+BioStore::addBatch(const UntokenizedBioRef* untokenizedBios, size_t n, const Tokenizer& tokenizer)
+{
+  addBatch(untokenizedBios, NULL, n, tokenizer);
+}
+
+void
+BioStore::addBatch(const UntokenizedBioRef* untokenizedBios, const BioWeight* weights, size_t n, const Tokenizer& tokenizer)
+{
+  batchTexts_.clear();
+  for (size_t i = 0; i < n; i++) {
+    batchTexts_.push_back(re2::StringPiece(untokenizedBios[i].utf8.data(), untokenizedBios[i].utf8.size()));
+  }
+
+  batchTokens_.clear();
+  tokenizer.tokenizeBatch(batchTexts_.data(), n, &batchTokens_);
+
+  const Tokenizer::Token* tokens = batchTokens_.tokens.data();
+  for (size_t i = 0; i < n; i++) {
+    const uint32_t begin = batchTokens_.offsets[i];
+    addTokenized(untokenizedBios[i], weights ? &weights[i] : NULL, tokens + begin, batchTokens_.offsets[i + 1] - begin);
+  }
+}
+
+/**
+ * Stems the tokens of one bio, and appends it. If weight is NULL, the bio
+ * stands for one follower.
+ */
+void
+BioStore::addTokenized(const UntokenizedBioRef& untokenizedBio, const BioWeight* weight, const Tokenizer::Token* tokens, size_t nTokens)
+{
+  const char* utf8 = untokenizedBio.utf8.data();
+
+  for (size_t i = 0; i < nTokens; i++) {
+    const Tokenizer::Token& token(tokens[i]);
+
+    TokenId id;
+    if (stemCache_) {
+      if (!stemCache_->stem(token.data(), token.size(), &id)) continue;
+    } else {
+      const std::string stemmed = stemmer::stem(token.data(), token.size());
+      if (stemmed.empty()) continue;
+      id = vocabulary_.intern(stemmed);
+    }
+
+    tokenIds_.push_back(id);
+    tokenSpans_.push_back({
+      static_cast<uint16_t>(token.data() - utf8),
+      static_cast<uint16_t>(token.size())
+    });
+  }
+
+  const BioWeight w = weight ? *weight : BioWeight::one(untokenizedBio.followsClinton, untokenizedBio.followsTrump);
+  pushWeight(w);
+  flags_.push_back(
+    (w.nClinton > 0 ? FollowsClinton : 0)
+    | (w.nTrump > 0 ? FollowsTrump : 0)
+  );
+  tokenOffsets_.push_back(tokenIds_.size());
+  texts_.push_back(copyText(utf8, untokenizedBio.utf8.size()));
+}
+
+/**
+ * Records the weight of the bio we're about to add, if we store weights --
+ * and starts storing them, if this is the first bio that needs it. Call this
+ * before pushing its flags.
+ */
+void
+BioStore::pushWeight(const BioWeight& weight)
+{
+  if (weights_.empty()) {
+    if (weight.n == 1) return; // weight() can derive it from the flags
+
+    weights_.reserve(flags_.capacity());
+    for (const uint8_t f : flags_) {
+      weights_.push_back(BioWeight::one((f & FollowsClinton) != 0, (f & FollowsTrump) != 0));
+    }
+  }
+
+  weights_.push_back(weight);
+}
+
+void
+BioStore::append(const BioStore& rhs)
+{
+  const uint64_t tokenOffset = tokenIds_.size();
+
+  tokenIds_.insert(tokenIds_.end(), rhs.tokenIds_.begin(), rhs.tokenIds_.end());
+  tokenSpans_.insert(tokenSpans_.end(), rhs.tokenSpans_.begin(), rhs.tokenSpans_.end());
+
+  for (size_t i = 0; i < rhs.size(); i++) {
+    pushWeight(rhs.weight(i));
+    flags_.push_back(rhs.flags_[i]);
+    tokenOffsets_.push_back(tokenOffset + rhs.tokenOffsets_[i + 1]);
+
+    // A bio's text ends where its last token ends, or later. The rest is
+    // whitespace and punctuation, which nothing reads.
+    const uint64_t end = rhs.tokenOffsets_[i + 1];
+    const size_t len = end == rhs.tokenOffsets_[i] ? 0 : rhs.tokenSpans_[end - 1].begin + rhs.tokenSpans_[end - 1].size;
+    texts_.push_back(copyText(rhs.texts_[i], len));
+  }
+}
+
+void
+BioStore::shrinkToFit()
+{
+  flags_.shrink_to_fit();
+  tokenOffsets_.shrink_to_fit();
+  texts_.shrink_to_fit();
+  tokenIds_.shrink_to_fit();
+  tokenSpans_.shrink_to_fit();
+  weights_.shrink_to_fit();
+}
+
+size_t
+BioStore::nBytes() const
+{
+  return flags_.capacity() * sizeof(uint8_t)
+    + tokenOffsets_.capacity() * sizeof(uint64_t)
+    + texts_.capacity() * sizeof(const char*)
+    + tokenIds_.capacity() * sizeof(TokenId)
+    + tokenSpans_.capacity() * sizeof(TokenSpan)
+    + weights_.capacity() * sizeof(BioWeight)
+    + nTextChunkBytes_;
+}
+
+} // namespace twittok
@@ -0,0 +1,185 @@
+#ifndef BIO_STORE_H
+#define BIO_STORE_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "bio.h"
+#include "stem_cache.h"
+#include "string_ref.h"
+#include "tokenizer.h"
+#include "untokenized_bio.h"
+#include "vocabulary.h"
+
+namespace twittok {
+
+/**
+ * Every tokenized, stemmed bio, in a handful of flat arrays.
+ *
+ * A std::vector<Unigram> per bio costs a std::string and a hashed StringRef
+ * per token -- about 1kb/bio. Here, a token costs a 4-byte TokenId and a
+ * 4-byte TokenSpan; a bio costs a flags byte, an offset, a pointer and a copy
+ * of its text. Stems live in a Vocabulary, which may be shared by several
+ * stores.
+ *
+ * Since we copy the text, the UntokenizedBioRefs (and whatever owns their
+ * bytes) may be freed once the store is built. We copy it into fixed chunks
+ * that never move, so Bios' original text stays valid while we add more.
+ *
+ * A bio may stand for several followers with the same text: see BioWeight.
+ * We only store weights once some bio weighs more than one follower; until
+ * then, weight() derives them from the flags.
+ *
+ * Scanning every bio in order reads each array front to back.
+ */
+class BioStore {
+public:
+  static const uint8_t FollowsClinton = 1;
+  static const uint8_t FollowsTrump = 2;
+
+  /**
+   * Creates an empty store. The Vocabulary must outlive it.
+   */
+  BioStore(Vocabulary& vocabulary);
+
+  /**
+   * Creates an empty store that stems through the given cache, and uses its
+   * Vocabulary. The cache must outlive the store.
+   */
+  BioStore(StemCache& stemCache);
+
+  BioStore(const BioStore&) = delete;
+  BioStore& operator=(const BioStore&) = delete;
+
+  /**
+   * Preallocates room for nBios more bios, totalling nTextBytes of text.
+   *
+   * This is optional: it just avoids reallocating (and briefly holding two
+   * copies of) the biggest arrays, and wasting the end of each text chunk.
+   */
+  void reserve(size_t nBios, size_t nTextBytes);
+
+  /**
+   * Tokenizes and stems the bio, and appends it.
+   */
+  void add(const UntokenizedBioRef& untokenizedBio, const Tokenizer& tokenizer);
+
+  /**
+   * Tokenizes and stems n bios, and appends them in order.
+   *
+   * This is add() in a loop, minus the per-bio overhead: the tokenizer writes
+   * every bio's tokens into one scratch array that we reuse, so once it has
+   * grown to fit a batch, adding bios doesn't allocate.
+   */
+  void addBatch(const UntokenizedBioRef* untokenizedBios, size_t n, const Tokenizer& tokenizer);
+
+  /**
+   * Like addBatch(), but bio i stands for weights[i] followers: for adding
+   * the output of a BioDeduplicator.
+   */
+  void addBatch(const UntokenizedBioRef* untokenizedBios, const BioWeight* weights, size_t n, const Tokenizer& tokenizer);
+
+  /**
+   * Appends copies of every bio in rhs, which must share our Vocabulary.
+   */
+  void append(const BioStore& rhs);
+
+  /**
+   * Frees unused capacity. Call this once you're done adding.
+   *
+   * Text chunks stay as they are: moving them would invalidate Bios.
+   */
+  void shrinkToFit();
+
+  /**
+   * Returns the number of bios.
+   */
+  inline size_t size() const { return flags_.size(); }
+
+  /**
+   * Returns a view of the index'th bio, in the order they were added.
+   */
+  inline Bio operator[](size_t index) const { return Bio(*this, index); }
+
+  inline const Vocabulary& vocabulary() const { return vocabulary_; }
+  inline Vocabulary& vocabulary() { return vocabulary_; }
+
+  /**
+   * Returns the StemCache we were built with, or NULL.
+   */
+  inline StemCache* stemCache() const { return stemCache_; }
+
+  inline size_t nTokens() const { return tokenIds_.size(); }
+
+  /*
+   * Flat access, for code that walks every token of every bio at once.
+   *
+   * Tokens are numbered across the whole store: bio i's tokens are
+   * [tokenBegin(i), tokenEnd(i)).
+   */
+  inline uint64_t tokenBegin(size_t bio) const { return tokenOffsets_[bio]; }
+  inline uint64_t tokenEnd(size_t bio) const { return tokenOffsets_[bio + 1]; }
+  inline const TokenId* tokenIds() const { return tokenIds_.data(); }
+  inline uint8_t flags(size_t bio) const { return flags_[bio]; }
+
+  /**
+   * Returns how many followers the bio stands for.
+   */
+  inline BioWeight weight(size_t bio) const {
+    if (!weights_.empty()) return weights_[bio];
+    const uint8_t f = flags_[bio];
+    return BioWeight::one((f & FollowsClinton) != 0, (f & FollowsTrump) != 0);
+  }
+
+  /**
+   * Returns true if some bio stands for more than one follower.
+   */
+  inline bool weighted() const { return !weights_.empty(); }
+
+  /**
+   * Returns the original text of tokens [token, token + n) of the given bio.
+   */
+  inline StringRef originalText(size_t bio, uint64_t token, size_t n) const {
+    const TokenSpan& beginSpan(tokenSpans_[token]);
+    const TokenSpan& endSpan(tokenSpans_[token + n - 1]);
+    return StringRef(
+      texts_[bio] + beginSpan.begin,
+      endSpan.begin + endSpan.size - beginSpan.begin
+    );
+  }
+
+  /**
+   * Returns roughly how many bytes of heap we use, not counting the
+   * Vocabulary.
+   */
+  size_t nBytes() const;
+
+private:
+  friend class Bio;
+
+  static const size_t TextChunkSize = 16 * 1024 * 1024;
+
+  const char* copyText(const char* utf8, size_t len);
+  void addTokenized(const UntokenizedBioRef& untokenizedBio, const BioWeight* weight, const Tokenizer::Token* tokens, size_t nTokens);
+  void pushWeight(const BioWeight& weight);
+
+  Vocabulary& vocabulary_;
+  StemCache* stemCache_; // may be NULL
+  std::vector<uint8_t> flags_; // FollowsClinton | FollowsTrump
+  std::vector<uint64_t> tokenOffsets_; // bio i's tokens are [tokenOffsets_[i], tokenOffsets_[i + 1])
+  std::vector<const char*> texts_; // bio i's text starts at texts_[i], in one of textChunks_
+  std::vector<TokenId> tokenIds_;
+  std::vector<TokenSpan> tokenSpans_;
+  std::vector<BioWeight> weights_; // empty unless weighted()
+  std::vector<std::unique_ptr<char[]> > textChunks_;
+  size_t textChunkSize_; // size of textChunks_.back()
+  size_t textChunkUsed_; // bytes used in textChunks_.back()
+  size_t nTextChunkBytes_; // sum of all chunk sizes
+  std::vector<re2::StringPiece> batchTexts_; // scratch, for addBatch()
+  Tokenizer::Batch batchTokens_; // scratch, for add() and addBatch()
+};
+
+} // namespace twittok
+
+#endif /* BIO_STORE_H */
@@ -0,0 +1,137 @@
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+
+namespace twittok {
+
+/**
+ * A fixed-capacity, lock-free queue that any number of threads may push to
+ * and pop from at once.
+ *
+ * This is Dmitry Vyukov's bounded MPMC queue: a ring of cells, each with a
+ * sequence number that says whether it's ready to be written or read. A push
+ * or pop is one compare-and-swap on a shared position plus one store to the
+ * cell; producers and consumers only contend with their own kind.
+ *
+ * push() and pop() spin (yielding) while the queue is full or empty. That's
+ * what we want between pipeline stages: the queue is small, so a slow stage
+ * throttles the stage before it.
+ */
+template<typename T>
+class BoundedQueue {
+public:
+  /**
+   * Creates a queue of at least the given capacity (rounded up to a power of
+   * two).
+   */
+  explicit BoundedQueue(size_t capacity)
+    : mask_(roundUpToPowerOfTwo(capacity) - 1)
+    , cells_(new Cell[mask_ + 1])
+    , pushPosition_(0)
+    , popPosition_(0)
+  {
+    for (size_t i = 0; i <= mask_; i++) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  BoundedQueue(const BoundedQueue&) = delete;
+  BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+  /**
+   * Moves value into the queue and returns true, or returns false (leaving
+   * value alone) if the queue is full.
+   */
+  bool tryPush(T& value) {
+    Cell* cell;
+    size_t position = pushPosition_.load(std::memory_order_relaxed);
+
+    while (true) {
+      cell = &cells_[position & mask_];
+      const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+      if (diff == 0) {
+        if (pushPosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+      } else if (diff < 0) {
+        return false; // full
+      } else {
+        position = pushPosition_.load(std::memory_order_relaxed);
+      }
+    }
+
+    cell->value = std::move(value);
+    cell->sequence.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Moves the oldest value into *value and returns true, or returns false if
+   * the queue is empty.
+   */
+  bool tryPop(T* value) {
+    Cell* cell;
+    size_t position = popPosition_.load(std::memory_order_relaxed);
+
+    while (true) {
+      cell = &cells_[position & mask_];
+      const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+
+      if (diff == 0) {
+        if (popPosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+      } else if (diff < 0) {
+        return false; // empty
+      } else {
+        position = popPosition_.load(std::memory_order_relaxed);
+      }
+    }
+
+    *value = std::move(cell->value);
+    cell->sequence.store(position + mask_ + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Pushes value, waiting for room if the queue is full.
+   */
+  void push(T value) {
+    while (!tryPush(value)) std::this_thread::yield();
+  }
+
+  /**
+   * Pops a value, waiting for one if the queue is empty.
+   */
+  T pop() {
+    T value;
+    while (!tryPop(&value)) std::this_thread::yield();
+    return value;
+  }
+
+private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  static size_t roundUpToPowerOfTwo(size_t n) {
+    size_t ret = 1;
+    while (ret < n) ret *= 2;
+    return ret;
+  }
+
+  const size_t mask_;
+  std::unique_ptr<Cell[]> cells_;
+  alignas(64) std::atomic<size_t> pushPosition_; // on its own cache line, so producers and consumers don't share one
+  alignas(64) std::atomic<size_t> popPosition_;
+};
+
+} // namespace twittok
+
+#endif /* BOUNDED_QUEUE_H */
@@ -0,0 +1,128 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "casefold.h"
+#include "ngram_index.h"
+#include "results_file.h"
+#include "tokenizer.h"
+
+namespace {
+
+void
+usage(const char* program)
+{
+  std::cerr << "Usage: " << program << " RESULTS.bin OUT-INDEX" << std::endl;
+  std::cerr << "       " << program << " --lookup INDEX PHRASE..." << std::endl;
+  exit(1);
+}
+
+int
+build(const char* resultsFilename, const char* indexFilename)
+{
+  std::ifstream in(resultsFilename, std::ifstream::in | std::ifstream::binary);
+  if (!in) {
+    std::cerr << "Could not open " << resultsFilename << std::endl;
+    return 1;
+  }
+
+  twittok::NgramIndexBuilder builder;
+
+  try {
+    twittok::readBinaryResultsHeader(in);
+
+    twittok::ResultsBlock block;
+    while (block.read(in)) {
+      builder.addBlock(block);
+    }
+  } catch (const std::exception& err) { // runtime_error for a bad file, or bad_alloc
+    std::cerr << resultsFilename << ": " << err.what() << std::endl;
+    return 1;
+  }
+
+  std::cerr << "Indexing " << builder.size() << " ngrams" << std::endl;
+
+  std::vector<char> outBuffer(1024 * 1024); // so we write in big pieces
+  std::ofstream out;
+  out.rdbuf()->pubsetbuf(outBuffer.data(), outBuffer.size());
+  out.open(indexFilename, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+  if (!out) {
+    std::cerr << "Could not open " << indexFilename << std::endl;
+    return 1;
+  }
+
+  builder.write(out);
+  out.close();
+  if (!out) {
+    std::cerr << "Could not write " << indexFilename << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
+
+int
+lookup(const char* indexFilename, const std::vector<const char*>& phrases)
+{
+  twittok::Tokenizer tokenizer;
+  std::unique_ptr<twittok::NgramIndex> index;
+  try {
+    index.reset(new twittok::NgramIndex(indexFilename));
+  } catch (const std::runtime_error& err) {
+    std::cerr << indexFilename << ": " << err.what() << std::endl;
+    return 1;
+  } catch (const char* err) { // MappedFile's
+    std::cerr << indexFilename << ": " << err << std::endl;
+    return 1;
+  }
+
+  std::string key;
+  twittok::NgramIndex::Record record;
+  for (const char* phrase : phrases) {
+    const auto start = std::chrono::steady_clock::now();
+    const bool found = index->findPhrase(tokenizer, meta::util::string_view(phrase, strlen(phrase)), &key, &record);
+    const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << phrase << " (\"" << key << "\", " << micros << "us): ";
+    if (!found) {
+      std::cout << "not found" << std::endl;
+      continue;
+    }
+
+    std::cout << record.nClinton() << "\t" << record.nTrump() << "\t" << record.nBoth() << "\t" << record.nVariants() << std::endl;
+    for (size_t i = 0; i < record.nSpellings(); i++) {
+      std::cout << "\t" << record.spellingN(i) << "\t" << record.spelling(i) << std::endl;
+    }
+  }
+
+  return 0;
+}
+
+} // namespace ""
+
+/**
+ * Builds an NgramIndex from a binary results file (twittok --format=binary),
+ * or looks up phrases in one.
+ *
+ * Usage: twittok-index RESULTS.bin OUT-INDEX
+ *        twittok-index --lookup INDEX PHRASE...
+ */
+int
+main(int argc, char** argv)
+{
+  // Fail now if ICU is broken, not mid-index
+  twittok::casefold_init();
+
+  if (argc >= 3 && strcmp(argv[1], "--lookup") == 0) {
+    return lookup(argv[2], std::vector<const char*>(argv + 3, argv + argc));
+  }
+
+  if (argc != 3 || argv[1][0] == '-') usage(argv[0]);
+  return build(argv[1], argv[2]);
+}
@@ -1,12 +1,251 @@
 #include "casefold.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <unicode/bytestream.h>
+#include <unicode/normalizer2.h>
 #include <unicode/translit.h>
+#include <unicode/uchar.h>
+#include <unicode/ucasemap.h>
 #include <unicode/unistr.h>
+#include <unicode/utf8.h>
 #include <unicode/utypes.h>
 
 namespace {
 
-static const icu::Transliterator* transliterator = NULL;
+// The transliterator each thread clones. Nobody transliterates with it.
+static std::once_flag prototypeOnce;
+static std::unique_ptr<icu::Transliterator> prototype;
+
+// For the UTF-8 path. Both are safe to share between threads.
+static const icu::Normalizer2* nfkd = NULL;
+static icu::LocalUCaseMapPointer caseMap;
+
+/**
+ * One thread's counters. Only that thread writes them; anybody may read.
+ */
+struct ThreadStats {
+	std::atomic<uint64_t> nCalls;
+	std::atomic<uint64_t> nIcuCalls;
+	std::atomic<uint64_t> nQuickChecked;
+	std::atomic<uint64_t> icuNanoseconds;
+
+	ThreadStats() : nCalls(0), nIcuCalls(0), nQuickChecked(0), icuNanoseconds(0) {}
+
+	// With one writer, load+store is enough, and cheaper than fetch_add
+	static inline void add(std::atomic<uint64_t>& counter, uint64_t n) {
+		counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+	}
+};
+
+// Guards allStats, and cloning prototype
+static std::mutex poolMutex;
+// Every thread's stats, kept after the thread exits
+static std::vector<std::shared_ptr<ThreadStats> > allStats;
+
+/**
+ * What each thread keeps: its stats, its own transliterator and scratch.
+ */
+struct ThreadState {
+	std::shared_ptr<ThreadStats> stats;
+	std::unique_ptr<icu::Transliterator> transliterator; // NULL until we need ICU
+	std::string normalized; // scratch for utf8FoldCase()
+
+	ThreadState() : stats(std::make_shared<ThreadStats>()) {
+		std::lock_guard<std::mutex> lock(poolMutex);
+		allStats.push_back(stats);
+	}
+};
+
+static thread_local ThreadState threadState;
+
+static void
+createPrototype()
+{
+	UErrorCode errorCode = U_ZERO_ERROR;
+	nfkd = icu::Normalizer2::getNFKDInstance(errorCode);
+	caseMap.adoptInstead(ucasemap_open("", U_FOLD_CASE_DEFAULT, &errorCode));
+	prototype.reset(icu::Transliterator::createInstance("NFKD; [:M:] Remove", UTRANS_FORWARD, errorCode));
+	if (U_FAILURE(errorCode) || !prototype) {
+		prototype.reset();
+		throw "Whoops, an ICU error";
+	}
+}
+
+/**
+ * Returns this thread's transliterator, cloning it on first use.
+ */
+static icu::Transliterator&
+threadTransliterator()
+{
+	if (!threadState.transliterator) {
+		std::call_once(prototypeOnce, createPrototype);
+
+		std::lock_guard<std::mutex> lock(poolMutex);
+		threadState.transliterator.reset(prototype->clone());
+		if (!threadState.transliterator) throw "Whoops, an ICU error";
+	}
+
+	return *threadState.transliterator;
+}
+
+/**
+ * Writes utf8, lowercased, to out and returns true -- or returns false
+ * (leaving out partly written) if utf8 isn't pure ASCII.
+ *
+ * For ASCII, NFKD is the identity, there are no marks to remove, and case
+ * folding only maps A-Z to a-z. So this gives ICU's answer without ICU.
+ */
+static bool
+asciiFoldCase(const char* utf8, size_t len, char* out)
+{
+	size_t i = 0;
+
+#ifdef __SSE2__
+	const __m128i beforeA = _mm_set1_epi8('A' - 1);
+	const __m128i afterZ = _mm_set1_epi8('Z' + 1);
+	const __m128i caseBit = _mm_set1_epi8(0x20);
+
+	for (; i + 16 <= len; i += 16) {
+		const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(utf8 + i));
+		if (_mm_movemask_epi8(chunk) != 0) return false; // a byte >= 0x80
+
+		// ASCII bytes are non-negative, so signed comparisons work
+		const __m128i isUpper = _mm_and_si128(_mm_cmpgt_epi8(chunk, beforeA), _mm_cmplt_epi8(chunk, afterZ));
+		const __m128i lower = _mm_or_si128(chunk, _mm_and_si128(isUpper, caseBit));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), lower);
+	}
+#endif
+
+	for (; i < len; i++) {
+		const unsigned char c = utf8[i];
+		if (c >= 0x80) return false;
+		out[i] = (c >= 'A' && c <= 'Z') ? c | 0x20 : c;
+	}
+
+	return true;
+}
+
+/**
+ * The reference path: UTF-8 to UTF-16, transliterate, fold, back to UTF-8.
+ *
+ * Bytes that aren't valid UTF-8 become U+FFFD.
+ */
+static void
+transliterateFoldCase(const char* utf8, size_t len, std::string* out)
+{
+	UnicodeString string = icu::UnicodeString::fromUTF8(icu::StringPiece(utf8, len));
+	threadTransliterator().transliterate(string);
+	string.foldCase();
+
+	out->clear();
+	string.toUTF8String(*out);
+}
+
+static inline bool
+isMark(UChar32 c)
+{
+	return (U_GET_GC_MASK(c) & U_GC_M_MASK) != 0;
+}
+
+enum class Utf8Form { Normalized, NotNormalized, Invalid };
+
+/**
+ * Returns whether utf8 is valid UTF-8 that the Transliterator would leave as
+ * it is: every character is unchanged by NFKD, and none is a mark.
+ */
+static Utf8Form
+quickCheck(const char* utf8, int32_t len)
+{
+	Utf8Form ret = Utf8Form::Normalized;
+
+	for (int32_t i = 0; i < len; ) {
+		UChar32 c;
+		U8_NEXT(utf8, i, len, c);
+		if (c < 0) return Utf8Form::Invalid;
+		if (!nfkd->isInert(c) || isMark(c)) ret = Utf8Form::NotNormalized;
+	}
+
+	return ret;
+}
+
+/**
+ * Does what transliterateFoldCase() does without leaving UTF-8: NFKD, remove
+ * marks, fold case. Skips the first two steps when quickCheck() says they'd
+ * change nothing.
+ *
+ * Returns false, leaving *out alone, if utf8 isn't valid UTF-8 -- ICU's UTF-8
+ * functions pass bad bytes through, where transliterateFoldCase() replaces
+ * them -- or if this ICU is too old to normalize UTF-8.
+ */
+static bool
+utf8FoldCase(const char* utf8, size_t len, std::string* out)
+{
+	if (len > static_cast<size_t>(std::numeric_limits<int32_t>::max())) return false;
+
+	const Utf8Form form = quickCheck(utf8, static_cast<int32_t>(len));
+	if (form == Utf8Form::Invalid) return false;
+
+	const char* src = utf8;
+	int32_t srcLength = static_cast<int32_t>(len);
+
+	if (form == Utf8Form::Normalized) {
+		ThreadStats::add(threadState.stats->nQuickChecked, 1);
+	} else {
+#if U_ICU_VERSION_MAJOR_NUM >= 60
+		std::string& normalized(threadState.normalized);
+		normalized.clear();
+
+		UErrorCode errorCode = U_ZERO_ERROR;
+		icu::StringByteSink<std::string> sink(&normalized);
+		nfkd->normalizeUTF8(0, icu::StringPiece(utf8, static_cast<int32_t>(len)), sink, NULL, errorCode);
+		if (U_FAILURE(errorCode)) throw "Whoops, an ICU error";
+
+		// Remove marks, in place
+		const int32_t normalizedLength = static_cast<int32_t>(normalized.size());
+		size_t end = 0;
+		for (int32_t i = 0; i < normalizedLength; ) {
+			const int32_t begin = i;
+			UChar32 c;
+			U8_NEXT(normalized.data(), i, normalizedLength, c);
+			if (isMark(c)) continue;
+			memmove(&normalized[end], normalized.data() + begin, i - begin);
+			end += i - begin;
+		}
+		normalized.resize(end);
+
+		src = normalized.data();
+		srcLength = static_cast<int32_t>(end);
+#else
+		return false;
+#endif
+	}
+
+	// Folding rarely lengthens text, and when it does, ICU tells us how much
+	// room it needs.
+	out->resize(std::max(srcLength, 1));
+	UErrorCode errorCode = U_ZERO_ERROR;
+	int32_t length = ucasemap_utf8FoldCase(caseMap.getAlias(), &(*out)[0], static_cast<int32_t>(out->size()), src, srcLength, &errorCode);
+	if (errorCode == U_BUFFER_OVERFLOW_ERROR) {
+		out->resize(length);
+		errorCode = U_ZERO_ERROR;
+		length = ucasemap_utf8FoldCase(caseMap.getAlias(), &(*out)[0], length, src, srcLength, &errorCode);
+	}
+	if (U_FAILURE(errorCode)) throw "Whoops, an ICU error";
+	out->resize(length);
+
+	return true;
+}
 
 } // namespace
 
@@ -15,22 +254,65 @@ namespace twittok {
 std::string
 casefold_and_normalize(const std::string& utf8)
 {
-	UErrorCode errorCode = U_ZERO_ERROR;
+	std::string ret;
+	casefold_and_normalize(utf8.data(), utf8.size(), &ret);
+	return ret;
+}
 
-	if (transliterator == NULL) {
-		transliterator = icu::Transliterator::createInstance("NFKD; [:M:] Remove", UTRANS_FORWARD, errorCode);
-		if (U_FAILURE(errorCode)) {
-			throw "Whoops, an ICU error";
-		}
-	}
+void
+casefold_and_normalize(const char* utf8, size_t len, std::string* out)
+{
+	ThreadStats& stats(*threadState.stats);
+	ThreadStats::add(stats.nCalls, 1);
 
-	UnicodeString string = icu::UnicodeString::fromUTF8(utf8);
-	transliterator->transliterate(string);
-	string.foldCase();
+	out->resize(len);
+	if (asciiFoldCase(utf8, len, &(*out)[0])) return;
+
+	const auto start = std::chrono::steady_clock::now();
+
+	std::call_once(prototypeOnce, createPrototype);
+	if (!utf8FoldCase(utf8, len, out)) transliterateFoldCase(utf8, len, out);
+
+	ThreadStats::add(stats.nIcuCalls, 1);
+	ThreadStats::add(stats.icuNanoseconds, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+std::string
+casefold_and_normalize_with_icu(const std::string& utf8)
+{
+	const auto start = std::chrono::steady_clock::now();
 
-  std::string ret;
-  string.toUTF8String(ret);
-  return ret;
+	std::string ret;
+	transliterateFoldCase(utf8.data(), utf8.size(), &ret);
+
+	ThreadStats& stats(*threadState.stats);
+	ThreadStats::add(stats.nIcuCalls, 1);
+	ThreadStats::add(stats.icuNanoseconds, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+
+	return ret;
+}
+
+void
+casefold_init()
+{
+	std::call_once(prototypeOnce, createPrototype);
+}
+
+std::vector<CasefoldThreadStats>
+casefold_thread_stats()
+{
+	std::lock_guard<std::mutex> lock(poolMutex);
+
+	std::vector<CasefoldThreadStats> ret;
+	for (const auto& stats : allStats) {
+		ret.push_back({
+			stats->nCalls.load(std::memory_order_relaxed),
+			stats->nIcuCalls.load(std::memory_order_relaxed),
+			stats->nQuickChecked.load(std::memory_order_relaxed),
+			stats->icuNanoseconds.load(std::memory_order_relaxed)
+		});
+	}
+	return ret;
 }
 
 } // namespace twittok
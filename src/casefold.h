@@ -1,7 +1,9 @@
 #ifndef CASEFOLD_H
 #define CASEFOLD_H
 
+#include <cstdint>
 #include <string>
+#include <vector>
 #include <unicode/translit.h>
 #include <unicode/unistr.h>
 #include <unicode/utf8.h>
@@ -18,6 +20,54 @@ namespace twittok {
 std::string
 casefold_and_normalize(const std::string& utf8);
 
+/**
+ * Does what casefold_and_normalize() does, writing into *out.
+ *
+ * This replaces *out's contents but keeps its capacity, so reusing one
+ * string for many calls saves allocations.
+ */
+void
+casefold_and_normalize(const char* utf8, size_t len, std::string* out);
+
+/**
+ * Does what casefold_and_normalize() does, with an ICU Transliterator on a
+ * UTF-16 UnicodeString -- without its pure-ASCII and UTF-8 shortcuts.
+ *
+ * This is slow: it's here so tests can check the shortcuts.
+ */
+std::string
+casefold_and_normalize_with_icu(const std::string& utf8);
+
+/**
+ * Creates the ICU transliterator we casefold with.
+ *
+ * ICU Transliterators aren't thread-safe, so each thread that casefolds
+ * clones its own from this one, the first time it needs ICU. Call this at
+ * startup: it throws if ICU fails, and it's better to learn that before
+ * starting threads. (If you don't call it, the first ICU casefold does.)
+ */
+void
+casefold_init();
+
+/**
+ * What one thread's casefolding cost.
+ */
+struct CasefoldThreadStats {
+  uint64_t nCalls; // casefold_and_normalize() calls
+  uint64_t nIcuCalls; // calls that went to ICU: non-ASCII, or _with_icu()
+  uint64_t nQuickChecked; // ... of which were already normalized, so we only folded case
+  uint64_t icuNanoseconds; // time spent in those
+};
+
+/**
+ * Returns stats for every thread that has casefolded, in the order they
+ * started. Threads that have exited are included.
+ *
+ * Counts from running threads may lag by a few calls.
+ */
+std::vector<CasefoldThreadStats>
+casefold_thread_stats();
+
 }; // namespace twittok
 
 #endif /* CASEFOLD_H */
@@ -0,0 +1,139 @@
+#include "csv_structural_index.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define TWITTOK_HAVE_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+typedef twittok::CsvStructuralIndex::Block Block;
+
+Block
+scanBlockScalar(const char* p)
+{
+  Block block = { 0, 0, 0 };
+
+  for (size_t i = 0; i < twittok::CsvStructuralIndex::BlockSize; i++) {
+    const uint64_t bit = static_cast<uint64_t>(1) << i;
+    switch (p[i]) {
+      case ',': block.commas |= bit; break;
+      case '"': block.quotes |= bit; break;
+      case '\n': block.newlines |= bit; break;
+    }
+  }
+
+  return block;
+}
+
+#ifdef TWITTOK_HAVE_X86
+
+__attribute__((target("sse2")))
+Block
+scanBlockSse2(const char* p)
+{
+  const __m128i commas = _mm_set1_epi8(',');
+  const __m128i quotes = _mm_set1_epi8('"');
+  const __m128i newlines = _mm_set1_epi8('\n');
+
+  Block block = { 0, 0, 0 };
+
+  for (size_t i = 0; i < 4; i++) {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i * 16));
+    const int shift = i * 16;
+    block.commas |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, commas)))) << shift;
+    block.quotes |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quotes)))) << shift;
+    block.newlines |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newlines)))) << shift;
+  }
+
+  return block;
+}
+
+__attribute__((target("avx2")))
+Block
+scanBlockAvx2(const char* p)
+{
+  const __m256i commas = _mm256_set1_epi8(',');
+  const __m256i quotes = _mm256_set1_epi8('"');
+  const __m256i newlines = _mm256_set1_epi8('\n');
+
+  const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+
+#define MASK(needle) \
+  (static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, needle)))) \
+   | static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, needle)))) << 32)
+
+  Block block = { MASK(commas), MASK(quotes), MASK(newlines) };
+
+#undef MASK
+
+  return block;
+}
+
+#endif /* TWITTOK_HAVE_X86 */
+
+typedef Block (*ScanBlockFunction)(const char*);
+
+struct Implementation {
+  ScanBlockFunction scanBlock;
+  const char* name;
+};
+
+Implementation
+detectImplementation()
+{
+#ifdef TWITTOK_HAVE_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return { scanBlockAvx2, "avx2" };
+  if (__builtin_cpu_supports("sse2")) return { scanBlockSse2, "sse2" };
+#endif
+  return { scanBlockScalar, "scalar" };
+}
+
+const Implementation implementation = detectImplementation();
+
+} // namespace ""
+
+namespace twittok {
+
+CsvStructuralIndex::CsvStructuralIndex(const char* begin, const char* end)
+  : begin_(begin)
+  , end_(end)
+  , cachedIndex_(static_cast<size_t>(-1))
+{
+}
+
+CsvStructuralIndex::Block
+CsvStructuralIndex::scanBlock(const char* p)
+{
+  return implementation.scanBlock(p);
+}
+
+const char*
+CsvStructuralIndex::implementationName()
+{
+  return implementation.name;
+}
+
+void
+CsvStructuralIndex::scanBlockAt(size_t index)
+{
+  const char* p = begin_ + index * BlockSize;
+
+  if (end_ - p >= static_cast<ptrdiff_t>(BlockSize)) {
+    cachedBlock_ = scanBlock(p);
+  } else {
+    // The last block is partial. Pad it with bytes that aren't structural.
+    char padded[BlockSize];
+    memset(padded, 0, BlockSize);
+    memcpy(padded, p, end_ - p);
+    cachedBlock_ = scanBlock(padded);
+  }
+
+  cachedIndex_ = index;
+}
+
+} // namespace twittok
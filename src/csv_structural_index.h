@@ -0,0 +1,92 @@
+#ifndef CSV_STRUCTURAL_INDEX_H
+#define CSV_STRUCTURAL_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace twittok {
+
+/**
+ * Finds a CSV's structural characters -- ',', '"' and '\n' -- 64 bytes at a
+ * time.
+ *
+ * For each 64-byte block of input, we compute one bitmask per character
+ * class in a single pass, with AVX2 or SSE2 if the CPU has them (and a plain
+ * loop if not). Finding the next quote or newline is then a matter of
+ * masking and counting trailing zeroes, with no per-byte branches.
+ *
+ * Blocks are aligned to `begin`. We cache the most recent block, so a parser
+ * that reads front to back scans each byte once.
+ */
+class CsvStructuralIndex {
+public:
+  static const size_t BlockSize = 64;
+
+  struct Block {
+    uint64_t commas;
+    uint64_t quotes;
+    uint64_t newlines;
+  };
+
+  CsvStructuralIndex(const char* begin, const char* end);
+
+  /**
+   * Returns the first ',' in [from, limit), or NULL.
+   */
+  inline const char* findComma(const char* from, const char* limit) { return find(&Block::commas, from, limit); }
+
+  /**
+   * Returns the first '"' in [from, limit), or NULL.
+   */
+  inline const char* findQuote(const char* from, const char* limit) { return find(&Block::quotes, from, limit); }
+
+  /**
+   * Returns the first '\n' in [from, limit), or NULL.
+   */
+  inline const char* findNewline(const char* from, const char* limit) { return find(&Block::newlines, from, limit); }
+
+  /**
+   * Computes the bitmasks for exactly BlockSize bytes starting at p. Bit i is
+   * set iff p[i] is in the class.
+   */
+  static Block scanBlock(const char* p);
+
+  /**
+   * Returns "avx2", "sse2" or "scalar": what scanBlock() uses on this CPU.
+   */
+  static const char* implementationName();
+
+private:
+  inline const char* find(uint64_t Block::*mask, const char* from, const char* limit) {
+    while (from < limit) {
+      const size_t offset = from - begin_;
+      const size_t bit = offset % BlockSize;
+
+      const uint64_t bits = (blockAt(offset / BlockSize).*mask) >> bit;
+      if (bits != 0) {
+        const char* found = from + __builtin_ctzll(bits);
+        return found < limit ? found : NULL;
+      }
+
+      from += BlockSize - bit; // the start of the next block
+    }
+
+    return NULL;
+  }
+
+  inline const Block& blockAt(size_t index) {
+    if (index != cachedIndex_) scanBlockAt(index);
+    return cachedBlock_;
+  }
+
+  void scanBlockAt(size_t index);
+
+  const char* begin_;
+  const char* end_;
+  size_t cachedIndex_;
+  Block cachedBlock_;
+};
+
+} // namespace twittok
+
+#endif /* CSV_STRUCTURAL_INDEX_H */
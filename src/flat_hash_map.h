@@ -0,0 +1,229 @@
+#ifndef FLAT_HASH_MAP_H
+#define FLAT_HASH_MAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace twittok {
+
+/**
+ * An open-addressing hash map with Robin Hood probing, for small fixed-width
+ * keys such as NgramKey.
+ *
+ * Everything lives in two flat arrays: one of 64-bit hashes and one of
+ * {key, value} entries. A lookup walks the hash array, which is dense and
+ * sequential, and only reads an entry when the hashes match. We store each
+ * key's hash, so growing the table never calls Hash.
+ *
+ * Within each run of occupied slots, entries are ordered by home slot, then
+ * by hash, then by key. That ordering is unique, so the layout -- and thus
+ * the iteration order -- depends only on which keys are in the table and its
+ * capacity, not on the order we inserted them. Capacity only grows, and
+ * (unless you reserve()) only as size requires, so two tables built from the
+ * same keys on different threads iterate identically.
+ *
+ * There is no erase(): we never need it. clear() keeps the capacity, so a
+ * table we refill over and over stops allocating.
+ *
+ * Value must be default-constructible and movable. Key needs operator== and
+ * operator<.
+ */
+template<typename Key, typename Value, typename Hash>
+class FlatHashMap {
+public:
+  struct Entry {
+    Key key;
+    Value value;
+  };
+
+  class const_iterator {
+  public:
+    const_iterator(const FlatHashMap* map, size_t index) : map_(map), index_(index) { skipEmpty(); }
+
+    inline const Entry& operator*() const { return map_->entries_[index_]; }
+    inline const Entry* operator->() const { return &map_->entries_[index_]; }
+    inline const_iterator& operator++() { index_++; skipEmpty(); return *this; }
+    inline bool operator==(const const_iterator& rhs) const { return index_ == rhs.index_; }
+    inline bool operator!=(const const_iterator& rhs) const { return index_ != rhs.index_; }
+
+  private:
+    inline void skipEmpty() {
+      while (index_ < map_->hashes_.size() && map_->hashes_[index_] == Empty) index_++;
+    }
+
+    const FlatHashMap* map_;
+    size_t index_;
+  };
+
+  FlatHashMap() : size_(0), mask_(0) {}
+
+  inline size_t size() const { return size_; }
+  inline bool empty() const { return size_ == 0; }
+  inline size_t capacity() const { return hashes_.size(); }
+
+  inline const_iterator begin() const { return const_iterator(this, 0); }
+  inline const_iterator end() const { return const_iterator(this, hashes_.size()); }
+
+  /**
+   * Makes room for n entries without growing.
+   */
+  void reserve(size_t n) {
+    size_t capacity = MinCapacity;
+    while (n * MaxLoadDenominator > capacity * MaxLoadNumerator) capacity *= 2;
+    if (capacity > hashes_.size()) rehash(capacity);
+  }
+
+  /**
+   * Removes every entry, without freeing memory. Costs O(capacity()).
+   */
+  void clear() {
+    if (size_ == 0) return;
+    std::fill(hashes_.begin(), hashes_.end(), uint64_t(Empty));
+    size_ = 0;
+  }
+
+  /**
+   * Returns the value for key, inserting a default one if it's missing.
+   *
+   * Beware: the reference is invalid after the next insertion.
+   */
+  Value& operator[](const Key& key) {
+    const uint64_t hash = hashKey(key);
+
+    const size_t found = findIndex(key, hash);
+    if (found != NotFound) return entries_[found].value;
+
+    if ((size_ + 1) * MaxLoadDenominator > hashes_.size() * MaxLoadNumerator) {
+      rehash(hashes_.empty() ? MinCapacity : hashes_.size() * 2);
+    }
+
+    size_++;
+    return entries_[insertNew(hash, Entry{ key, Value() })].value;
+  }
+
+  /**
+   * Inserts key with a default value, if it's missing.
+   */
+  inline void insert(const Key& key) { (*this)[key]; }
+
+  /**
+   * Returns the value for key, or NULL.
+   */
+  inline const Value* find(const Key& key) const {
+    const size_t found = findIndex(key, hashKey(key));
+    return found == NotFound ? NULL : &entries_[found].value;
+  }
+
+  inline Value* find(const Key& key) {
+    const size_t found = findIndex(key, hashKey(key));
+    return found == NotFound ? NULL : &entries_[found].value;
+  }
+
+  inline bool contains(const Key& key) const { return findIndex(key, hashKey(key)) != NotFound; }
+
+  /**
+   * Returns how many bytes of heap we use.
+   */
+  inline size_t nBytes() const {
+    return hashes_.capacity() * sizeof(uint64_t) + entries_.capacity() * sizeof(Entry);
+  }
+
+private:
+  static const uint64_t Empty = 0;
+  static const uint64_t Occupied = static_cast<uint64_t>(1) << 63; // set in every stored hash, so none is Empty
+  static const size_t NotFound = static_cast<size_t>(-1);
+  static const size_t MinCapacity = 16;
+  static const size_t MaxLoadNumerator = 7;
+  static const size_t MaxLoadDenominator = 8;
+
+  static inline uint64_t hashKey(const Key& key) {
+    return static_cast<uint64_t>(Hash()(key)) | Occupied;
+  }
+
+  inline size_t distance(uint64_t hash, size_t index) const {
+    return (index - hash) & mask_;
+  }
+
+  /**
+   * Returns whether (hash, key), probing from distance d, belongs before an
+   * entry with the given hash and key that is probing from distance d2.
+   */
+  static inline bool goesBefore(size_t d, uint64_t hash, const Key& key, size_t d2, uint64_t hash2, const Key& key2) {
+    if (d != d2) return d > d2; // Robin Hood: the entry from further away goes first
+    if (hash != hash2) return hash < hash2;
+    return key < key2;
+  }
+
+  size_t findIndex(const Key& key, uint64_t hash) const {
+    if (size_ == 0) return NotFound;
+
+    for (size_t index = hash & mask_, d = 0; ; index = (index + 1) & mask_, d++) {
+      const uint64_t slotHash = hashes_[index];
+      if (slotHash == Empty) return NotFound;
+
+      const size_t slotD = distance(slotHash, index);
+      if (slotD < d) return NotFound; // key would be here, if we had it
+
+      if (slotHash == hash && entries_[index].key == key) return index;
+      if (slotD == d && slotHash > hash) return NotFound; // ordered past where key would be
+    }
+  }
+
+  /**
+   * Places an entry we know is missing, and returns its index. Doesn't check
+   * the load factor.
+   */
+  size_t insertNew(uint64_t hash, Entry&& entry) {
+    size_t ret = NotFound;
+
+    for (size_t index = hash & mask_, d = 0; ; index = (index + 1) & mask_, d++) {
+      const uint64_t slotHash = hashes_[index];
+
+      if (slotHash == Empty) {
+        hashes_[index] = hash;
+        entries_[index] = std::move(entry);
+        return ret == NotFound ? index : ret;
+      }
+
+      const size_t slotD = distance(slotHash, index);
+      if (goesBefore(d, hash, entry.key, slotD, slotHash, entries_[index].key)) {
+        std::swap(hashes_[index], hash);
+        std::swap(entries_[index], entry);
+        if (ret == NotFound) ret = index;
+        d = slotD;
+      }
+    }
+  }
+
+  void rehash(size_t capacity) {
+    std::vector<uint64_t> oldHashes(capacity, uint64_t(Empty));
+    std::vector<Entry> oldEntries(capacity);
+    oldHashes.swap(hashes_);
+    oldEntries.swap(entries_);
+    mask_ = capacity - 1;
+
+    for (size_t i = 0; i < oldHashes.size(); i++) {
+      if (oldHashes[i] != Empty) insertNew(oldHashes[i], std::move(oldEntries[i]));
+    }
+  }
+
+  size_t size_;
+  size_t mask_; // capacity - 1; capacity is a power of 2
+  std::vector<uint64_t> hashes_;
+  std::vector<Entry> entries_;
+};
+
+/**
+ * A FlatHashMap without values.
+ */
+struct FlatHashSetValue {};
+
+template<typename Key, typename Hash>
+using FlatHashSet = FlatHashMap<Key, FlatHashSetValue, Hash>;
+
+} // namespace twittok
+
+#endif /* FLAT_HASH_MAP_H */
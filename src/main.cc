@@ -1,145 +1,266 @@
 #include "tokenizer.h"
 
 #include <cstdlib>
-#include <forward_list>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <string>
-#include <unordered_set>
+#include <thread>
+#include <vector>
 
-#include "bio.h"
-#include "csv_bio_reader.h"
+#include "bio_counts.h"
+#include "bio_deduplicator.h"
+#include "bio_pipeline.h"
+#include "bio_store.h"
+#include "casefold.h"
+#include "parallel_csv_bio_reader.h"
+#include "results_file.h"
+#include "stem_cache.h"
 #include "untokenized_bio.h"
 #include "ngram_pass.h"
+#include "suffix_array_ngram_counter.h"
 
 #define MAX_LINE_SIZE 1024
 
 namespace {
 
-struct UntokenizedBiosResult {
-  std::forward_list<twittok::UntokenizedBio> untokenizedBios;
-  std::string error;
-  size_t nClinton = 0;
-  size_t nTrump = 0;
-  size_t nBoth = 0;
-  size_t n() const { return nClinton + nTrump - nBoth; }
-  size_t nClintonWithBio = 0;
-  size_t nTrumpWithBio = 0;
-  size_t nBothWithBio = 0;
-  size_t nWithBio() const { return nClintonWithBio + nTrumpWithBio - nBothWithBio; }
-
-  void dump(std::ostream& os) const {
-    os << "n: " << n() << "\n";
-    os << "nClinton: " << nClinton << "\n";
-    os << "nTrump: " << nTrump << "\n";
-    os << "nBoth: " << nBoth << "\n";
-    os << "nWithBio: " << nWithBio() << "\n";
-    os << "nClintonWithBio: " << nClintonWithBio << "\n";
-    os << "nTrumpWithBio: " << nTrumpWithBio << "\n";
-    os << "nBothWithBio: " << nBothWithBio << "\n";
-    os << std::flush;
+/**
+ * Tokenizes and stems every non-empty bio into *bios. Unless weights is NULL,
+ * bio i stands for (*weights)[i] followers.
+ */
+void
+tokenizeAndStem(const std::vector<twittok::UntokenizedBioRef>& untokenizedBios, const std::vector<twittok::BioWeight>* weights, twittok::BioStore* bios)
+{
+  size_t nBios = 0;
+  size_t nTextBytes = 0;
+  for (const auto& untokenizedBio : untokenizedBios) {
+    if (untokenizedBio.empty()) continue;
+    nBios++;
+    nTextBytes += untokenizedBio.utf8.size();
+  }
+
+  // We tokenize and stem once, instead of every pass.
+  //
+  // This is 4x faster than tokenizing+stemming each pass. The BioStore is
+  // compact: it costs a copy of each bio's text plus 8 bytes per token.
+  std::cerr << "Tokenizing and stemming..." << std::endl;
+  twittok::Tokenizer tokenizer;
+  bios->reserve(nBios, nTextBytes);
+
+  // addBatch() reuses its scratch, so this loop doesn't allocate per bio.
+  std::vector<twittok::UntokenizedBioRef> batch;
+  std::vector<twittok::BioWeight> batchWeights;
+  batch.reserve(twittok::BioPipeline::BatchSize);
+  batchWeights.reserve(twittok::BioPipeline::BatchSize);
+  for (size_t i = 0; i < untokenizedBios.size(); i++) {
+    if (!untokenizedBios[i].empty()) {
+      batch.push_back(untokenizedBios[i]);
+      if (weights) batchWeights.push_back((*weights)[i]);
+    }
+    if (batch.size() < twittok::BioPipeline::BatchSize && i + 1 < untokenizedBios.size()) continue;
+
+    const size_t begin = bios->size();
+    bios->addBatch(batch.data(), weights ? batchWeights.data() : NULL, batch.size(), tokenizer);
+    batch.clear();
+    batchWeights.clear();
+
+    if (begin / 1000000 != bios->size() / 1000000) {
+      std::cerr << "Tokenized and stemmed " << (bios->size() / 1000000) << "M bios" << std::endl;
+    }
   }
-};
+}
 
-UntokenizedBiosResult
-readUntokenizedBiosFromFile(const char* csvFilename)
+/**
+ * Reads, tokenizes and stems every bio into *bios, one stage at a time.
+ *
+ * If dedup is set, stores each distinct bio text once, weighted by how many
+ * followers have it.
+ */
+twittok::BioCounts
+readBios(const char* csvFilename, twittok::BioStore* bios, bool dedup)
 {
-  UntokenizedBiosResult result;
+  twittok::BioCounts counts;
 
-  twittok::CsvBioReader reader(csvFilename);
+  std::cerr << "Reading bios from " << std::string(csvFilename) << std::endl;
+  twittok::ParallelCsvBioReader reader(csvFilename, std::thread::hardware_concurrency());
 
-  std::forward_list<twittok::UntokenizedBio> ret;
+  twittok::CsvBioReader::Error error;
+  const auto untokenizedBios = reader.readAllBios(&error);
 
-  while (true) {
-    twittok::CsvBioReader::Error error;
-    twittok::UntokenizedBio untokenizedBio(reader.nextBio(&error));
+  if (error != twittok::CsvBioReader::Error::Success) {
+    std::cerr << "Stopped reading: " << twittok::CsvBioReader::describeError(error) << std::endl;
+  }
 
-    if (error == twittok::CsvBioReader::Error::EndOfInput) {
-      break;
-    }
+  for (const auto& untokenizedBio : untokenizedBios) counts.add(untokenizedBio);
 
-    if (error != twittok::CsvBioReader::Error::Success) {
-      result.error = twittok::CsvBioReader::describeError(error);
-      break;
+  if (dedup) {
+    twittok::BioDeduplicator deduplicator;
+    for (const auto& untokenizedBio : untokenizedBios) {
+      if (!untokenizedBio.empty()) deduplicator.add(untokenizedBio);
     }
+    std::cerr << "Deduplicated " << deduplicator.nAdded() << " bios to " << deduplicator.bios().size() << " distinct texts" << std::endl;
 
-    if (untokenizedBio.followsClinton) result.nClinton++;
-    if (untokenizedBio.followsTrump) result.nTrump++;
-    if (untokenizedBio.followsClinton && untokenizedBio.followsTrump) result.nBoth++;
+    tokenizeAndStem(deduplicator.bios(), &deduplicator.weights(), bios);
+  } else {
+    tokenizeAndStem(untokenizedBios, NULL, bios);
+  }
 
-    if (untokenizedBio.empty()) continue;
+  return counts; // the BioStore has its own copy of the text; free the CSV
+}
 
-    if (untokenizedBio.followsClinton) result.nClintonWithBio++;
-    if (untokenizedBio.followsTrump) result.nTrumpWithBio++;
-    if (untokenizedBio.followsClinton && untokenizedBio.followsTrump) result.nBothWithBio++;
+/**
+ * Reads, tokenizes and stems every bio into *bios, in a BioPipeline.
+ *
+ * Unless pass1 is NULL, counts unigrams as we go.
+ */
+twittok::BioCounts
+readBiosInPipeline(const char* csvFilename, twittok::BioStore* bios, twittok::NgramPass<1>* pass1)
+{
+  std::cerr << "Reading, tokenizing and stemming bios from " << std::string(csvFilename) << std::endl;
+  twittok::BioPipeline pipeline(csvFilename, std::thread::hardware_concurrency());
 
-    result.untokenizedBios.push_front(untokenizedBio);
+  twittok::CsvBioReader::Error error;
+  pipeline.run(bios, pass1, &error);
+
+  if (error != twittok::CsvBioReader::Error::Success) {
+    std::cerr << "Stopped reading: " << twittok::CsvBioReader::describeError(error) << std::endl;
   }
 
-  return result;
+  return pipeline.counts();
 }
 
-template<int N>
-std::unordered_set<std::string>
+template<size_t N>
+typename twittok::NgramPass<N>::NgramSet
 doPass(
-    const std::unordered_set<std::string>& prefixes,
-    const std::forward_list<twittok::Bio>& bios,
+    const typename twittok::NgramPass<N>::PrefixSet& prefixes,
+    const twittok::BioStore& bios,
     std::ostream& os,
-    size_t minCount
+    size_t minCount,
+    twittok::ResultsFormat format
 ) {
   twittok::NgramPass<N> pass(prefixes);
-  pass.scanBios(bios);
-  pass.dump(os, minCount);
-  return pass.ngramStrings(minCount);
+  pass.scanBios(bios, std::thread::hardware_concurrency());
+  pass.dump(os, bios.vocabulary(), minCount, std::thread::hardware_concurrency(), format);
+  return pass.ngramKeys(minCount);
+}
+
+void
+usage(const char* program)
+{
+  std::cerr << "Usage: " << program << " [--engine=apriori|suffix-array] [--pipeline | --dedup] [--format=text|binary] DATA.csv OUT-TOKENS.txt" << std::endl;
+  exit(1);
+}
+
+/**
+ * Logs how many tokens each thread casefolded, and how long ICU took.
+ */
+void
+logCasefoldStats()
+{
+  const auto allStats = twittok::casefold_thread_stats();
+  for (size_t i = 0; i < allStats.size(); i++) {
+    const auto& stats(allStats[i]);
+    std::cerr << "Casefold thread " << i << ": " << stats.nCalls << " calls, " << stats.nIcuCalls << " with ICU (" << stats.nQuickChecked << " already normalized), "
+      << (stats.icuNanoseconds / 1000000) << "ms in ICU" << std::endl;
+  }
 }
 
 } // namespace ""
 
 int
 main(int argc, char** argv) {
-  if (argc != 3) {
-    std::cerr << "Usage: " << argv[0] << " DATA.csv OUT-TOKENS.txt" << std::endl;
-    exit(1);
+  enum class Engine { Apriori, SuffixArray };
+  Engine engine = Engine::Apriori;
+  bool pipeline = false;
+  bool dedup = false;
+  twittok::ResultsFormat format = twittok::ResultsFormat::Text;
+  std::vector<const char*> args;
+
+  for (int i = 1; i < argc; i++) {
+    const std::string arg(argv[i]);
+    if (arg == "--engine=apriori") {
+      engine = Engine::Apriori;
+    } else if (arg == "--engine=suffix-array") {
+      engine = Engine::SuffixArray;
+    } else if (arg == "--pipeline") {
+      pipeline = true;
+    } else if (arg == "--dedup") {
+      dedup = true;
+    } else if (arg == "--format=text") {
+      format = twittok::ResultsFormat::Text;
+    } else if (arg == "--format=binary") {
+      format = twittok::ResultsFormat::Binary;
+    } else if (arg.compare(0, 2, "--") == 0) {
+      usage(argv[0]);
+    } else {
+      args.push_back(argv[i]);
+    }
   }
 
-  std::cerr << "Preparing to write to " << std::string(argv[2]) << std::endl;
-  std::ofstream tokensFile(argv[2], std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+  if (args.size() != 2) usage(argv[0]);
+  if (pipeline && dedup) usage(argv[0]); // the pipeline stores bios before it has seen them all
+  const char* csvFilename = args[0];
+  const char* tokensFilename = args[1];
 
-  std::cerr << "Reading bios from " << std::string(argv[1]) << std::endl;
-  UntokenizedBiosResult untokenizedBios = readUntokenizedBiosFromFile(argv[1]);
+  // Fail now if ICU is broken, not in a tokenizer thread
+  twittok::casefold_init();
 
-  std::cerr << "Outputting statistics on " << untokenizedBios.nWithBio() << " bios" << std::endl;
-  untokenizedBios.dump(tokensFile);
+  std::cerr << "Preparing to write to " << std::string(tokensFilename) << std::endl;
+  std::vector<char> tokensBuffer(1024 * 1024); // so we write in big pieces
+  std::ofstream tokensFile;
+  tokensFile.rdbuf()->pubsetbuf(tokensBuffer.data(), tokensBuffer.size());
+  tokensFile.open(tokensFilename, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
 
-  // We tokenize and stem once, instead of every pass.
-  //
-  // This is 4x faster than tokenizing+stemming each pass, but it gulps
-  // memory -- about 1kb/bio. 20M bios => 20GB.
-  std::cerr << "Tokenizing and stemming..." << std::endl;
-  twittok::Tokenizer tokenizer;
-  std::forward_list<twittok::Bio> bios;
-  size_t n = 0;
-  for (const auto& untokenizedBio : untokenizedBios.untokenizedBios) {
-    bios.emplace_front(twittok::Bio::buildByTokenizing(untokenizedBio, tokenizer));
-    n++;
-    if (n % 1000000 == 0) {
-      std::cerr << "Tokenized and stemmed " << (n / 1000000) << "M bios" << std::endl;
-    }
+  twittok::Vocabulary vocabulary;
+  twittok::StemCache stemCache(vocabulary);
+  twittok::BioStore bios(stemCache);
+  std::unique_ptr<twittok::NgramPass<1> > pass1(new twittok::NgramPass<1>(twittok::NgramPass<1>::PrefixSet()));
+  const bool pass1InPipeline = pipeline && engine == Engine::Apriori;
+
+  const twittok::BioCounts counts = pipeline
+    ? readBiosInPipeline(csvFilename, &bios, pass1InPipeline ? pass1.get() : NULL)
+    : readBios(csvFilename, &bios, dedup);
+  bios.shrinkToFit();
+
+  std::cerr << "Stem cache: " << stemCache.nHits() << " hits, " << stemCache.nMisses() << " misses, "
+    << stemCache.size() << " distinct tokens" << std::endl;
+  logCasefoldStats();
+
+  std::cerr << "Outputting statistics on " << counts.nWithBio() << " bios" << std::endl;
+  if (format == twittok::ResultsFormat::Text) {
+    counts.dump(tokensFile);
+  } else {
+    twittok::writeBinaryResultsHeader(tokensFile, counts);
   }
 
+  std::cerr << "Stored " << bios.size() << " bios: " << bios.nTokens() << " tokens, "
+    << vocabulary.size() << " distinct stems, " << ((bios.nBytes() + vocabulary.nBytes()) / 1024 / 1024) << "MB" << std::endl;
+
   const size_t MinCount = 100;
-  std::unordered_set<std::string> prefixes;
-
-  prefixes = doPass<1>(prefixes, bios, tokensFile, MinCount);
-  prefixes = doPass<2>(prefixes, bios, tokensFile, MinCount);
-  prefixes = doPass<3>(prefixes, bios, tokensFile, MinCount);
-  prefixes = doPass<4>(prefixes, bios, tokensFile, MinCount);
-  prefixes = doPass<5>(prefixes, bios, tokensFile, MinCount);
-  prefixes = doPass<6>(prefixes, bios, tokensFile, MinCount);
-  prefixes = doPass<7>(prefixes, bios, tokensFile, MinCount);
-  prefixes = doPass<8>(prefixes, bios, tokensFile, MinCount);
-  prefixes = doPass<9>(prefixes, bios, tokensFile, MinCount);
-  prefixes = doPass<10>(prefixes, bios, tokensFile, MinCount);
+
+  if (engine == Engine::SuffixArray) {
+    std::cerr << "Counting ngrams with a suffix array..." << std::endl;
+    twittok::SuffixArrayNgramCounter counter(bios, MinCount);
+    counter.count(std::thread::hardware_concurrency());
+    counter.dump(tokensFile, std::thread::hardware_concurrency(), format);
+    return 0;
+  }
+
+  if (!pass1InPipeline) pass1->scanBios(bios, std::thread::hardware_concurrency());
+  pass1->dump(tokensFile, bios.vocabulary(), MinCount, std::thread::hardware_concurrency(), format);
+  const auto grams1 = pass1->ngramKeys(MinCount);
+  pass1.reset();
+
+  // Each pass's frequent ngrams are the next pass's prefixes
+  const auto grams2 = doPass<2>(grams1, bios, tokensFile, MinCount, format);
+  const auto grams3 = doPass<3>(grams2, bios, tokensFile, MinCount, format);
+  const auto grams4 = doPass<4>(grams3, bios, tokensFile, MinCount, format);
+  const auto grams5 = doPass<5>(grams4, bios, tokensFile, MinCount, format);
+  const auto grams6 = doPass<6>(grams5, bios, tokensFile, MinCount, format);
+  const auto grams7 = doPass<7>(grams6, bios, tokensFile, MinCount, format);
+  const auto grams8 = doPass<8>(grams7, bios, tokensFile, MinCount, format);
+  const auto grams9 = doPass<9>(grams8, bios, tokensFile, MinCount, format);
+  doPass<10>(grams9, bios, tokensFile, MinCount, format);
 
   return 0;
 }
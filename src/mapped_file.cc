@@ -0,0 +1,57 @@
+#include "mapped_file.h"
+
+#include <cstdint>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace twittok {
+
+MappedFile::MappedFile(const char* filename)
+  : data_(0)
+  , size_(0)
+{
+  int fd = open(filename, O_RDONLY);
+  if (fd == -1) throw "Could not open file";
+
+  struct stat st;
+  if (fstat(fd, &st) == -1) {
+    close(fd);
+    throw "Could not stat file";
+  }
+
+  size_ = st.st_size;
+
+  if (size_ > 0) {
+    void* addr = mmap(NULL, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+      close(fd);
+      throw "Could not mmap file";
+    }
+    data_ = static_cast<const char*>(addr);
+  }
+
+  close(fd); // the mapping keeps its own reference
+
+  adviseSequential(begin(), end());
+}
+
+MappedFile::~MappedFile()
+{
+  if (data_) munmap(const_cast<char*>(data_), size_);
+}
+
+void
+MappedFile::adviseSequential(const char* begin, const char* end) const
+{
+  if (begin == end) return;
+
+  // madvise() wants a page-aligned address
+  static const uintptr_t PageMask = ~static_cast<uintptr_t>(sysconf(_SC_PAGESIZE) - 1);
+  const uintptr_t alignedBegin = reinterpret_cast<uintptr_t>(begin) & PageMask;
+
+  madvise(reinterpret_cast<void*>(alignedBegin), reinterpret_cast<uintptr_t>(end) - alignedBegin, MADV_SEQUENTIAL);
+}
+
+} // namespace twittok
@@ -0,0 +1,39 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+
+namespace twittok {
+
+/**
+ * A read-only file, mmap()ed into memory.
+ *
+ * The bytes stay valid for as long as this object lives. On error, throws.
+ */
+class MappedFile {
+public:
+  MappedFile(const char* filename);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  inline const char* data() const { return data_; }
+  inline size_t size() const { return size_; }
+  inline const char* begin() const { return data_; }
+  inline const char* end() const { return data_ + size_; }
+
+  /**
+   * Tells the kernel we'll read [begin, end) front to back, so it reads ahead
+   * aggressively and drops pages we've passed.
+   */
+  void adviseSequential(const char* begin, const char* end) const;
+
+private:
+  const char* data_;
+  size_t size_;
+};
+
+} // namespace twittok
+
+#endif /* MAPPED_FILE_H */
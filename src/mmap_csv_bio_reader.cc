@@ -0,0 +1,305 @@
+#include "mmap_csv_bio_reader.h"
+
+#include <algorithm>
+
+namespace twittok {
+
+const size_t MmapCsvBioReader::UnescapedChunkSize;
+
+MmapCsvBioReader::MmapCsvBioReader(const char* filename)
+  : file_(new MappedFile(filename))
+  , begin_(file_->begin())
+  , end_(file_->end())
+  , index_(begin_, end_)
+  , unescapedChunkUsed_(UnescapedChunkSize)
+{
+}
+
+MmapCsvBioReader::MmapCsvBioReader(const char* begin, const char* end)
+  : begin_(begin)
+  , end_(end)
+  , index_(begin_, end_)
+  , unescapedChunkUsed_(UnescapedChunkSize)
+{
+}
+
+// Unlike CsvBioReader, we never refill: when we hit end_, that's EOF.
+#define returnWithErrorIfAtEnd(error) do { if (begin_ == end_) { *err = Error::error; return; } } while(false)
+#define returnValueWithErrorIfAtEnd(value, error) do { if (begin_ == end_) { *err = Error::error; return value; } } while(false)
+
+char*
+MmapCsvBioReader::allocateUnescaped(size_t len)
+{
+  if (unescapedChunkUsed_ + len > UnescapedChunkSize) {
+    // A bio is far smaller than a chunk, so the slack we waste is tiny.
+    unescapedChunks_.emplace_back(new char[std::max(len, UnescapedChunkSize)]);
+    unescapedChunkUsed_ = 0;
+  }
+
+  char* ret = unescapedChunks_.back().get() + unescapedChunkUsed_;
+  unescapedChunkUsed_ += len;
+  return ret;
+}
+
+/**
+ * Reads the usual "[id],[0|1],[0|1]," prefix of a line, using the index to
+ * find the end of the id.
+ *
+ * Returns false without consuming anything if the prefix is the least bit
+ * unusual. The caller then reads it byte by byte, to report the same errors
+ * CsvBioReader does.
+ */
+bool
+MmapCsvBioReader::readPrefixQuickly(uint64_t* id, bool* followsClinton, bool* followsTrump)
+{
+  static const size_t MaxSafeDigits = 19; // 10^19 - 1 < 2^64 - 1
+
+  const char* comma = index_.findComma(begin_, std::min(end_, begin_ + MaxSafeDigits + 1));
+  if (comma == NULL || comma == begin_ || *begin_ == '0' || end_ - comma < 5) return false;
+
+  uint64_t ret = 0;
+  for (const char* p = begin_; p < comma; p++) {
+    const unsigned int digit = *p - '0';
+    if (digit > 9) return false;
+    ret = ret * 10 + digit;
+  }
+
+  const unsigned int clinton = comma[1] - '0';
+  const unsigned int trump = comma[3] - '0';
+  if (clinton > 1 || comma[2] != ',' || trump > 1 || comma[4] != ',') return false;
+
+  *id = ret;
+  *followsClinton = clinton == 1;
+  *followsTrump = trump == 1;
+  begin_ = comma + 5;
+  return true;
+}
+
+/**
+ * See CsvBioReader::readUint64AndComma(). Errors are identical.
+ */
+uint64_t
+MmapCsvBioReader::readUint64AndComma(Error* err) {
+  uint64_t ret = 0;
+
+  returnValueWithErrorIfAtEnd(0, ExpectedUint64);
+
+  while (begin_ < end_) {
+    char c = *begin_;
+    begin_++;
+
+    if (c == ',') return ret; // success!
+
+    if (c < '0' || c > '9') {
+      *err = Error::ExpectedComma;
+      return ret;
+    }
+    if (ret == 0 && c == '0') {
+      *err = Error::ExpectedUint64;
+      return ret;
+    }
+
+    uint64_t next = ret * 10 + (c - '0');
+    if (next < ret) {
+      *err = Error::Uint64OutOfRange;
+      return ret;
+    }
+    ret = next;
+  }
+
+  *err = Error::ExpectedComma;
+  return 0; // EOF
+}
+
+bool
+MmapCsvBioReader::readBool(Error* err)
+{
+  returnValueWithErrorIfAtEnd(false, Expected0Or1);
+
+  char c = *begin_;
+  begin_++;
+
+  switch (c) {
+    case '0': return false;
+    case '1': return true;
+    default:
+      *err = Error::Expected0Or1;
+      return false;
+  }
+}
+
+void
+MmapCsvBioReader::consumeComma(Error* err)
+{
+  returnWithErrorIfAtEnd(ExpectedComma);
+
+  if (*begin_ != ',') *err = Error::ExpectedComma;
+  begin_++;
+}
+
+void
+MmapCsvBioReader::consumeNewline(Error* err)
+{
+  returnWithErrorIfAtEnd(ExpectedNewline);
+
+  if (*begin_ != '\n') *err = Error::ExpectedNewline;
+  begin_++;
+}
+
+meta::util::string_view
+MmapCsvBioReader::readSimpleString(size_t max_len, Error* err)
+{
+  const char* start = begin_;
+  size_t len = std::min(max_len, static_cast<size_t>(end_ - begin_));
+
+  const char* newline = index_.findNewline(start, start + len);
+  if (newline != NULL) {
+    begin_ = newline;
+    return { start, static_cast<size_t>(newline - start) };
+  }
+
+  if (len == max_len && start + max_len < end_ && start[max_len] == '\n') {
+    // Lucky! The byte right after the longest allowed bio is the newline
+    begin_ = start + max_len;
+    return { start, max_len };
+  }
+
+  *err = Error::ExpectedNewline;
+  return {};
+}
+
+/**
+ * Returns a string of size 0-max_len.
+ *
+ * We assume begin_ is pointing at a '"'. We read until the first '"' that is
+ * not followed by another '"'.
+ *
+ * We scan once to find where the string ends. If there were no `""` in it,
+ * we return a pointer into the input. Otherwise, we unescape into our own
+ * buffer.
+ */
+meta::util::string_view
+MmapCsvBioReader::readQuotedString(size_t max_len, Error* err)
+{
+  begin_++;
+  returnValueWithErrorIfAtEnd({}, ExpectedEndQuote);
+
+  const char* start = begin_;
+  const char* stringEnd = NULL; // the closing quote
+  size_t unescapedLen = 0;
+  bool hasEscapedQuote = false;
+
+  while (unescapedLen < max_len) {
+    size_t len = std::min(max_len - unescapedLen, static_cast<size_t>(end_ - begin_));
+
+    const char* quote = index_.findQuote(begin_, begin_ + len);
+    if (quote == NULL) {
+      unescapedLen += len;
+      begin_ += len;
+      returnValueWithErrorIfAtEnd({}, ExpectedEndQuote);
+      continue;
+    }
+
+    unescapedLen += quote - begin_;
+    begin_ = quote + 1;
+    returnValueWithErrorIfAtEnd({}, ExpectedNewline);
+
+    if (*begin_ != '"') {
+      stringEnd = quote;
+      break;
+    }
+
+    // That was a double-quote: it unescapes to one '"'
+    hasEscapedQuote = true;
+    unescapedLen++;
+    begin_++;
+    returnValueWithErrorIfAtEnd({}, ExpectedEndQuote);
+  }
+
+  if (stringEnd == NULL) {
+    // We read max_len unescaped bytes. The next one had better end the string.
+    if (*begin_ != '"') {
+      *err = Error::ExpectedEndQuote;
+      return {};
+    }
+    stringEnd = begin_;
+    begin_++;
+    returnValueWithErrorIfAtEnd({}, ExpectedNewline);
+    if (*begin_ == '"') {
+      *err = Error::ExpectedEndQuote;
+      return {};
+    }
+    unescapedLen = max_len;
+  }
+
+  if (!hasEscapedQuote) {
+    return { start, unescapedLen };
+  }
+
+  char* out = allocateUnescaped(unescapedLen);
+  size_t copied = 0;
+  for (const char* p = start; p < stringEnd && copied < unescapedLen; p++) {
+    out[copied++] = *p;
+    if (*p == '"') p++; // skip the escaping quote
+  }
+
+  return { out, copied };
+}
+
+meta::util::string_view
+MmapCsvBioReader::readString(size_t max_len, Error* err)
+{
+  returnValueWithErrorIfAtEnd({}, ExpectedNewline);
+
+  if (*begin_ == '\n') {
+    // empty bio
+    return {};
+  }
+
+  if (*begin_ == '"') {
+    return readQuotedString(max_len, err);
+  } else {
+    return readSimpleString(max_len, err);
+  }
+}
+
+UntokenizedBioRef
+MmapCsvBioReader::nextBio(Error* err)
+{
+  *err = Error::Success;
+
+  returnValueWithErrorIfAtEnd(UntokenizedBioRef(), EndOfInput);
+
+#define FAIL_IF_ERROR() if(*err != Error::Success) return UntokenizedBioRef()
+
+  uint64_t id;
+  bool followsClinton;
+  bool followsTrump;
+
+  if (!readPrefixQuickly(&id, &followsClinton, &followsTrump)) {
+    id = readUint64AndComma(err);
+    FAIL_IF_ERROR();
+
+    followsClinton = readBool(err);
+    FAIL_IF_ERROR();
+    consumeComma(err);
+    FAIL_IF_ERROR();
+
+    followsTrump = readBool(err);
+    FAIL_IF_ERROR();
+    consumeComma(err);
+    FAIL_IF_ERROR();
+  }
+
+  meta::util::string_view utf8 = readString(UntokenizedBio::MaxBioBytes, err);
+  FAIL_IF_ERROR();
+
+  consumeNewline(err);
+  FAIL_IF_ERROR();
+
+#undef FAIL_IF_ERROR
+
+  return { id, followsClinton, followsTrump, utf8 };
+}
+
+} // namespace twittok
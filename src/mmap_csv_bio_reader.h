@@ -0,0 +1,79 @@
+#ifndef MMAP_CSV_BIO_READER_H
+#define MMAP_CSV_BIO_READER_H
+
+#include <memory>
+#include <vector>
+
+#include "csv_bio_reader.h"
+#include "csv_structural_index.h"
+#include "mapped_file.h"
+#include "untokenized_bio.h"
+
+namespace twittok {
+
+/**
+ * Reads the same CSV as CsvBioReader, without copying it.
+ *
+ * Each UntokenizedBioRef points straight into the input bytes. The only
+ * exception is a quoted bio containing an escaped quote (`""`): we unescape
+ * that into a buffer owned by this reader.
+ *
+ * We find quotes and newlines with a CsvStructuralIndex, so we examine 64
+ * bytes per step instead of one.
+ *
+ * Every UntokenizedBioRef stays valid for as long as this reader lives.
+ */
+class MmapCsvBioReader {
+public:
+  typedef CsvBioReader::Error Error;
+
+  /**
+   * Maps the given file into memory. Throws if that fails.
+   */
+  MmapCsvBioReader(const char* filename);
+
+  /**
+   * Reads [begin, end), which the caller must keep alive.
+   */
+  MmapCsvBioReader(const char* begin, const char* end);
+
+  MmapCsvBioReader(const MmapCsvBioReader&) = delete;
+  MmapCsvBioReader& operator=(const MmapCsvBioReader&) = delete;
+
+  /**
+   * Returns another Bio.
+   *
+   * Iff we reach EOF, then the return value will isNull() == true.
+   */
+  UntokenizedBioRef nextBio(Error* error);
+
+  /**
+   * Returns a pointer to the next byte nextBio() will read.
+   */
+  inline const char* position() const { return begin_; }
+
+private:
+  bool readPrefixQuickly(uint64_t* id, bool* followsClinton, bool* followsTrump);
+  uint64_t readUint64AndComma(Error* error);
+  bool readBool(Error* error);
+  meta::util::string_view readSimpleString(size_t max_len, Error* error);
+  meta::util::string_view readQuotedString(size_t max_len, Error* error);
+  meta::util::string_view readString(size_t max_len, Error* error);
+  void consumeComma(Error* error);
+  void consumeNewline(Error* error);
+
+  char* allocateUnescaped(size_t len);
+
+  static const size_t UnescapedChunkSize = 64 * 1024;
+
+  std::unique_ptr<MappedFile> file_; // NULL if the caller owns the bytes
+  const char* begin_;
+  const char* end_;
+  CsvStructuralIndex index_;
+  std::vector<std::unique_ptr<char[]> > unescapedChunks_;
+  size_t unescapedChunkUsed_;
+};
+
+} // namespace twittok
+
+#endif /* MMAP_CSV_BIO_READER_H */
@@ -3,54 +3,68 @@
 
 #include <algorithm>
 #include <array>
+#include <cstdint>
 #include <string>
 
 #include "string_ref.h"
+#include "vocabulary.h"
 
 namespace twittok {
 
+/**
+ * The stemmed tokens that make up an ngram: what we count.
+ */
+template<size_t N> using NgramKey = std::array<TokenId, N>;
+
+/**
+ * Hashes an NgramKey, for use in hash tables.
+ */
+struct NgramKeyHash {
+  template<size_t N>
+  size_t operator()(const NgramKey<N>& key) const {
+    uint64_t h = N;
+    for (size_t i = 0; i < N; i++) {
+      h = (h ^ key[i]) * 0x9e3779b97f4a7c15ull;
+      h ^= h >> 32;
+    }
+
+    // MurmurHash3's finalizer: every input bit affects the low bits, which
+    // pick the bucket
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+  }
+};
+
 template<size_t N>
 class Ngram {
 public:
-  std::array<std::string, N> grams;
+  NgramKey<N> grams;
   StringRef original;
 
   /**
    * Returns all but the last (stemmed) word in the ngram.
    */
-  std::string prefixGramsString() const {
-    if (N == 1) return std::string();
-
-    size_t len = N - 2; // spaces
-    for (size_t i = 0; i < N - 1; i++) {
-      len += grams[i].size();
-    }
-
-    std::string ret(len, ' '); // spaces so we don't need to write them in between
-    size_t pos = 0;
-    for (size_t i = 0; i < N - 1; i++) {
-      ret.replace(pos, grams[i].size(), grams[i]);
-      pos += grams[i].size() + 1;
-    }
-
+  NgramKey<N - 1> prefixGrams() const {
+    NgramKey<N - 1> ret;
+    std::copy(grams.begin(), grams.begin() + N - 1, ret.begin());
     return ret;
   }
 
-  std::string gramsString() const {
-    if (N == 1) return grams[0];
-
-    size_t len = N - 1; // spaces
-    for (size_t i = 0; i < N; i++) {
-      len += grams[i].size();
-    }
-
-    std::string ret(len, ' '); // spaces so we don't need to write them in between
-    size_t pos = 0;
+  /**
+   * Returns the stemmed words, separated by spaces.
+   *
+   * This is slow: it's for output, not counting.
+   */
+  std::string gramsString(const Vocabulary& vocabulary) const {
+    std::string ret;
     for (size_t i = 0; i < N; i++) {
-      ret.replace(pos, grams[i].size(), grams[i]);
-      pos += grams[i].size() + 1;
+      if (i > 0) ret += ' ';
+      ret += vocabulary.string(grams[i]);
     }
-
     return ret;
   }
 
@@ -60,23 +74,16 @@ public:
    * Even if this returns true, the original strings may be different.
    */
   bool operator==(const Ngram<N>& rhs) const {
-    for (size_t i = 0; i < N; i++) {
-      if (grams[i] != rhs.grams[i]) return false;
-    }
-    return true;
+    return grams == rhs.grams;
   }
 
   /**
    * Returns whether LHS grams < RHS grams.
+   *
+   * This compares ids, not strings: it's only useful for grouping.
    */
   bool operator<(const Ngram<N>& rhs) const {
-    for (size_t i = 0; i < N; i++) {
-      int c = grams[i].compare(rhs.grams[i]);
-      if (c < 0) return true;
-      if (c > 0) return false;
-    }
-
-    return false;
+    return grams < rhs.grams;
   }
 };
 
@@ -0,0 +1,275 @@
+#include "ngram_index.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "stemmer.h"
+
+namespace twittok {
+
+namespace {
+
+const char Magic[8] = { 't', 'w', 't', 'k', 'i', 'd', 'x', '\x01' };
+const size_t NHeaderFields = 5; // seed, nKeys, nSpellings, nKeyBytes, nStringBytes
+
+inline size_t
+padTo8(size_t nBytes)
+{
+  return (nBytes + 7) & ~static_cast<size_t>(7);
+}
+
+template<typename T>
+void
+writeArray(std::ostream& os, const T* values, size_t size)
+{
+  os.write(reinterpret_cast<const char*>(values), size * sizeof(T));
+}
+
+/**
+ * Adds the bytes of size Ts, padded to 8, to *total. Returns false if the
+ * sum doesn't fit in a uint64_t: sizes come from the file.
+ */
+template<typename T>
+bool
+addSection(uint64_t size, uint64_t* total)
+{
+  if (size > (UINT64_MAX - 7) / sizeof(T)) return false;
+  const uint64_t nBytes = padTo8(size * sizeof(T));
+  if (nBytes > UINT64_MAX - *total) return false;
+  *total += nBytes;
+  return true;
+}
+
+/**
+ * Throws unless offsets[0, size] start at 0, never decrease and end at end.
+ */
+void
+checkOffsets(const uint64_t* offsets, uint64_t size, uint64_t end)
+{
+  if (offsets[0] != 0 || offsets[size] != end) throw std::runtime_error("Invalid offsets in twittok index");
+  for (uint64_t i = 1; i <= size; i++) {
+    if (offsets[i] < offsets[i - 1]) throw std::runtime_error("Invalid offsets in twittok index");
+  }
+}
+
+/**
+ * Hands out consecutive arrays from the mmap()ed index.
+ */
+class Sections {
+public:
+  Sections(const char* data) : pos_(data) {}
+
+  template<typename T>
+  const T* take(size_t size) {
+    const T* ret = reinterpret_cast<const T*>(pos_);
+    pos_ += padTo8(size * sizeof(T));
+    return ret;
+  }
+
+private:
+  const char* pos_;
+};
+
+} // namespace ""
+
+meta::util::string_view
+NgramIndex::Record::key() const
+{
+  const uint64_t begin = index_->keyBegin_[slot_];
+  return meta::util::string_view(index_->keys_ + begin, index_->keyBegin_[slot_ + 1] - begin);
+}
+
+meta::util::string_view
+NgramIndex::Record::spelling(size_t i) const
+{
+  const uint64_t j = index_->spellingBegin_[slot_] + i;
+  const uint64_t begin = index_->stringBegin_[j];
+  return meta::util::string_view(index_->strings_ + begin, index_->stringBegin_[j + 1] - begin);
+}
+
+uint64_t
+NgramIndex::Record::spellingN(size_t i) const
+{
+  return index_->spellingN_[index_->spellingBegin_[slot_] + i];
+}
+
+NgramIndex::NgramIndex(const char* filename)
+  : file_(new MappedFile(filename))
+{
+  load(file_->data(), file_->size());
+}
+
+NgramIndex::NgramIndex(const char* data, size_t size)
+{
+  load(data, size);
+}
+
+void
+NgramIndex::load(const char* data, size_t size)
+{
+  const size_t headerSize = sizeof(Magic) + NHeaderFields * sizeof(uint64_t);
+  if (size < headerSize || memcmp(data, Magic, sizeof(Magic)) != 0) throw std::runtime_error("Not a twittok index");
+
+  uint64_t header[NHeaderFields];
+  memcpy(header, data + sizeof(Magic), sizeof(header));
+  const uint64_t seed = header[0];
+  nKeys_ = header[1];
+  const uint64_t nSpellings = header[2];
+  const uint64_t nKeyBytes = header[3];
+  const uint64_t nStringBytes = header[4];
+
+  // Every size is from the file, so a corrupt one may overflow the sum
+  if (nKeys_ == UINT64_MAX || nSpellings == UINT64_MAX) throw std::runtime_error("Truncated twittok index");
+  uint64_t expectedSize = headerSize;
+  bool fits = addSection<uint32_t>(PerfectHash::nBucketsFor(nKeys_), &expectedSize)
+    && addSection<uint64_t>(nKeys_ + 1, &expectedSize); // keyBegin
+  for (size_t i = 0; i < 5; i++) {
+    fits = fits && addSection<uint64_t>(nKeys_, &expectedSize); // n, nClinton, nTrump, nBoth, nVariants
+  }
+  fits = fits
+    && addSection<uint64_t>(nKeys_ + 1, &expectedSize) // spellingBegin
+    && addSection<uint64_t>(nSpellings, &expectedSize) // spellingN
+    && addSection<uint64_t>(nSpellings + 1, &expectedSize) // stringBegin
+    && addSection<char>(nKeyBytes, &expectedSize)
+    && addSection<char>(nStringBytes, &expectedSize);
+  if (!fits || size != expectedSize) throw std::runtime_error("Truncated twittok index");
+
+  Sections sections(data + headerSize);
+  const uint32_t* displacements = sections.take<uint32_t>(PerfectHash::nBucketsFor(nKeys_));
+  hash_ = PerfectHash(seed, nKeys_, displacements);
+  keyBegin_ = sections.take<uint64_t>(nKeys_ + 1);
+  n_ = sections.take<uint64_t>(nKeys_);
+  nClinton_ = sections.take<uint64_t>(nKeys_);
+  nTrump_ = sections.take<uint64_t>(nKeys_);
+  nBoth_ = sections.take<uint64_t>(nKeys_);
+  nVariants_ = sections.take<uint64_t>(nKeys_);
+  spellingBegin_ = sections.take<uint64_t>(nKeys_ + 1);
+  spellingN_ = sections.take<uint64_t>(nSpellings);
+  stringBegin_ = sections.take<uint64_t>(nSpellings + 1);
+  keys_ = sections.take<char>(nKeyBytes);
+  strings_ = sections.take<char>(nStringBytes);
+
+  // Record reads through these without checking, so check them all now.
+  // (Slots need no check: PerfectHash only returns slots in [0, nKeys).)
+  checkOffsets(keyBegin_, nKeys_, nKeyBytes);
+  checkOffsets(spellingBegin_, nKeys_, nSpellings);
+  checkOffsets(stringBegin_, nSpellings, nStringBytes);
+}
+
+bool
+NgramIndex::find(meta::util::string_view key, Record* record) const
+{
+  if (nKeys_ == 0) return false;
+
+  const uint64_t slot = hash_(key.data(), key.size());
+  const Record found(this, slot);
+  if (found.key() != key) return false; // the perfect hash maps strangers anywhere
+
+  *record = found;
+  return true;
+}
+
+bool
+NgramIndex::findPhrase(const Tokenizer& tokenizer, meta::util::string_view phrase, std::string* key, Record* record) const
+{
+  phraseKey(tokenizer, phrase, key);
+  return find(*key, record);
+}
+
+size_t
+NgramIndex::phraseKey(const Tokenizer& tokenizer, meta::util::string_view phrase, std::string* key)
+{
+  key->clear();
+  size_t nStems = 0;
+
+  for (const auto& token : tokenizer.tokenize(re2::StringPiece(phrase.data(), phrase.size()))) {
+    const std::string stemmed = stemmer::stem(token.data(), token.size());
+    if (stemmed.empty()) continue;
+    if (nStems > 0) key->push_back(' ');
+    key->append(stemmed);
+    nStems++;
+  }
+
+  return nStems;
+}
+
+void
+NgramIndexBuilder::addBlock(const ResultsBlock& block)
+{
+  for (size_t i = 0; i < block.size(); i++) {
+    const std::string key(block.keys.data() + block.keyBegin[i], block.keyBegin[i + 1] - block.keyBegin[i]);
+    if (!seen_.insert(key).second) throw std::runtime_error("Ngram \"" + key + "\" is in the results twice");
+  }
+
+  records_.append(block);
+}
+
+void
+NgramIndexBuilder::write(std::ostream& os) const
+{
+  const uint64_t nKeys = records_.size();
+
+  std::vector<meta::util::string_view> keyViews;
+  keyViews.reserve(nKeys);
+  for (uint64_t i = 0; i < nKeys; i++) {
+    keyViews.emplace_back(records_.keys.data() + records_.keyBegin[i], records_.keyBegin[i + 1] - records_.keyBegin[i]);
+  }
+  uint64_t seed = 0;
+  std::vector<uint32_t> displacements;
+  PerfectHash::build(keyViews, &seed, &displacements);
+
+  // recordAt[slot]: the record the perfect hash puts there
+  const PerfectHash hash(seed, nKeys, displacements.data());
+  std::vector<uint64_t> recordAt(nKeys);
+  for (uint64_t i = 0; i < nKeys; i++) {
+    recordAt[hash(keyViews[i].data(), keyViews[i].size())] = i;
+  }
+
+  // Lay out every column in slot order
+  std::vector<uint64_t> keyBegin(1, 0);
+  std::string keys;
+  std::vector<uint64_t> columns[5]; // n, nClinton, nTrump, nBoth, nVariants
+  std::vector<uint64_t> spellingBegin(1, 0);
+  std::vector<uint64_t> spellingN;
+  std::vector<uint64_t> stringBegin(1, 0);
+  std::vector<char> strings;
+
+  for (uint64_t slot = 0; slot < nKeys; slot++) {
+    const uint64_t i = recordAt[slot];
+
+    keys.append(keyViews[i].data(), keyViews[i].size());
+    keyBegin.push_back(keys.size());
+
+    columns[0].push_back(records_.n[i]);
+    columns[1].push_back(records_.nClinton[i]);
+    columns[2].push_back(records_.nTrump[i]);
+    columns[3].push_back(records_.nBoth[i]);
+    columns[4].push_back(records_.nVariants[i]);
+
+    for (uint64_t j = records_.spellingBegin[i]; j < records_.spellingBegin[i + 1]; j++) {
+      spellingN.push_back(records_.spellingN[j]);
+      strings.insert(strings.end(), records_.strings.begin() + records_.stringBegin[j], records_.strings.begin() + records_.stringBegin[j + 1]);
+      stringBegin.push_back(strings.size());
+    }
+    spellingBegin.push_back(spellingN.size());
+  }
+
+  const uint64_t header[NHeaderFields] = { seed, nKeys, spellingN.size(), keys.size(), strings.size() };
+  const char zeros[8] = {};
+
+  os.write(Magic, sizeof(Magic));
+  writeArray(os, header, NHeaderFields);
+  writeArray(os, displacements.data(), displacements.size());
+  os.write(zeros, padTo8(displacements.size() * sizeof(uint32_t)) - displacements.size() * sizeof(uint32_t));
+  writeArray(os, keyBegin.data(), keyBegin.size());
+  for (const auto& column : columns) writeArray(os, column.data(), column.size());
+  writeArray(os, spellingBegin.data(), spellingBegin.size());
+  writeArray(os, spellingN.data(), spellingN.size());
+  writeArray(os, stringBegin.data(), stringBegin.size());
+  os.write(keys.data(), keys.size());
+  os.write(zeros, padTo8(keys.size()) - keys.size());
+  os.write(strings.data(), strings.size());
+  os.write(zeros, padTo8(strings.size()) - strings.size());
+}
+
+} // namespace twittok
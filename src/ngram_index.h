@@ -0,0 +1,150 @@
+#ifndef NGRAM_INDEX_H
+#define NGRAM_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "mapped_file.h"
+#include "perfect_hash.h"
+#include "results_file.h"
+#include "tokenizer.h"
+#include "util/string_view.h"
+
+namespace twittok {
+
+/**
+ * Counts and spellings of every ngram in a results file, looked up by
+ * phrase.
+ *
+ * An index is one file, which we mmap() rather than read: opening it costs
+ * one pass over the offset columns, which we check, and a lookup touches a
+ * handful of pages. Ngrams are keyed by
+ * their stems, separated by spaces ("proud mom" for "Proud moms"), and a
+ * PerfectHash maps each key to its slot. Like ResultsBlock, the file is
+ * columns of uint64_ts in host byte order, indexed by slot:
+ *
+ *   "twtkidx\x01", seed, nKeys, nSpellings, nKeyBytes, nStringBytes
+ *   displacements[PerfectHash::nBucketsFor(nKeys)] (uint32_t, padded to 8 bytes)
+ *   keyBegin[nKeys + 1]
+ *   n[nKeys], nClinton[nKeys], nTrump[nKeys], nBoth[nKeys], nVariants[nKeys]
+ *   spellingBegin[nKeys + 1], spellingN[nSpellings], stringBegin[nSpellings + 1]
+ *   keys[nKeyBytes], strings[nStringBytes]
+ *
+ * NgramIndexBuilder writes it.
+ */
+class NgramIndex {
+public:
+  /**
+   * One ngram's counts and spellings, most common first. Valid as long as
+   * the NgramIndex is.
+   */
+  class Record {
+  public:
+    Record() : index_(NULL), slot_(0) {}
+    Record(const NgramIndex* index, uint64_t slot) : index_(index), slot_(slot) {}
+
+    inline uint64_t n() const { return index_->n_[slot_]; }
+    inline uint64_t nClinton() const { return index_->nClinton_[slot_]; }
+    inline uint64_t nTrump() const { return index_->nTrump_[slot_]; }
+    inline uint64_t nBoth() const { return index_->nBoth_[slot_]; }
+    inline uint64_t nVariants() const { return index_->nVariants_[slot_]; }
+    inline size_t nSpellings() const { return index_->spellingBegin_[slot_ + 1] - index_->spellingBegin_[slot_]; }
+    meta::util::string_view key() const;
+    meta::util::string_view spelling(size_t i) const;
+    uint64_t spellingN(size_t i) const;
+
+  private:
+    const NgramIndex* index_;
+    uint64_t slot_;
+  };
+
+  /**
+   * Maps the index file. Throws if it's missing, or std::runtime_error if it
+   * isn't an index or is corrupt.
+   */
+  explicit NgramIndex(const char* filename);
+
+  /**
+   * Reads an index from memory, which must outlive us and be 8-byte aligned.
+   */
+  NgramIndex(const char* data, size_t size);
+
+  NgramIndex(const NgramIndex&) = delete;
+  NgramIndex& operator=(const NgramIndex&) = delete;
+
+  inline size_t size() const { return nKeys_; }
+
+  /**
+   * Returns the record in a slot, in [0, size()).
+   */
+  inline Record at(uint64_t slot) const { return Record(this, slot); }
+
+  /**
+   * Finds an ngram by key: its stems, separated by spaces.
+   */
+  bool find(meta::util::string_view key, Record* record) const;
+
+  /**
+   * Finds an ngram by phrase: we tokenize and stem it, the way twittok did
+   * the bios. *key is scratch space; after this, it holds the phrase's key.
+   */
+  bool findPhrase(const Tokenizer& tokenizer, meta::util::string_view phrase, std::string* key, Record* record) const;
+
+  /**
+   * Sets *key to phrase's stems, separated by spaces, and returns how many
+   * stems there are. Tokens stemmer::stem() skips are left out.
+   */
+  static size_t phraseKey(const Tokenizer& tokenizer, meta::util::string_view phrase, std::string* key);
+
+private:
+  void load(const char* data, size_t size);
+
+  std::unique_ptr<MappedFile> file_; // NULL if we read from memory
+  uint64_t nKeys_;
+  PerfectHash hash_;
+  const uint64_t* keyBegin_;
+  const uint64_t* n_;
+  const uint64_t* nClinton_;
+  const uint64_t* nTrump_;
+  const uint64_t* nBoth_;
+  const uint64_t* nVariants_;
+  const uint64_t* spellingBegin_;
+  const uint64_t* spellingN_;
+  const uint64_t* stringBegin_;
+  const char* keys_;
+  const char* strings_;
+};
+
+/**
+ * Gathers ngrams from results files and writes an NgramIndex.
+ */
+class NgramIndexBuilder {
+public:
+  /**
+   * Adds every record in block, keyed by the stems dump() stored with it.
+   *
+   * Throws std::runtime_error if we already have one of its keys: a perfect
+   * hash needs distinct keys, and which record to keep is anyone's guess.
+   */
+  void addBlock(const ResultsBlock& block);
+
+  inline size_t size() const { return records_.size(); }
+
+  /**
+   * Builds the perfect hash and writes the index.
+   */
+  void write(std::ostream& os) const;
+
+private:
+  std::unordered_set<std::string> seen_; // records_' keys, for finding duplicates
+  ResultsBlock records_; // every block's, end to end
+};
+
+} // namespace twittok
+
+#endif /* NGRAM_INDEX_H */
@@ -32,4 +32,39 @@ NgramInfo::OriginalTexts::operator[](const StringRef& string)
   }
 }
 
+void
+NgramInfo::OriginalTexts::merge(const OriginalTexts& rhs)
+{
+  Items merged(values.get_allocator());
+  merged.reserve(values.size() + rhs.values.size());
+
+  auto it = values.begin();
+  auto rhsIt = rhs.values.begin();
+
+  while (it != values.end() && rhsIt != rhs.values.end()) {
+    if (*it < rhsIt->string) {
+      merged.push_back(*it++);
+    } else if (*rhsIt < it->string) {
+      merged.push_back(*rhsIt++);
+    } else {
+      merged.push_back({ it->string, it->n + rhsIt->n });
+      ++it;
+      ++rhsIt;
+    }
+  }
+  merged.insert(merged.end(), it, values.end());
+  merged.insert(merged.end(), rhsIt, rhs.values.end());
+
+  values.swap(merged);
+}
+
+void
+NgramInfo::merge(const NgramInfo& rhs)
+{
+  nClinton += rhs.nClinton;
+  nTrump += rhs.nTrump;
+  nBoth += rhs.nBoth;
+  originalTexts.merge(rhs.originalTexts);
+}
+
 } // namespace twittok
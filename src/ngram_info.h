@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <vector>
 
+#include "arena.h"
 #include "string_ref.h"
 
 namespace twittok {
@@ -19,6 +20,9 @@ struct NgramInfo {
     // enough).
     //
     // Bonus: a vector uses half the RAM of a map.
+    //
+    // NgramPass puts these vectors in an Arena, so growing them is cheap and
+    // freeing them is free.
 
     struct Item {
       StringRef string;
@@ -26,9 +30,16 @@ struct NgramInfo {
       bool operator<(const StringRef& rhs) const;
     };
 
+    typedef std::vector<Item, ArenaAllocator<Item> > Items;
+
     uint32_t& operator[](const StringRef& string);
 
-    std::vector<Item> values;
+    /**
+     * Adds every count in rhs to ours. Linear: both vectors are sorted.
+     */
+    void merge(const OriginalTexts& rhs);
+
+    Items values;
   }; // struct OriginalTexts
 
   size_t nClinton;
@@ -36,6 +47,11 @@ struct NgramInfo {
   size_t nBoth; // for the number of clinton and NOT trump, use nClinton - nBoth
   OriginalTexts originalTexts;
 
+  /**
+   * Adds rhs's counts to ours, as if we had scanned its bios, too.
+   */
+  void merge(const NgramInfo& rhs);
+
   inline size_t nTotal() const { return nClinton + nTrump - nBoth; }
   inline size_t nVariants() const { return originalTexts.values.size(); }
 };
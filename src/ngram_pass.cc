@@ -1,105 +1,169 @@
 #include "ngram_pass.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
 #include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "casefold.h"
 #include "ngram_info.h"
+#include "results_file.h"
 
 namespace {
 
-class NgramToDump {
+/**
+ * Compares strings byte by byte, like std::string::compare().
+ */
+inline int
+compareBytes(const twittok::StringRef& a, const twittok::StringRef& b)
+{
+  const int c = memcmp(a.data(), b.data(), std::min(a.size(), b.size()));
+  if (c != 0) return c;
+  return a.size() < b.size() ? -1 : (a.size() > b.size() ? 1 : 0);
+}
+
+/**
+ * Prepares NgramInfos for dump(), folding together spellings that
+ * casefold_and_normalize() says are the same: "LGBT", "lgbt" and "Lgbt" are
+ * one variant, and we write it the way it's most commonly spelled.
+ *
+ * Folding is linear in the number of spellings: we casefold each one once,
+ * into one buffer, and group them with a hash table keyed on the folded
+ * text. Only the variants we write get sorted.
+ *
+ * We keep spellings with newlines and tabs: the binary format can hold them,
+ * and ResultsBlock::writeText() skips them. Casefolding never adds or removes
+ * a newline or tab, so they only fold with each other, and skipping them
+ * later leaves the other variants just as if we'd skipped them here.
+ *
+ * One VariantFolder serves every NgramInfo in a dump(), so its buffers only
+ * grow when an ngram has more spellings than any before it.
+ */
+class VariantFolder {
 public:
-  std::string original;
-  std::string folded;
-  size_t n;
+  /**
+   * Adds a record for info, keyed by key, to *block, with the most common
+   * spelling of each variant that occurs at least minCount times. If no
+   * variant does, adds nothing.
+   */
+  void fold(const twittok::NgramInfo& info, const std::string& key, size_t minCount, twittok::ResultsBlock* block);
+
+private:
+  typedef twittok::NgramInfo::OriginalTexts::Item Item;
+
+  struct Spelling {
+    const Item* item;
+    size_t foldedBegin; // in folded_
+    size_t foldedSize;
+  };
+
+  struct Variant {
+    twittok::StringRef folded;
+    twittok::StringRef original; // its most common spelling
+    size_t nOriginal; // how often that spelling occurs
+    size_t n; // how often every spelling occurs
+
+    bool operator<(const Variant& rhs) const {
+      // Sort order is most-common to least-common: that is, high n to low n
+      if (n != rhs.n) return n > rhs.n;
+      return compareBytes(folded, rhs.folded) < 0;
+    }
+  };
 
-  NgramToDump() {} // so it can go in a vector
+  struct Key {
+    twittok::StringRef folded;
 
-  NgramToDump(const twittok::NgramInfo::OriginalTexts::Item& item)
-    : original(item.string.to_string())
-    , folded(twittok::casefold_and_normalize(original))
-    , n(item.n)
-  {
-  }
+    inline bool operator==(const Key& rhs) const { return folded == rhs.folded; }
+    inline bool operator<(const Key& rhs) const { return compareBytes(folded, rhs.folded) < 0; } // only called on hash collisions
+  };
 
-  bool operator<(const NgramToDump& rhs) const {
-    // Sort order is most-common to least-common: that is, high n to low n
-    if (n > rhs.n) return true;
-    if (n < rhs.n) return false;
-    return folded < rhs.folded;
-  }
+  struct KeyHash {
+    inline size_t operator()(const Key& key) const { return key.folded.hash(); }
+  };
+
+  std::vector<Spelling> spellings_;
+  std::vector<Variant> variants_;
+  twittok::FlatHashMap<Key, size_t, KeyHash> indexes_; // folded text => index in variants_, plus one (0 means "new")
+  std::string folded_; // every spelling's folded text, end to end
+  std::string scratch_; // one spelling's folded text
 };
 
 void
-dumpNgramInfo(const twittok::NgramInfo& info, std::ostream& os, size_t minCount) {
+VariantFolder::fold(const twittok::NgramInfo& info, const std::string& key, size_t minCount, twittok::ResultsBlock* block)
+{
   if (info.nTotal() < minCount) return; // optimization
 
-  // 1. Sort tokens by most to least common
-  std::vector<NgramToDump> vector;
-  vector.reserve(info.originalTexts.values.size());
-  for (const auto& original : info.originalTexts.values) {
-    auto ngramToDump = NgramToDump(original);
-
-    // Completely ignore anything with a special character that breaks output
-    //
-    // These stay in "nVariants" because we do _count_ each occurrence as an
-    // alternate spelling. We just won't output all of them.
-    if (ngramToDump.original.find('\n') != std::string::npos) continue;
-    if (ngramToDump.original.find('\t') != std::string::npos) continue;
-
-    vector.push_back(ngramToDump);
+  // Most ngrams have just one spelling: nothing to fold.
+  const auto& items(info.originalTexts.values);
+  if (items.size() == 1) {
+    if (items[0].n < minCount) return;
+    block->addRecord(info, key.data(), key.size());
+    block->addSpelling(items[0].string.data(), items[0].string.size(), items[0].n);
+    return;
   }
 
-  std::sort(vector.begin(), vector.end());
+  // 1. Casefold every spelling. We make StringRefs only once we're done
+  // appending, because appending may move folded_.
+  spellings_.clear();
+  folded_.clear();
+  for (const auto& item : items) {
+    twittok::casefold_and_normalize(item.string.data(), item.string.size(), &scratch_);
+    spellings_.push_back(Spelling{ &item, folded_.size(), scratch_.size() });
+    folded_.append(scratch_);
+  }
 
-  // 2. Fold items together: two identical spellings get added together
-  // This is an in-place edit of the list, akin to std::unique(). It's O(n^2)
-  // but we assume these lists are pretty small. The "out" list is the output;
-  // the "in" list is the part of the vector we have not yet inspected. One
-  // step involves taking an "in" and comparing with each "out": if we match,
-  // we merge the two and move on. Otherwise, we move the "in" item into the
-  // "out" list.
-  //
-  // Notice why we do this _after_ step 1: it's so that we only show the most
-  // common capitalization (e.g., "LGBT" instead of "lgbt").
-  auto outEnd = vector.begin();
-
-  for (auto inIt = vector.begin(); inIt != vector.end(); ++inIt) {
-    const NgramToDump& in = *inIt;
-    bool matched = false;
-
-    for (auto outIt = vector.begin(); outIt != outEnd; ++outIt) {
-      NgramToDump& out = *outIt;
-      if (out.folded == in.folded) {
-        // We found a dup
-        matched = true;
-        out.n += in.n;
-        break;
-      }
+  // 2. Fold identical spellings together, in one pass. Each variant keeps its
+  // most common spelling (e.g., "LGBT" instead of "lgbt"). If two spellings
+  // are equally common, the one that sorts first byte by byte wins, so the
+  // choice doesn't depend on the order we stored them in.
+  variants_.clear();
+  indexes_.clear();
+  indexes_.reserve(spellings_.size()); // we never iterate it, so its order doesn't matter
+  for (const auto& spelling : spellings_) {
+    const Item& item(*spelling.item);
+    const twittok::StringRef folded(folded_.data() + spelling.foldedBegin, spelling.foldedSize);
+
+    size_t& index(indexes_[Key{ folded }]);
+    if (index == 0) {
+      variants_.push_back(Variant{ folded, item.string, item.n, 0 });
+      index = variants_.size();
     }
 
-    if (!matched) {
-      // Move our input item to the end of the output
-      if (outEnd != inIt) *outEnd = in;
-      ++outEnd;
+    Variant& variant(variants_[index - 1]);
+    variant.n += item.n;
+    if (item.n > variant.nOriginal || (item.n == variant.nOriginal && compareBytes(item.string, variant.original) < 0)) {
+      variant.original = item.string;
+      variant.nOriginal = item.n;
     }
   }
-  // anything past outEnd is noise
-  vector.resize(std::distance(vector.begin(), outEnd));
 
-  // 3. Sort again: this time for output
-  std::sort(vector.begin(), vector.end());
+  // 3. Output every variant that occurs at least minCount times, most common
+  // first.
+  variants_.erase(
+    std::remove_if(variants_.begin(), variants_.end(), [minCount](const Variant& v) { return v.n < minCount; }),
+    variants_.end()
+  );
+  if (variants_.empty()) return;
 
-  // 4. Output every spelling that has occurs more than minCount times
-  if (vector[0].n < minCount) return;
+  std::sort(variants_.begin(), variants_.end());
 
-  os << info.nClinton << "\t" << info.nTrump << "\t" << info.nBoth << "\t" << info.nVariants() << "\n";
+  block->addRecord(info, key.data(), key.size());
+  for (const auto& variant : variants_) {
+    block->addSpelling(variant.original.data(), variant.original.size(), variant.n);
+  }
+}
 
-  for (const auto& item : vector) {
-    if (item.n < minCount) return;
+const size_t DumpChunkSize = 256; // ngrams per chunk: see NgramPass::dump()
 
-    os << item.original << "\n";
-  }
+void
+logArenaStats(size_t n, const twittok::Arena::Stats& stats) {
+  std::cerr << "Pass " << n << ": spellings use " << (stats.nBlockBytes / 1024 / 1024) << "MB of arena, "
+    << stats.nAllocations << " allocations (" << stats.nReused << " reused), "
+    << stats.nLarge << " large" << std::endl;
 }
 
 }; // namespace
@@ -108,48 +172,184 @@ namespace twittok {
 
 template<size_t N>
 void
-NgramPass<N>::dump(std::ostream& os, size_t minCount) const {
-  for (const auto& pair : gramToInfo) {
-    dumpNgramInfo(pair.second, os, minCount);
+NgramPass<N>::dump(std::ostream& os, const Vocabulary& vocabulary, size_t minCount, size_t nThreads, ResultsFormat format) const {
+  typedef typename NgramTable::Entry Entry;
+
+  // We output the most frequent ngrams first, breaking ties by their stems,
+  // byte by byte. That order depends only on which ngrams are frequent and
+  // how frequent they are -- not on hash tables, threads or TokenIds, which
+  // several tokenizer threads hand out in no particular order -- so any
+  // engine that finds the same frequent ngrams writes the same bytes, and
+  // two runs' output diffs cleanly.
+  std::vector<const Entry*> frequent;
+  for (const auto& entry : gramToInfo) {
+    if (entry.value.nTotal() >= minCount) frequent.push_back(&entry);
+  }
+
+  std::sort(frequent.begin(), frequent.end(), [&vocabulary](const Entry* a, const Entry* b) {
+    const size_t aTotal = a->value.nTotal();
+    const size_t bTotal = b->value.nTotal();
+    if (aTotal != bTotal) return aTotal > bTotal;
+    for (size_t i = 0; i < N; i++) {
+      if (a->key[i] == b->key[i]) continue; // same id, same stem
+      return vocabulary.string(a->key[i]) < vocabulary.string(b->key[i]);
+    }
+    return false;
+  });
+
+  // Fold chunks of ngrams on nThreads threads, each chunk into its own
+  // ResultsBlock. Threads take the next chunk when they finish one: the first
+  // chunks hold the most frequent ngrams, which tend to have the most
+  // spellings to fold.
+  const size_t nChunks = (frequent.size() + DumpChunkSize - 1) / DumpChunkSize;
+  std::vector<ResultsBlock> chunks(nChunks, ResultsBlock(N));
+  std::atomic<size_t> nextChunk(0);
+
+  auto formatChunks = [&vocabulary, &frequent, &chunks, &nextChunk, nChunks, minCount]() {
+    VariantFolder folder;
+    std::string key; // the ngram's stems, as NgramIndex looks them up
+    for (size_t chunk = nextChunk++; chunk < nChunks; chunk = nextChunk++) {
+      const size_t begin = chunk * DumpChunkSize;
+      const size_t end = std::min(begin + DumpChunkSize, frequent.size());
+      for (size_t i = begin; i < end; i++) {
+        key.clear();
+        for (size_t j = 0; j < N; j++) {
+          if (j > 0) key.push_back(' ');
+          key.append(vocabulary.string(frequent[i]->key[j]));
+        }
+        folder.fold(frequent[i]->value, key, minCount, &chunks[chunk]);
+      }
+    }
+  };
+
+  const size_t nFormatThreads = std::max(static_cast<size_t>(1), std::min(nThreads, nChunks));
+  if (nFormatThreads == 1) {
+    formatChunks();
+  } else {
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < nFormatThreads; i++) threads.emplace_back(formatChunks);
+    for (auto& thread : threads) thread.join();
+  }
+
+  if (format == ResultsFormat::Text) {
+    for (const auto& chunk : chunks) chunk.writeText(os);
+  } else {
+    ResultsBlock block(N);
+    for (const auto& chunk : chunks) block.append(chunk);
+    block.write(os);
   }
 }
 
 template<size_t N>
 void
-NgramPass<N>::scanBios(const std::forward_list<Bio>& bios) {
-  size_t n = 0;
-  for (const auto& bio : bios) {
-    n++;
-    if (n % 1000000 == 0) {
-      std::cerr << "Pass " << N << ": " << (n / 1000000) << "M bios..." << std::endl;
+NgramPass<N>::scanRange(const BioStore& bios, size_t begin, size_t end, NgramTable* table, Arena* arena, std::atomic<size_t>* nScanned) const {
+  static const size_t ProgressInterval = 1 << 16;
+
+  Arena::Scope scope(arena); // so new NgramInfos use it
+
+  std::vector<uint32_t> starts; // reused for every bio
+
+  for (size_t i = begin; i < end; i++) {
+    const Bio bio = bios[i];
+
+    if ((i - begin + 1) % ProgressInterval == 0) {
+      const size_t n = nScanned->fetch_add(ProgressInterval) + ProgressInterval;
+      if (n / 1000000 != (n - ProgressInterval) / 1000000) {
+        std::cerr << "Pass " << N << ": " << (n / 1000000) << "M bios..." << std::endl;
+      }
     }
 
-    for (const auto& ngram : bio.ngrams<N>()) {
-      if (N == 1 || prefixes.find(ngram.prefixGramsString()) != prefixes.end()) {
-        NgramInfo& info = gramToInfo[ngram.gramsString()];
-        if (bio.followsClinton) info.nClinton++;
-        if (bio.followsTrump) info.nTrump++;
-        if (bio.followsClinton && bio.followsTrump) info.nBoth++;
-        ++info.originalTexts[ngram.original];
+    bio.distinctNgramStarts<N>(&starts);
+    for (const uint32_t start : starts) {
+      if (N == 1 || prefixes.contains(bio.gramsAt<N - 1>(start))) {
+        NgramInfo& info = (*table)[bio.gramsAt<N>(start)];
+        info.nClinton += bio.weight.nClinton;
+        info.nTrump += bio.weight.nTrump;
+        info.nBoth += bio.weight.nBoth;
+        info.originalTexts[bio.originalAt(start, N)] += bio.weight.n;
+      }
+    }
+  }
+}
+
+template<size_t N>
+void
+NgramPass<N>::scanBios(const BioStore& bios, size_t nThreads) {
+  const size_t nRanges = std::max(static_cast<size_t>(1), std::min(nThreads, bios.size()));
+  std::atomic<size_t> nScanned(0);
+
+  if (nRanges == 1) {
+    scanRange(bios, 0, bios.size(), &gramToInfo, arenas_[0].get(), &nScanned);
+    logArenaStats(N, arenaStats());
+    return;
+  }
+
+  std::vector<NgramTable> tables(nRanges);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < nRanges; i++) {
+    const size_t begin = bios.size() * i / nRanges;
+    const size_t end = bios.size() * (i + 1) / nRanges;
+    arenas_.emplace_back(new Arena());
+    threads.emplace_back(&NgramPass<N>::scanRange, this, std::cref(bios), begin, end, &tables[i], arenas_.back().get(), &nScanned);
+  }
+  for (auto& thread : threads) thread.join();
+
+  // Merge into whatever we already counted, freeing each table as we go.
+  //
+  // Don't reserve(): a FlatHashMap's iteration order depends on its capacity,
+  // and growing one insert at a time gives the same capacity as a serial scan.
+  Arena::Scope scope(arenas_[0].get());
+  for (auto& table : tables) {
+    if (gramToInfo.empty()) {
+      gramToInfo = std::move(table);
+    } else {
+      for (const auto& entry : table) {
+        gramToInfo[entry.key].merge(entry.value);
       }
     }
+    table = NgramTable();
   }
+
+  logArenaStats(N, arenaStats());
+}
+
+template<size_t N>
+void
+NgramPass<N>::scanBios(const BioStore& bios, size_t begin, size_t end) {
+  std::atomic<size_t> nScanned(0);
+  scanRange(bios, begin, end, &gramToInfo, arenas_[0].get(), &nScanned);
+}
+
+template<size_t N>
+Arena::Stats
+NgramPass<N>::arenaStats() const
+{
+  Arena::Stats ret = Arena::Stats();
+  for (const auto& arena : arenas_) {
+    const Arena::Stats stats = arena->stats();
+    ret.nBlocks += stats.nBlocks;
+    ret.nBlockBytes += stats.nBlockBytes;
+    ret.nAllocations += stats.nAllocations;
+    ret.nReused += stats.nReused;
+    ret.nLarge += stats.nLarge;
+  }
+  return ret;
 }
 
 template<size_t N>
-std::unordered_set<std::string>
-NgramPass<N>::ngramStrings(size_t minCount) const
+typename NgramPass<N>::NgramSet
+NgramPass<N>::ngramKeys(size_t minCount) const
 {
   // This pass, we got some ngrams. Every ngram we see in the _next_ pass will
   // start with an ngram from _this_ pass. But minCount is our threshold:
   // any ngram that appears fewer than minCount times is worthless to us, and
   // so any _prefix_ that appears fewer than minCount times is useless.
 
-  std::unordered_set<std::string> ret;
+  NgramSet ret;
 
-  for (const auto& it : gramToInfo) {
-    if (it.second.nTotal() >= minCount) {
-      ret.insert(it.first);
+  for (const auto& entry : gramToInfo) {
+    if (entry.value.nTotal() >= minCount) {
+      ret.insert(entry.key);
     }
   }
 
@@ -1,34 +1,89 @@
 #ifndef NGRAM_PASS_H
 #define NGRAM_PASS_H
 
-#include <forward_list>
+#include <atomic>
+#include <memory>
 #include <ostream>
-#include <string>
-#include <unordered_map>
-#include <unordered_set>
+#include <vector>
 
-#include "bio.h"
+#include "arena.h"
+#include "bio_store.h"
+#include "flat_hash_map.h"
+#include "ngram.h"
 #include "ngram_info.h"
+#include "results_file.h"
+#include "vocabulary.h"
 
 namespace twittok {
 
 /**
  * Given ngrams of length N, tallies ngrams of length N+1.
+ *
+ * scanBios() can split the bios among threads. Each thread counts its own
+ * contiguous range of bios into its own table, and then we merge the tables
+ * in range order. Counts are sums and OriginalTexts are sorted sets, and a
+ * FlatHashMap's iteration order depends only on its keys, so the result
+ * is identical to a single-threaded scan, down to the order of dump().
+ *
+ * Every NgramInfo's spellings live in an Arena that belongs to the pass:
+ * one per scanning thread, plus one for this thread. They're all freed with
+ * the pass. Copy an NgramInfo (rather than moving it) to keep it longer.
  */
 template<size_t N>
 class NgramPass {
 public:
-  NgramPass(const std::unordered_set<std::string>& prefixes)
+  typedef FlatHashSet<NgramKey<N - 1>, NgramKeyHash> PrefixSet;
+  typedef FlatHashSet<NgramKey<N>, NgramKeyHash> NgramSet;
+  typedef FlatHashMap<NgramKey<N>, NgramInfo, NgramKeyHash> NgramTable;
+
+  NgramPass(const PrefixSet& prefixes)
     : prefixes(prefixes)
   {
+    arenas_.emplace_back(new Arena());
+  }
+
+  ~NgramPass() {
+    gramToInfo = NgramTable(); // before the Arenas its NgramInfos use
   }
 
-  void scanBios(const std::forward_list<Bio>& bios);
-  void dump(std::ostream& os, size_t minCount) const;
-  std::unordered_set<std::string> ngramStrings(size_t minCount) const;
+  NgramPass(const NgramPass&) = delete;
+  NgramPass& operator=(const NgramPass&) = delete;
+
+  /**
+   * Tallies every bio's ngrams, on nThreads threads.
+   */
+  void scanBios(const BioStore& bios, size_t nThreads = 1);
+
+  /**
+   * Tallies bios [begin, end), on this thread: for counting bios as they're
+   * added to the store.
+   */
+  void scanBios(const BioStore& bios, size_t begin, size_t end);
+
+  /**
+   * Writes every ngram that occurs at least minCount times, with its
+   * spellings, formatting them on nThreads threads.
+   *
+   * Output is sorted, most frequent first, then by stems: it doesn't depend
+   * on nThreads, or on the order our stems' TokenIds were handed out in.
+   * vocabulary holds those stems. In ResultsFormat::Binary, it's one
+   * ResultsBlock, which keeps each ngram's stems as its key.
+   */
+  void dump(std::ostream& os, const Vocabulary& vocabulary, size_t minCount, size_t nThreads = 1, ResultsFormat format = ResultsFormat::Text) const;
+  NgramSet ngramKeys(size_t minCount) const;
+
+  /**
+   * Returns the totals of all our Arenas' stats.
+   */
+  Arena::Stats arenaStats() const;
+
+  PrefixSet prefixes; // calculated in previous pass
+  NgramTable gramToInfo; // calculated this pass
+
+private:
+  void scanRange(const BioStore& bios, size_t begin, size_t end, NgramTable* table, Arena* arena, std::atomic<size_t>* nScanned) const;
 
-  std::unordered_set<std::string> prefixes; // calculated in previous pass
-  std::unordered_map<std::string, NgramInfo> gramToInfo; // calculated this pass
+  std::vector<std::unique_ptr<Arena> > arenas_; // arenas_[0] is this thread's
 };
 
 } // namespace twittok
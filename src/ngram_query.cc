@@ -0,0 +1,184 @@
+#include "ngram_query.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+#include "stemmer.h"
+
+namespace twittok {
+
+const size_t NgramQueryEngine::MaxStemBytes;
+
+namespace {
+
+void
+appendCounts(std::string* response, uint64_t n, uint64_t nClinton, uint64_t nTrump, uint64_t nBoth, uint64_t nVariants)
+{
+  for (const uint64_t count : { n, nClinton, nTrump, nBoth, nVariants }) {
+    response->push_back('\t');
+    response->append(std::to_string(count));
+  }
+}
+
+/**
+ * Appends "key \t n \t nClinton \t nTrump \t nBoth \t nVariants \t spelling\n".
+ */
+void
+appendRecord(std::string* response, const NgramIndex::Record& record)
+{
+  const meta::util::string_view key = record.key();
+  response->append(key.data(), key.size());
+  appendCounts(response, record.n(), record.nClinton(), record.nTrump(), record.nBoth(), record.nVariants());
+  response->push_back('\t');
+
+  // Spellings are most common first; skip any that would break the line
+  for (size_t i = 0; i < record.nSpellings(); i++) {
+    const meta::util::string_view spelling = record.spelling(i);
+    if (spelling.find_first_of("\t\n") == meta::util::string_view::npos) {
+      response->append(spelling.data(), spelling.size());
+      break;
+    }
+  }
+
+  response->push_back('\n');
+}
+
+void
+appendError(std::string* response, const char* reason)
+{
+  response->assign("error\t");
+  response->append(reason);
+  response->push_back('\n');
+}
+
+} // namespace ""
+
+const std::string&
+NgramQueryEngine::Context::stem(const Tokenizer::Token& token)
+{
+  this->token.assign(token.data(), token.size());
+  auto found = stems.find(this->token);
+  if (found != stems.end()) return found->second;
+
+  if (nStemBytes > MaxStemBytes) {
+    stems.clear();
+    nStemBytes = 0;
+  }
+  found = stems.emplace(this->token, stemmer::stem(token.data(), token.size())).first;
+  nStemBytes += sizeof(*found) + found->first.size() + found->second.size();
+  return found->second;
+}
+
+NgramQueryEngine::NgramQueryEngine(const NgramIndex& index)
+  : index_(index)
+{
+  std::vector<double> skews(index.size());
+  towardClinton_.reserve(index.size());
+  for (uint64_t slot = 0; slot < index.size(); slot++) {
+    skews[slot] = skew(index.at(slot));
+    towardClinton_.push_back(slot);
+  }
+  towardTrump_ = towardClinton_;
+
+  // Break ties the same way every time: more common first, then by key
+  const auto tieBreak = [&](uint64_t a, uint64_t b) {
+    const NgramIndex::Record ra = index_.at(a);
+    const NgramIndex::Record rb = index_.at(b);
+    if (ra.n() != rb.n()) return ra.n() > rb.n();
+    return ra.key() < rb.key();
+  };
+
+  std::sort(towardClinton_.begin(), towardClinton_.end(), [&](uint64_t a, uint64_t b) {
+    if (skews[a] != skews[b]) return skews[a] > skews[b];
+    return tieBreak(a, b);
+  });
+  std::sort(towardTrump_.begin(), towardTrump_.end(), [&](uint64_t a, uint64_t b) {
+    if (skews[a] != skews[b]) return skews[a] < skews[b];
+    return tieBreak(a, b);
+  });
+}
+
+double
+NgramQueryEngine::skew(const NgramIndex::Record& record)
+{
+  return std::log2(static_cast<double>(record.nClinton() + 1) / static_cast<double>(record.nTrump() + 1));
+}
+
+void
+NgramQueryEngine::answer(meta::util::string_view request, Context* context, std::string* response) const
+{
+  const size_t newline = request.find('\n');
+  const meta::util::string_view commandLine = request.substr(0, newline);
+  const meta::util::string_view rest = newline == meta::util::string_view::npos
+    ? meta::util::string_view()
+    : request.substr(newline + 1);
+
+  std::istringstream command(std::string(commandLine.data(), commandLine.size()));
+  std::string verb;
+  command >> verb;
+
+  if (verb == "lookup") {
+    std::string extra;
+    if (command >> extra) return appendError(response, "lookup takes no arguments: put phrases on the lines after it");
+    lookup(rest, context, response);
+  } else if (verb == "top") {
+    std::string side;
+    long long k = -1;
+    std::string extra;
+    command >> side >> k;
+    if (!command || k < 0 || (side != "clinton" && side != "trump") || (command >> extra)) {
+      return appendError(response, "usage: top clinton|trump K");
+    }
+    if (!rest.empty()) return appendError(response, "top takes one line");
+    top(side == "clinton", static_cast<size_t>(k), response);
+  } else {
+    appendError(response, "unknown command: try lookup or top");
+  }
+}
+
+void
+NgramQueryEngine::lookup(meta::util::string_view phrases, Context* context, std::string* response) const
+{
+  response->assign("ok\n");
+
+  while (!phrases.empty()) {
+    const size_t newline = phrases.find('\n');
+    const meta::util::string_view phrase = phrases.substr(0, newline);
+    phrases = newline == meta::util::string_view::npos ? meta::util::string_view() : phrases.substr(newline + 1);
+
+    // The key NgramIndex::phraseKey() makes, from the Context's stems
+    context->key.clear();
+    context->tokens.clear();
+    context->tokenizer.tokenize(re2::StringPiece(phrase.data(), phrase.size()), &context->tokens);
+    for (const auto& token : context->tokens) {
+      const std::string& stemmed = context->stem(token);
+      if (stemmed.empty()) continue;
+      if (!context->key.empty()) context->key.push_back(' ');
+      context->key.append(stemmed);
+    }
+
+    NgramIndex::Record record;
+    if (index_.find(context->key, &record)) {
+      appendRecord(response, record);
+    } else {
+      response->append(context->key);
+      appendCounts(response, 0, 0, 0, 0, 0);
+      response->append("\t\n");
+    }
+  }
+}
+
+void
+NgramQueryEngine::top(bool clinton, size_t k, std::string* response) const
+{
+  response->assign("ok\n");
+
+  const std::vector<uint64_t>& slots = clinton ? towardClinton_ : towardTrump_;
+  const size_t n = std::min(k, slots.size());
+  for (size_t i = 0; i < n; i++) {
+    appendRecord(response, index_.at(slots[i]));
+  }
+}
+
+} // namespace twittok
@@ -0,0 +1,99 @@
+#ifndef NGRAM_QUERY_H
+#define NGRAM_QUERY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ngram_index.h"
+#include "tokenizer.h"
+#include "util/string_view.h"
+
+namespace twittok {
+
+/**
+ * Answers questions about an NgramIndex: the requests twittok-serve reads
+ * off its socket.
+ *
+ * A request is text, and its first line is a command:
+ *
+ *   lookup           each line after this one is a phrase to look up
+ *   top clinton K    the K ngrams that skew furthest toward Clinton followers
+ *   top trump K      ... toward Trump followers
+ *
+ * A response is "ok\n", then a line per ngram, like this:
+ *
+ *   key \t n \t nClinton \t nTrump \t nBoth \t nVariants \t spelling
+ *
+ * spelling is the most common one without a tab or newline in it, or ""
+ * if there's none. A phrase that isn't in the index gets a line with its
+ * key and zeros: every ngram in the index has n > 0. A request we can't
+ * parse gets "error\t<reason>\n".
+ *
+ * answer() is safe to call from any number of threads at once, each with
+ * its own Context.
+ */
+class NgramQueryEngine {
+public:
+  static const size_t MaxStemBytes = 4 * 1024 * 1024; // per Context, roughly
+
+  /**
+   * What one thread reuses from request to request: a Tokenizer, stems of
+   * words it has seen and scratch space.
+   *
+   * Clients can send any words they like, so we don't intern stems, and we
+   * forget every one once they take more than MaxStemBytes. The common words
+   * are back after a request or two.
+   */
+  struct Context {
+    Context() : nStemBytes(0) {}
+
+    /**
+     * Returns stemmer::stem(token), stemming it only if it isn't in stems.
+     */
+    const std::string& stem(const Tokenizer::Token& token);
+
+    Tokenizer tokenizer;
+    std::unordered_map<std::string, std::string> stems; // token => its stem
+    size_t nStemBytes; // what stems holds, roughly
+    std::vector<Tokenizer::Token> tokens;
+    std::string token; // scratch, for looking tokens up in stems
+    std::string key;
+  };
+
+  /**
+   * Ranks the index's ngrams by skew(). The index must outlive us.
+   */
+  explicit NgramQueryEngine(const NgramIndex& index);
+
+  NgramQueryEngine(const NgramQueryEngine&) = delete;
+  NgramQueryEngine& operator=(const NgramQueryEngine&) = delete;
+
+  /**
+   * Returns log2((nClinton + 1) / (nTrump + 1)): positive when Clinton
+   * followers use the ngram more, negative when Trump followers do.
+   *
+   * We don't divide by how many followers each side has: that would shift
+   * every ngram's skew by the same amount, and leave the order alone.
+   */
+  static double skew(const NgramIndex::Record& record);
+
+  /**
+   * Sets *response to the answer to request.
+   */
+  void answer(meta::util::string_view request, Context* context, std::string* response) const;
+
+private:
+  void lookup(meta::util::string_view phrases, Context* context, std::string* response) const;
+  void top(bool clinton, size_t k, std::string* response) const;
+
+  const NgramIndex& index_;
+  std::vector<uint64_t> towardClinton_; // slots, most Clinton-skewed first
+  std::vector<uint64_t> towardTrump_; // slots, most Trump-skewed first
+};
+
+} // namespace twittok
+
+#endif /* NGRAM_QUERY_H */
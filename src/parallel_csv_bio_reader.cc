@@ -0,0 +1,119 @@
+#include "parallel_csv_bio_reader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+namespace twittok {
+
+ParallelCsvBioReader::ParallelCsvBioReader(const char* filename, size_t nThreads)
+  : file_(new MappedFile(filename))
+  , begin_(file_->begin())
+  , end_(file_->end())
+  , nThreads_(std::max(nThreads, static_cast<size_t>(1)))
+  , minBytesPerThread_(DefaultMinBytesPerThread)
+{
+}
+
+ParallelCsvBioReader::ParallelCsvBioReader(const char* begin, const char* end, size_t nThreads, size_t minBytesPerThread)
+  : begin_(begin)
+  , end_(end)
+  , nThreads_(std::max(nThreads, static_cast<size_t>(1)))
+  , minBytesPerThread_(std::max(minBytesPerThread, static_cast<size_t>(1)))
+{
+}
+
+/**
+ * Parses records starting at begin, until one starts at or after
+ * chunk->bound.
+ *
+ * Overwrites whatever chunk held before, except chunk->bound.
+ */
+void
+ParallelCsvBioReader::parseChunk(const char* begin, Chunk* chunk) const
+{
+  chunk->begin = begin;
+  chunk->error = Error::Success;
+  chunk->recordStarts.clear();
+  chunk->bios.clear();
+  chunk->reader.reset(new MmapCsvBioReader(begin, end_));
+
+  while (true) {
+    const char* start = chunk->reader->position();
+    chunk->stop = start;
+    if (start >= chunk->bound) return;
+
+    Error error;
+    UntokenizedBioRef bio = chunk->reader->nextBio(&error);
+
+    if (error == Error::EndOfInput) return;
+
+    if (error != Error::Success) {
+      chunk->error = error;
+      return;
+    }
+
+    chunk->recordStarts.push_back(start);
+    chunk->bios.push_back(bio);
+  }
+}
+
+std::vector<UntokenizedBioRef>
+ParallelCsvBioReader::readAllBios(Error* err)
+{
+  const size_t size = end_ - begin_;
+  const size_t nChunks = std::max(static_cast<size_t>(1), std::min(nThreads_, size / minBytesPerThread_));
+
+  // 1. Guess where each chunk's first record begins: just after a '\n'
+  chunks_ = std::vector<Chunk>(nChunks);
+  std::vector<const char*> guesses(nChunks);
+  guesses[0] = begin_;
+  for (size_t i = 1; i < nChunks; i++) {
+    const char* split = begin_ + size * i / nChunks;
+    const char* newline = static_cast<const char*>(memchr(split - 1, '\n', end_ - split + 1));
+    guesses[i] = newline ? newline + 1 : end_;
+    if (guesses[i] < guesses[i - 1]) guesses[i] = guesses[i - 1];
+  }
+  for (size_t i = 0; i < nChunks; i++) {
+    chunks_[i].bound = i + 1 < nChunks ? guesses[i + 1] : end_;
+  }
+
+  // 2. Parse every chunk from its guess, concurrently
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < nChunks; i++) {
+    threads.emplace_back(&ParallelCsvBioReader::parseChunk, this, guesses[i], &chunks_[i]);
+  }
+  parseChunk(guesses[0], &chunks_[0]); // guesses[0] is the start of the file: it's correct
+  for (auto& thread : threads) thread.join();
+
+  // 3. Stitch: accept each chunk's bios from where the previous chunk's
+  // correct parse stopped
+  std::vector<UntokenizedBioRef> ret;
+
+  for (size_t i = 0; i < nChunks; i++) {
+    Chunk& chunk = chunks_[i];
+    size_t firstValid = 0;
+
+    if (i > 0) {
+      const Chunk& previous = chunks_[i - 1];
+      if (previous.error != Error::Success) break;
+
+      if (chunk.begin != previous.stop) {
+        auto it = std::lower_bound(chunk.recordStarts.begin(), chunk.recordStarts.end(), previous.stop);
+        if (it != chunk.recordStarts.end() && *it == previous.stop) {
+          firstValid = std::distance(chunk.recordStarts.begin(), it);
+        } else {
+          // Our guess was inside a quoted bio. Parse again, correctly.
+          parseChunk(previous.stop, &chunk);
+        }
+      }
+    }
+
+    ret.insert(ret.end(), chunk.bios.begin() + firstValid, chunk.bios.end());
+    *err = chunk.error;
+  }
+
+  return ret;
+}
+
+} // namespace twittok
@@ -0,0 +1,77 @@
+#ifndef PARALLEL_CSV_BIO_READER_H
+#define PARALLEL_CSV_BIO_READER_H
+
+#include <memory>
+#include <vector>
+
+#include "mapped_file.h"
+#include "mmap_csv_bio_reader.h"
+#include "untokenized_bio.h"
+
+namespace twittok {
+
+/**
+ * Reads a bios CSV on several threads at once.
+ *
+ * We split the input into one byte range per thread. Each thread guesses its
+ * range's first record begins after the first '\n' it sees, and parses from
+ * there. That guess is wrong when the '\n' is inside a quoted bio, so we
+ * never trust it blindly: afterwards, we walk the ranges in order, starting
+ * from where the previous range's (correct) parse stopped. If the next range
+ * parsed a record starting at exactly that byte, every record after it is
+ * correct, too. Otherwise, we re-parse that range from the right byte.
+ *
+ * The result is exactly what MmapCsvBioReader would produce on one thread:
+ * the same bios, in the same order, stopping at the same error.
+ */
+class ParallelCsvBioReader {
+public:
+  typedef CsvBioReader::Error Error;
+
+  /**
+   * Maps the given file into memory. Throws if that fails.
+   */
+  ParallelCsvBioReader(const char* filename, size_t nThreads);
+
+  /**
+   * Reads [begin, end), which the caller must keep alive.
+   *
+   * We won't spawn a thread for fewer than minBytesPerThread bytes.
+   */
+  ParallelCsvBioReader(const char* begin, const char* end, size_t nThreads, size_t minBytesPerThread = DefaultMinBytesPerThread);
+
+  /**
+   * Reads every bio, in file order.
+   *
+   * Stops at the first error and sets *error; otherwise sets it to Success.
+   *
+   * The returned bios are valid for as long as this reader lives.
+   */
+  std::vector<UntokenizedBioRef> readAllBios(Error* error);
+
+  static const size_t DefaultMinBytesPerThread = 1024 * 1024;
+
+private:
+  struct Chunk {
+    const char* begin;
+    const char* bound; // we stop at the first record starting at or after this
+    const char* stop; // where we stopped
+    Error error; // Success or a parse error. EOF is Success.
+    std::vector<const char*> recordStarts;
+    std::vector<UntokenizedBioRef> bios;
+    std::unique_ptr<MmapCsvBioReader> reader; // owns unescaped bios
+  };
+
+  void parseChunk(const char* begin, Chunk* chunk) const;
+
+  std::unique_ptr<MappedFile> file_; // NULL if the caller owns the bytes
+  const char* begin_;
+  const char* end_;
+  size_t nThreads_;
+  size_t minBytesPerThread_;
+  std::vector<Chunk> chunks_;
+};
+
+} // namespace twittok
+
+#endif /* PARALLEL_CSV_BIO_READER_H */
@@ -0,0 +1,118 @@
+#include "perfect_hash.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include <city.h>
+
+namespace twittok {
+
+const size_t PerfectHash::KeysPerBucket;
+
+namespace {
+
+const uint64_t NSeeds = 32; // seeds we try before giving up
+const uint64_t MaxTriesPerSlot = 64; // a bucket may try up to this * nKeys displacements
+
+/**
+ * MurmurHash3's finalizer: a good 64-bit mix.
+ */
+inline uint64_t
+mix(uint64_t h)
+{
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdull;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ull;
+  h ^= h >> 33;
+  return h;
+}
+
+} // namespace ""
+
+PerfectHash::Hashes
+PerfectHash::hash(const char* key, size_t len, uint64_t seed, uint64_t nKeys, uint64_t nBuckets)
+{
+  const uint64_t h = CityHash64WithSeed(key, len, seed);
+  const uint64_t h2 = mix(h);
+  return Hashes{ h % nBuckets, h2 % nKeys, mix(h2) % nKeys };
+}
+
+uint64_t
+PerfectHash::operator()(const char* key, size_t len) const
+{
+  const Hashes hashes = hash(key, len, seed_, nKeys_, nBuckets_);
+  return slot(hashes, displacements_[hashes.bucket], nKeys_);
+}
+
+bool
+PerfectHash::tryBuild(const std::vector<meta::util::string_view>& keys, uint64_t seed, std::vector<uint32_t>* displacements)
+{
+  const uint64_t nKeys = keys.size();
+  const uint64_t nBuckets = nBucketsFor(nKeys);
+  const uint64_t maxDisplacement = std::min(
+    static_cast<uint64_t>(std::numeric_limits<uint32_t>::max()),
+    nKeys * MaxTriesPerSlot
+  );
+
+  // Sort keys by bucket, biggest buckets first
+  std::vector<Hashes> hashes(nKeys);
+  std::vector<uint32_t> bucketSizes(nBuckets, 0);
+  for (size_t i = 0; i < nKeys; i++) {
+    hashes[i] = hash(keys[i].data(), keys[i].size(), seed, nKeys, nBuckets);
+    bucketSizes[hashes[i].bucket]++;
+  }
+  std::sort(hashes.begin(), hashes.end(), [&bucketSizes](const Hashes& a, const Hashes& b) {
+    if (bucketSizes[a.bucket] != bucketSizes[b.bucket]) return bucketSizes[a.bucket] > bucketSizes[b.bucket];
+    return a.bucket < b.bucket;
+  });
+
+  displacements->assign(nBuckets, 0);
+  std::vector<bool> taken(nKeys, false);
+  std::vector<uint64_t> slots;
+
+  for (size_t begin = 0; begin < nKeys; ) {
+    const uint64_t bucket = hashes[begin].bucket;
+    const size_t end = begin + bucketSizes[bucket];
+
+    bool placed = false;
+    for (uint64_t d = 0; d <= maxDisplacement && !placed; d++) {
+      slots.clear();
+      placed = true;
+      for (size_t i = begin; i < end; i++) {
+        const uint64_t s = slot(hashes[i], d, nKeys);
+        if (taken[s] || std::find(slots.begin(), slots.end(), s) != slots.end()) {
+          placed = false;
+          break;
+        }
+        slots.push_back(s);
+      }
+
+      if (placed) {
+        (*displacements)[bucket] = static_cast<uint32_t>(d);
+        for (const uint64_t s : slots) taken[s] = true;
+      }
+    }
+
+    if (!placed) return false;
+    begin = end;
+  }
+
+  return true;
+}
+
+void
+PerfectHash::build(const std::vector<meta::util::string_view>& keys, uint64_t* seed, std::vector<uint32_t>* displacements)
+{
+  for (uint64_t s = 0; s < NSeeds; s++) {
+    if (tryBuild(keys, s, displacements)) {
+      *seed = s;
+      return;
+    }
+  }
+
+  throw std::runtime_error("Could not build a perfect hash: are the keys distinct?");
+}
+
+} // namespace twittok
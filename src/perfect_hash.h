@@ -0,0 +1,87 @@
+#ifndef PERFECT_HASH_H
+#define PERFECT_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "util/string_view.h"
+
+namespace twittok {
+
+/**
+ * A minimal perfect hash function: maps each of n distinct keys to its own
+ * slot in [0, n), with one string hash and one table lookup.
+ *
+ * We build it with CHD ("hash, displace and compress", Belazzougui, Botelho
+ * and Dietzfelbinger). Each key hashes to a bucket, of which there are about
+ * n / KeysPerBucket, and to two numbers f1 and f2. Each bucket gets a
+ * displacement d, and a key's slot is (f1 + d0 * f2 + d1) mod n, where
+ * d0 = d / n and d1 = d mod n. build() places the biggest buckets first,
+ * trying d = 0, 1, 2, ... until each of the bucket's keys lands on a free
+ * slot.
+ *
+ * We don't compress the displacements: at 4 bytes per bucket, they cost
+ * about a byte per key.
+ *
+ * A key that wasn't in the build set maps to an arbitrary slot. To tell
+ * whether a key is present, store the keys and compare.
+ *
+ * A PerfectHash doesn't own its displacements, so they can live in an
+ * mmap()ed file.
+ */
+class PerfectHash {
+public:
+  static const size_t KeysPerBucket = 4;
+
+  /**
+   * Finds a perfect hash for keys, which must be distinct. Sets *seed and
+   * *displacements: pass them to the constructor.
+   *
+   * Throws std::runtime_error if we can't find one. That happens when keys
+   * has duplicates.
+   */
+  static void build(const std::vector<meta::util::string_view>& keys, uint64_t* seed, std::vector<uint32_t>* displacements);
+
+  /**
+   * Returns how many displacements build() makes for nKeys keys.
+   */
+  static inline uint64_t nBucketsFor(uint64_t nKeys) { return nKeys == 0 ? 0 : (nKeys + KeysPerBucket - 1) / KeysPerBucket; }
+
+  PerfectHash() : seed_(0), nKeys_(0), nBuckets_(0), displacements_(NULL) {}
+  PerfectHash(uint64_t seed, uint64_t nKeys, const uint32_t* displacements)
+    : seed_(seed)
+    , nKeys_(nKeys)
+    , nBuckets_(nBucketsFor(nKeys))
+    , displacements_(displacements)
+  {}
+
+  /**
+   * Returns key's slot, in [0, nKeys). Requires nKeys > 0.
+   */
+  uint64_t operator()(const char* key, size_t len) const;
+
+private:
+  struct Hashes {
+    uint64_t bucket;
+    uint64_t f1;
+    uint64_t f2;
+  };
+
+  static Hashes hash(const char* key, size_t len, uint64_t seed, uint64_t nKeys, uint64_t nBuckets);
+
+  static inline uint64_t slot(const Hashes& hashes, uint64_t displacement, uint64_t nKeys) {
+    return (hashes.f1 + (displacement / nKeys) * hashes.f2 + displacement % nKeys) % nKeys;
+  }
+
+  static bool tryBuild(const std::vector<meta::util::string_view>& keys, uint64_t seed, std::vector<uint32_t>* displacements);
+
+  uint64_t seed_;
+  uint64_t nKeys_;
+  uint64_t nBuckets_;
+  const uint32_t* displacements_;
+};
+
+} // namespace twittok
+
+#endif /* PERFECT_HASH_H */
@@ -0,0 +1,293 @@
+#include "porter2_buffer_stemmer.h"
+
+#include <cstring>
+
+#include "porter2_suffix_table.h"
+
+namespace twittok {
+
+namespace porter2 {
+
+namespace {
+
+typedef meta::util::string_view string_view;
+
+inline bool
+isVowel(char ch)
+{
+  return ch == 'e' || ch == 'a' || ch == 'i' || ch == 'o' || ch == 'u';
+}
+
+inline bool
+isVowelY(char ch)
+{
+  return isVowel(ch) || ch == 'y';
+}
+
+inline bool
+isValidLIEnding(char ch)
+{
+  return ch == 'c' || ch == 'd' || ch == 'e' || ch == 'g' || ch == 'h'
+    || ch == 'k' || ch == 'm' || ch == 'n' || ch == 'r' || ch == 't';
+}
+
+/**
+ * A word in a Buffer. Each method mirrors the Porter2Stemmer::internal
+ * function of the same name, with word.size() as size.
+ */
+struct Word {
+  char* chars;
+  size_t size;
+
+  inline bool equals(string_view str) const {
+    return size == str.size() && memcmp(chars, str.data(), size) == 0;
+  }
+
+  inline bool endsWith(string_view suffix) const {
+    return size >= suffix.size() && memcmp(chars + size - suffix.size(), suffix.data(), suffix.size()) == 0;
+  }
+
+  inline bool replaceIfExists(string_view suffix, string_view replacement, size_t start) {
+    if (suffix.size() > size) return false;
+
+    const size_t index = size - suffix.size();
+    if (index < start) return false;
+    if (memcmp(chars + index, suffix.data(), suffix.size()) != 0) return false;
+
+    memcpy(chars + index, replacement.data(), replacement.size()); // never longer than suffix
+    size = index + replacement.size();
+    return true;
+  }
+
+  /**
+   * Applies the first rule in the table that matches at or after start, and
+   * returns whether there was one.
+   */
+  template<size_t NRules>
+  inline bool applyFirst(const SuffixTable<NRules>& table, size_t start) {
+    const SuffixRule* rule = table.find(chars, size, start);
+    if (!rule) return false;
+
+    memcpy(chars + size - rule->size, rule->replacement, rule->replacementSize);
+    size = size - rule->size + rule->replacementSize;
+    return true;
+  }
+
+  inline bool containsVowel(size_t start, size_t end) const {
+    if (end > size) return false; // also catches "size - 2" underflowing
+    for (size_t i = start; i < end; i++) {
+      if (isVowelY(chars[i])) return true;
+    }
+    return false;
+  }
+
+  inline bool endsInDouble() const {
+    if (size < 2) return false;
+    const char a = chars[size - 1];
+    return a == chars[size - 2]
+      && (a == 'b' || a == 'd' || a == 'f' || a == 'g' || a == 'm' || a == 'n' || a == 'p' || a == 'r' || a == 't');
+  }
+
+  /**
+   * Returns whether the first `prefix` chars end in a short syllable.
+   */
+  inline bool isShort(size_t prefix) const {
+    if (prefix >= 3) {
+      const char c = chars[prefix - 1];
+      if (!isVowelY(chars[prefix - 3]) && isVowelY(chars[prefix - 2]) && !isVowelY(c) && c != 'w' && c != 'x' && c != 'Y') {
+        return true;
+      }
+    }
+    return prefix == 2 && isVowelY(chars[0]) && !isVowelY(chars[1]);
+  }
+
+  inline size_t firstNonVowelAfterVowel(size_t start) const {
+    for (size_t i = start; i != 0 && i < size; i++) {
+      if (!isVowelY(chars[i]) && isVowelY(chars[i - 1])) return i + 1;
+    }
+    return size;
+  }
+
+  inline bool startsWith(string_view prefix) const {
+    return size >= prefix.size() && memcmp(chars, prefix.data(), prefix.size()) == 0;
+  }
+
+  size_t getStartR1() const {
+    if (startsWith("gener") || startsWith("arsen")) return 5;
+    if (startsWith("commun")) return 6;
+    return firstNonVowelAfterVowel(1);
+  }
+
+  size_t getStartR2(size_t startR1) const {
+    if (startR1 == size) return startR1;
+    return firstNonVowelAfterVowel(startR1 + 1);
+  }
+
+  void changeY() {
+    if (chars[0] == 'y') chars[0] = 'Y';
+    for (size_t i = 1; i < size; i++) {
+      if (chars[i] == 'y' && isVowel(chars[i - 1])) chars[i++] = 'Y'; // skip next iteration
+    }
+  }
+
+  void unchangeY() {
+    for (size_t i = 0; i < size; i++) {
+      if (chars[i] == 'Y') chars[i] = 'y';
+    }
+  }
+
+  bool special() {
+    static const struct { string_view word; string_view stem; } exceptions[] = {
+      { "skis", "ski" },
+      { "skies", "sky" },
+      { "dying", "die" },
+      { "lying", "lie" },
+      { "tying", "tie" },
+      { "idly", "idl" },
+      { "gently", "gentl" },
+      { "ugly", "ugli" },
+      { "early", "earli" },
+      { "only", "onli" },
+      { "singly", "singl" }
+    };
+
+    for (const auto& exception : exceptions) {
+      if (equals(exception.word)) {
+        memcpy(chars, exception.stem.data(), exception.stem.size());
+        size = exception.stem.size();
+        return true;
+      }
+    }
+
+    // invariants
+    return size >= 3 && size <= 5
+      && (equals("sky") || equals("news") || equals("howe") || equals("atlas") || equals("cosmos") || equals("bias") || equals("andes"));
+  }
+
+  void step0() {
+    replaceIfExists("'s'", "", 0) || replaceIfExists("'s", "", 0) || replaceIfExists("'", "", 0);
+  }
+
+  bool step1A() {
+    if (!replaceIfExists("sses", "ss", 0)) {
+      if (endsWith("ied") || endsWith("ies")) {
+        size -= size <= 4 ? 1 : 2; // "ties" -> "tie", "cries" -> "cri"
+      } else if (endsWith("s") && !endsWith("us") && !endsWith("ss")) {
+        if (size > 2 && containsVowel(0, size - 2)) size--;
+      }
+    }
+
+    // special case after step 1a
+    return (size == 6 || size == 7)
+      && (equals("inning") || equals("outing") || equals("canning") || equals("herring")
+          || equals("earring") || equals("proceed") || equals("exceed") || equals("succeed"));
+  }
+
+  void step1B(size_t startR1) {
+    if (endsWith("eedly") || endsWith("eed")) {
+      replaceIfExists("eedly", "ee", startR1) || replaceIfExists("eed", "ee", startR1);
+      return;
+    }
+
+    const size_t oldSize = size;
+    const bool deleted = (containsVowel(0, oldSize - 2) && replaceIfExists("ed", "", 0))
+      || (containsVowel(0, oldSize - 4) && replaceIfExists("edly", "", 0))
+      || (containsVowel(0, oldSize - 3) && replaceIfExists("ing", "", 0))
+      || (containsVowel(0, oldSize - 5) && replaceIfExists("ingly", "", 0));
+    if (!deleted) return;
+
+    if (endsWith("at") || endsWith("bl") || endsWith("iz")) {
+      chars[size++] = 'e'; // we just deleted at least 2 chars
+    } else if (endsInDouble()) {
+      size--;
+    } else if (startR1 == size && isShort(size)) {
+      chars[size++] = 'e';
+    }
+  }
+
+  void step1C() {
+    if (size > 2 && (chars[size - 1] == 'y' || chars[size - 1] == 'Y') && !isVowel(chars[size - 2])) {
+      chars[size - 1] = 'i';
+    }
+  }
+
+  void step2(size_t startR1) {
+    if (applyFirst(Step2Table, startR1)) return;
+
+    if (replaceIfExists("logi", "log", startR1 - 1)) return;
+
+    // make sure we choose the longest suffix
+    if (endsWith("li") && !endsWith("abli") && !endsWith("entli") && !endsWith("aliti")
+        && !endsWith("alli") && !endsWith("ousli") && !endsWith("bli") && !endsWith("fulli")
+        && !endsWith("lessli")
+        && size > 3 && size - 2 >= startR1 && isValidLIEnding(chars[size - 3])) {
+      size -= 2;
+    }
+  }
+
+  void step3(size_t startR1, size_t startR2) {
+    if (applyFirst(Step3Table, startR1)) return;
+
+    replaceIfExists("ative", "", startR2);
+  }
+
+  void step4(size_t startR2) {
+    if (applyFirst(Step4Table, startR2)) return;
+
+    // make sure we only choose the longest suffix
+    if (!endsWith("ement") && !endsWith("ment") && replaceIfExists("ent", "", startR2)) return;
+
+    replaceIfExists("sion", "s", startR2 - 1) || replaceIfExists("tion", "t", startR2 - 1);
+  }
+
+  void step5(size_t startR1, size_t startR2) {
+    if (size == 0) return;
+
+    if (chars[size - 1] == 'e') {
+      if (size - 1 >= startR2 || (size - 1 >= startR1 && !isShort(size - 1))) size--;
+    } else if (chars[size - 1] == 'l') {
+      if (size - 1 >= startR2 && chars[size - 2] == 'l') size--;
+    }
+  }
+};
+
+} // namespace
+
+string_view
+stem(const char* word, size_t len, Buffer* buffer)
+{
+  Word w{ buffer->chars, len < MaxWordSize ? len : MaxWordSize };
+  memcpy(w.chars, word, w.size);
+
+  // special case short words or sentence tags
+  if (w.size <= 2 || w.equals("<s>") || w.equals("</s>")) return string_view(w.chars, w.size);
+
+  if (w.chars[0] == '\'') {
+    w.size--;
+    memmove(w.chars, w.chars + 1, w.size);
+  }
+
+  if (w.special()) return string_view(w.chars, w.size);
+
+  w.changeY();
+  const size_t startR1 = w.getStartR1();
+  const size_t startR2 = w.getStartR2(startR1);
+
+  w.step0();
+
+  if (!w.step1A()) {
+    w.step1B(startR1);
+    w.step1C();
+    w.step2(startR1);
+    w.step3(startR1, startR2);
+    w.step4(startR2);
+    w.step5(startR1, startR2);
+  }
+
+  w.unchangeY();
+  return string_view(w.chars, w.size);
+}
+
+} // namespace porter2
+
+} // namespace twittok
@@ -0,0 +1,50 @@
+#ifndef PORTER2_BUFFER_STEMMER_H
+#define PORTER2_BUFFER_STEMMER_H
+
+#include <cstddef>
+
+#include "util/string_view.h"
+
+namespace twittok {
+
+/**
+ * The Porter2 ("snowball") English stemmer, without the heap.
+ *
+ * Porter2Stemmer::stem() edits a std::string in place: every step erases,
+ * replaces or appends, and each of those may reallocate or memmove. Here, a
+ * word lives in a fixed buffer and a length; removing a suffix is just
+ * shortening the length, and a replacement is a memcpy of at most 4 bytes.
+ *
+ * It stems exactly like Porter2Stemmer::stem(), which we keep as the
+ * reference implementation: porter2_buffer_stemmer_test checks them against
+ * each other.
+ */
+namespace porter2 {
+
+/**
+ * Porter2 truncates longer words to this many bytes, and no step lengthens a
+ * word past it.
+ */
+const size_t MaxWordSize = 35;
+
+/**
+ * Holds one word while we stem it.
+ */
+struct Buffer {
+  char chars[MaxWordSize];
+};
+
+/**
+ * Stems the given word into *buffer, and returns a view of the result.
+ *
+ * The view is valid until *buffer is reused. The word need not be
+ * NULL-terminated, and it may be longer than MaxWordSize: like
+ * Porter2Stemmer::stem(), we only look at the first MaxWordSize bytes.
+ */
+meta::util::string_view stem(const char* word, size_t len, Buffer* buffer);
+
+} // namespace porter2
+
+} // namespace twittok
+
+#endif /* PORTER2_BUFFER_STEMMER_H */
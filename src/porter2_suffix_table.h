@@ -0,0 +1,196 @@
+#ifndef PORTER2_SUFFIX_TABLE_H
+#define PORTER2_SUFFIX_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace twittok {
+
+namespace porter2 {
+
+/**
+ * "If the word ends in suffix, and the suffix starts at or after R, replace
+ * it with replacement."
+ */
+struct SuffixRule {
+  const char* suffix;
+  size_t size;
+  const char* replacement;
+  size_t replacementSize;
+};
+
+/**
+ * Porter2 steps 2, 3 and 4 each apply the first rule in a list that matches.
+ *
+ * Trying each rule in turn means comparing a word against dozens of
+ * suffixes. A SuffixTable sorts the rules into buckets by their last two
+ * letters, keeping their order within each bucket, so find() only tries the
+ * few rules that end like the word does. makeSuffixTable() builds it at
+ * compile time.
+ *
+ * Every suffix must be at least two lowercase letters long.
+ */
+template<size_t NRules>
+struct SuffixTable {
+  static const size_t NBuckets = 26 * 26;
+
+  SuffixRule rules[NRules]; // sorted by bucket, then by original order
+  uint8_t bucketBegin[NBuckets + 1]; // bucket b's rules are [bucketBegin[b], bucketBegin[b + 1])
+
+  /**
+   * Returns the bucket for a word or suffix ending in the given two chars,
+   * or NBuckets if they aren't both lowercase letters.
+   */
+  static constexpr size_t bucket(char secondLast, char last) {
+    return (secondLast < 'a' || secondLast > 'z' || last < 'a' || last > 'z')
+      ? NBuckets
+      : (secondLast - 'a') * 26 + (last - 'a');
+  }
+
+  /**
+   * Returns the first rule, in the original order, whose suffix ends the
+   * word and starts at or after index start. Returns NULL if none does.
+   */
+  inline const SuffixRule* find(const char* word, size_t size, size_t start) const {
+    if (size < 2) return NULL;
+
+    const size_t b = bucket(word[size - 2], word[size - 1]);
+    if (b == NBuckets) return NULL;
+
+    for (size_t i = bucketBegin[b]; i < bucketBegin[b + 1]; i++) {
+      const SuffixRule& rule(rules[i]);
+      if (rule.size > size || size - rule.size < start) continue;
+      if (memcmp(word + size - rule.size, rule.suffix, rule.size - 2) == 0) return &rule; // we know the last two match
+    }
+
+    return NULL;
+  }
+};
+
+template<size_t NRules>
+const size_t SuffixTable<NRules>::NBuckets;
+
+namespace internal {
+
+constexpr size_t
+length(const char* str)
+{
+  return *str ? 1 + length(str + 1) : 0;
+}
+
+constexpr SuffixRule
+rule(const char* suffix, const char* replacement)
+{
+  return SuffixRule{ suffix, length(suffix), replacement, length(replacement) };
+}
+
+} // namespace internal
+
+/**
+ * Sorts rules into a SuffixTable: a counting sort by bucket.
+ */
+template<size_t NRules>
+constexpr SuffixTable<NRules>
+makeSuffixTable(const SuffixRule (&rules)[NRules])
+{
+  typedef SuffixTable<NRules> Table;
+
+  Table table{};
+  size_t counts[Table::NBuckets + 1] = {};
+
+  for (size_t i = 0; i < NRules; i++) {
+    const SuffixRule& rule(rules[i]);
+    if (rule.size < 2 || rule.replacementSize > rule.size) throw std::logic_error("Invalid Porter2 suffix rule");
+    const size_t b = Table::bucket(rule.suffix[rule.size - 2], rule.suffix[rule.size - 1]);
+    if (b == Table::NBuckets) throw std::logic_error("Invalid Porter2 suffix rule");
+    counts[b + 1]++;
+  }
+
+  for (size_t b = 0; b < Table::NBuckets; b++) {
+    counts[b + 1] += counts[b];
+    table.bucketBegin[b + 1] = static_cast<uint8_t>(counts[b + 1]);
+  }
+
+  for (size_t i = 0; i < NRules; i++) {
+    const SuffixRule& rule(rules[i]);
+    const size_t b = Table::bucket(rule.suffix[rule.size - 2], rule.suffix[rule.size - 1]);
+    table.rules[counts[b]++] = rule;
+  }
+
+  return table;
+}
+
+/*
+ * The rules for steps 2, 3 and 4, in the order Porter2Stemmer tries them.
+ *
+ * A few rules aren't here, because they don't fit "first match wins": step 2's
+ * "logi" and "li", step 3's "ative" (which looks in R2, not R1) and step 4's
+ * "ent", "sion" and "tion".
+ */
+
+constexpr SuffixRule Step2Rules[] = {
+  internal::rule("ational", "ate"),
+  internal::rule("tional", "tion"),
+  internal::rule("enci", "ence"),
+  internal::rule("anci", "ance"),
+  internal::rule("abli", "able"),
+  internal::rule("entli", "ent"),
+  internal::rule("izer", "ize"),
+  internal::rule("ization", "ize"),
+  internal::rule("ation", "ate"),
+  internal::rule("ator", "ate"),
+  internal::rule("alism", "al"),
+  internal::rule("aliti", "al"),
+  internal::rule("alli", "al"),
+  internal::rule("fulness", "ful"),
+  internal::rule("ousli", "ous"),
+  internal::rule("ousness", "ous"),
+  internal::rule("iveness", "ive"),
+  internal::rule("iviti", "ive"),
+  internal::rule("biliti", "ble"),
+  internal::rule("bli", "ble"),
+  internal::rule("fulli", "ful"),
+  internal::rule("lessli", "less")
+};
+
+constexpr SuffixRule Step3Rules[] = {
+  internal::rule("ational", "ate"),
+  internal::rule("tional", "tion"),
+  internal::rule("alize", "al"),
+  internal::rule("icate", "ic"),
+  internal::rule("iciti", "ic"),
+  internal::rule("ical", "ic"),
+  internal::rule("ful", ""),
+  internal::rule("ness", "")
+};
+
+constexpr SuffixRule Step4Rules[] = {
+  internal::rule("al", ""),
+  internal::rule("ance", ""),
+  internal::rule("ence", ""),
+  internal::rule("er", ""),
+  internal::rule("ic", ""),
+  internal::rule("able", ""),
+  internal::rule("ible", ""),
+  internal::rule("ant", ""),
+  internal::rule("ement", ""),
+  internal::rule("ment", ""),
+  internal::rule("ism", ""),
+  internal::rule("ate", ""),
+  internal::rule("iti", ""),
+  internal::rule("ous", ""),
+  internal::rule("ive", ""),
+  internal::rule("ize", "")
+};
+
+constexpr auto Step2Table = makeSuffixTable(Step2Rules);
+constexpr auto Step3Table = makeSuffixTable(Step3Rules);
+constexpr auto Step4Table = makeSuffixTable(Step4Rules);
+
+} // namespace porter2
+
+} // namespace twittok
+
+#endif /* PORTER2_SUFFIX_TABLE_H */
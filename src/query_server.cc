@@ -0,0 +1,377 @@
+#include "query_server.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace twittok {
+
+const size_t QueryServer::MaxRequestSize;
+const uint64_t QueryServer::ListenId;
+const uint64_t QueryServer::WakeId;
+const size_t QueryServer::ReadChunkSize;
+const size_t QueryServer::MaxUnsentBytes;
+
+namespace {
+
+const int MaxEvents = 64; // per epoll_wait()
+
+std::runtime_error
+systemError(const std::string& what)
+{
+  return std::runtime_error(what + ": " + strerror(errno));
+}
+
+/**
+ * Deletes the file at path if it's a socket: one a dead server left behind.
+ */
+void
+unlinkSocket(const std::string& path)
+{
+  struct stat st;
+  if (lstat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) unlink(path.c_str());
+}
+
+} // namespace ""
+
+QueryServer::QueryServer(const NgramQueryEngine& engine, const char* socketPath, size_t nThreads)
+  : engine_(engine)
+  , socketPath_(socketPath)
+  , nThreads_(std::max(static_cast<size_t>(1), nThreads))
+  , listenFd_(-1)
+  , wakeFd_(-1)
+  , epollFd_(-1)
+  , stopping_(false)
+  , nextConnectionId_(WakeId + 1)
+  , workersStopping_(false)
+{
+  sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (socketPath_.size() >= sizeof(address.sun_path)) throw std::runtime_error("Socket path is too long: " + socketPath_);
+  memcpy(address.sun_path, socketPath_.data(), socketPath_.size());
+
+  listenFd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (listenFd_ == -1) throw systemError("Could not create a socket");
+
+  unlinkSocket(socketPath_);
+  if (bind(listenFd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == -1 || listen(listenFd_, SOMAXCONN) == -1) {
+    const std::runtime_error err = systemError("Could not listen on " + socketPath_);
+    closeFds();
+    throw err;
+  }
+
+  wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+  if (wakeFd_ == -1 || epollFd_ == -1) {
+    const std::runtime_error err = systemError("Could not create an epoll set");
+    closeFds();
+    unlink(socketPath_.c_str());
+    throw err;
+  }
+
+  epoll_event listenEvent;
+  listenEvent.events = EPOLLIN;
+  listenEvent.data.u64 = ListenId;
+  epoll_event wakeEvent;
+  wakeEvent.events = EPOLLIN;
+  wakeEvent.data.u64 = WakeId;
+  if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, listenFd_, &listenEvent) == -1 || epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &wakeEvent) == -1) {
+    const std::runtime_error err = systemError("Could not watch the socket");
+    closeFds();
+    unlink(socketPath_.c_str());
+    throw err;
+  }
+}
+
+QueryServer::~QueryServer()
+{
+  closeFds();
+  unlink(socketPath_.c_str());
+}
+
+void
+QueryServer::closeFds()
+{
+  for (int* fd : { &epollFd_, &wakeFd_, &listenFd_ }) {
+    if (*fd != -1) close(*fd);
+    *fd = -1;
+  }
+}
+
+void
+QueryServer::stop()
+{
+  stopping_.store(true);
+  wake();
+}
+
+void
+QueryServer::wake()
+{
+  const uint64_t one = 1;
+  const ssize_t nWritten = write(wakeFd_, &one, sizeof(one)); // only fails if the counter would overflow
+  (void) nWritten;
+}
+
+void
+QueryServer::run()
+{
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < nThreads_; i++) {
+    workers.emplace_back(&QueryServer::work, this);
+  }
+
+  std::string error;
+  epoll_event events[MaxEvents];
+  while (!stopping_.load()) {
+    const int nEvents = epoll_wait(epollFd_, events, MaxEvents, -1);
+    if (nEvents == -1) {
+      if (errno == EINTR) continue;
+      error = systemError("epoll_wait() failed").what();
+      break;
+    }
+
+    for (int i = 0; i < nEvents; i++) {
+      const uint64_t id = events[i].data.u64;
+
+      if (id == ListenId) {
+        accept();
+      } else if (id == WakeId) {
+        onJobsDone();
+      } else {
+        // An earlier event in this batch may have closed the connection
+        const auto found = connections_.find(id);
+        if (found == connections_.end()) continue;
+        Connection* connection = &found->second;
+
+        if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+          closeConnection(id); // the client can't read what we'd send
+          continue;
+        }
+
+        if (events[i].events & EPOLLIN) onReadable(id, connection);
+        if (connections_.count(id) == 0) continue;
+        if ((events[i].events & EPOLLOUT) && !flush(connection)) {
+          closeConnection(id);
+          continue;
+        }
+        update(id, connection);
+      }
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(jobsMutex_);
+    workersStopping_ = true;
+  }
+  jobsReady_.notify_all();
+  for (auto& worker : workers) worker.join();
+
+  while (!connections_.empty()) closeConnection(connections_.begin()->first);
+  jobs_.clear();
+  doneJobs_.clear();
+  workersStopping_ = false;
+  stopping_.store(false);
+
+  if (!error.empty()) throw std::runtime_error(error);
+}
+
+void
+QueryServer::work()
+{
+  NgramQueryEngine::Context context;
+  Job job;
+
+  std::unique_lock<std::mutex> lock(jobsMutex_);
+  while (true) {
+    jobsReady_.wait(lock, [this]() { return workersStopping_ || !jobs_.empty(); });
+    if (workersStopping_) return;
+
+    job = std::move(jobs_.front());
+    jobs_.pop_front();
+    lock.unlock();
+
+    engine_.answer(meta::util::string_view(job.request.data(), job.request.size()), &context, &job.response);
+
+    lock.lock();
+    doneJobs_.push_back(std::move(job));
+    if (doneJobs_.size() == 1) wake(); // the loop takes every done job when it wakes
+  }
+}
+
+void
+QueryServer::accept()
+{
+  // Take every pending connection. On failure -- EAGAIN, or a client that
+  // gave up -- we'll try again when epoll says there's another.
+  while (true) {
+    const int fd = accept4(listenFd_, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd == -1) return;
+
+    const uint64_t id = nextConnectionId_++;
+    epoll_event event;
+    event.events = EPOLLIN;
+    event.data.u64 = id;
+    if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event) == -1) {
+      close(fd);
+      continue;
+    }
+
+    Connection& connection(connections_[id]);
+    connection.fd = fd;
+    connection.events = EPOLLIN;
+    connection.busy = false;
+    connection.eof = false;
+    connection.outBegin = 0;
+  }
+}
+
+void
+QueryServer::onReadable(uint64_t id, Connection* connection)
+{
+  // Stop once we hold a whole request of the biggest size: update() stops
+  // watching for input until a worker has taken it.
+  while (connection->in.size() < sizeof(uint32_t) + MaxRequestSize) {
+    const size_t size = connection->in.size();
+    connection->in.resize(size + ReadChunkSize);
+    const ssize_t nRead = read(connection->fd, &connection->in[size], ReadChunkSize);
+    connection->in.resize(size + std::max(nRead, static_cast<ssize_t>(0)));
+
+    if (nRead > 0) continue;
+    if (nRead == 0) {
+      connection->eof = true;
+      return;
+    }
+    if (errno == EINTR) continue;
+    if (errno != EAGAIN && errno != EWOULDBLOCK) closeConnection(id);
+    return;
+  }
+}
+
+void
+QueryServer::onJobsDone()
+{
+  uint64_t count;
+  const ssize_t nRead = read(wakeFd_, &count, sizeof(count)); // resets the eventfd
+  (void) nRead;
+
+  std::vector<Job> done;
+  {
+    std::lock_guard<std::mutex> lock(jobsMutex_);
+    done.swap(doneJobs_);
+  }
+
+  for (Job& job : done) {
+    const auto found = connections_.find(job.connectionId);
+    if (found == connections_.end()) continue; // the client hung up
+    Connection* connection = &found->second;
+
+    const uint32_t size = static_cast<uint32_t>(job.response.size());
+    connection->out.append(reinterpret_cast<const char*>(&size), sizeof(size));
+    connection->out.append(job.response);
+    connection->busy = false;
+
+    if (!flush(connection)) {
+      closeConnection(job.connectionId);
+      continue;
+    }
+    update(job.connectionId, connection);
+  }
+}
+
+void
+QueryServer::update(uint64_t id, Connection* connection)
+{
+  const size_t nUnsent = connection->out.size() - connection->outBegin;
+
+  // Hand a worker the next request, unless the client isn't reading
+  if (!connection->busy && nUnsent <= MaxUnsentBytes && connection->in.size() >= sizeof(uint32_t)) {
+    uint32_t size;
+    memcpy(&size, connection->in.data(), sizeof(size));
+    if (size > MaxRequestSize) {
+      closeConnection(id);
+      return;
+    }
+
+    if (connection->in.size() >= sizeof(size) + size) {
+      Job job;
+      job.connectionId = id;
+      job.request.assign(connection->in, sizeof(size), size);
+      connection->in.erase(0, sizeof(size) + size);
+      connection->busy = true;
+
+      {
+        std::lock_guard<std::mutex> lock(jobsMutex_);
+        jobs_.push_back(std::move(job));
+      }
+      jobsReady_.notify_one();
+    }
+  }
+
+  // After EOF, a partial request will never be whole
+  if (connection->eof && !connection->busy && nUnsent == 0) {
+    closeConnection(id);
+    return;
+  }
+
+  uint32_t events = 0;
+  if (!connection->eof && connection->in.size() < sizeof(uint32_t) + MaxRequestSize) events |= EPOLLIN;
+  if (nUnsent > 0) events |= EPOLLOUT;
+
+  if (events != connection->events) {
+    epoll_event event;
+    event.events = events;
+    event.data.u64 = id;
+    if (epoll_ctl(epollFd_, EPOLL_CTL_MOD, connection->fd, &event) == -1) {
+      closeConnection(id);
+      return;
+    }
+    connection->events = events;
+  }
+}
+
+bool
+QueryServer::flush(Connection* connection)
+{
+  while (connection->outBegin < connection->out.size()) {
+    const ssize_t nWritten = send(
+      connection->fd,
+      connection->out.data() + connection->outBegin,
+      connection->out.size() - connection->outBegin,
+      MSG_NOSIGNAL // a client that hung up is an error, not a SIGPIPE
+    );
+    if (nWritten >= 0) {
+      connection->outBegin += nWritten;
+    } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      break;
+    } else if (errno != EINTR) {
+      return false;
+    }
+  }
+
+  if (connection->outBegin == connection->out.size()) {
+    connection->out.clear();
+    connection->outBegin = 0;
+  }
+  return true;
+}
+
+void
+QueryServer::closeConnection(uint64_t id)
+{
+  const auto found = connections_.find(id);
+  if (found == connections_.end()) return;
+
+  close(found->second.fd); // which takes it out of the epoll set
+  connections_.erase(found);
+}
+
+} // namespace twittok
@@ -0,0 +1,123 @@
+#ifndef QUERY_SERVER_H
+#define QUERY_SERVER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "ngram_query.h"
+
+namespace twittok {
+
+/**
+ * Answers NgramQueryEngine requests on a Unix domain socket.
+ *
+ * Every message, in either direction, is a uint32_t byte count and then
+ * that many bytes. The count is in host byte order, like our results files:
+ * client and server share a host. A client may send request after request
+ * without waiting; responses come back in the same order.
+ *
+ * One thread -- the one that calls run() -- runs an epoll loop. It accepts
+ * connections, reads requests and writes responses, and never blocks on a
+ * client. Worker threads, each with its own NgramQueryEngine::Context,
+ * answer the requests. Each connection has at most one request with the
+ * workers at a time, which keeps its responses in order; requests on
+ * different connections run in parallel. A worker hands its response back
+ * through an eventfd that's in the loop's epoll set.
+ */
+class QueryServer {
+public:
+  static const size_t MaxRequestSize = 16 * 1024 * 1024; // bigger, and we hang up
+
+  /**
+   * Listens on socketPath, replacing any socket that's there. The engine must
+   * outlive us. Throws std::runtime_error if we can't listen.
+   */
+  QueryServer(const NgramQueryEngine& engine, const char* socketPath, size_t nThreads);
+  ~QueryServer();
+
+  QueryServer(const QueryServer&) = delete;
+  QueryServer& operator=(const QueryServer&) = delete;
+
+  /**
+   * Serves until stop().
+   */
+  void run();
+
+  /**
+   * Makes run() return. Safe to call from any thread, or a signal handler.
+   */
+  void stop();
+
+private:
+  static const uint64_t ListenId = 0; // epoll data for the listening socket
+  static const uint64_t WakeId = 1; // ... for the eventfd
+  static const size_t ReadChunkSize = 64 * 1024;
+  static const size_t MaxUnsentBytes = 4 * 1024 * 1024; // more, and we stop answering until the client reads
+
+  struct Connection {
+    int fd;
+    uint32_t events; // what we've asked epoll for
+    bool busy; // a worker has our request
+    bool eof; // the client won't send more, but may want its responses
+    std::string in; // bytes we've read and not yet handed to a worker
+    std::string out; // bytes we haven't written yet, from outBegin
+    size_t outBegin;
+  };
+
+  struct Job {
+    uint64_t connectionId;
+    std::string request;
+    std::string response;
+  };
+
+  void work();
+  void wake();
+  void closeFds();
+
+  void accept();
+  void onReadable(uint64_t id, Connection* connection);
+  void onJobsDone();
+  void closeConnection(uint64_t id);
+
+  /**
+   * Hands the connection's next request to a worker if it can, then closes
+   * the connection if it's done or tells epoll what it's waiting for.
+   */
+  void update(uint64_t id, Connection* connection);
+
+  /**
+   * Writes what the socket will take. Returns false if the client is gone.
+   */
+  bool flush(Connection* connection);
+
+  const NgramQueryEngine& engine_;
+  std::string socketPath_;
+  size_t nThreads_;
+  int listenFd_;
+  int wakeFd_;
+  int epollFd_;
+  std::atomic<bool> stopping_;
+
+  // The loop's own
+  uint64_t nextConnectionId_;
+  std::unordered_map<uint64_t, Connection> connections_;
+
+  // Shared with the workers
+  std::mutex jobsMutex_;
+  std::condition_variable jobsReady_;
+  std::deque<Job> jobs_; // to answer
+  std::vector<Job> doneJobs_; // answered, for the loop to send
+  bool workersStopping_;
+};
+
+} // namespace twittok
+
+#endif /* QUERY_SERVER_H */
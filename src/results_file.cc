@@ -0,0 +1,257 @@
+#include "results_file.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace twittok {
+
+namespace {
+
+const char Magic[8] = { 't', 'w', 'i', 't', 't', 'o', 'k', '\x02' };
+
+template<typename T>
+void
+writeColumn(std::ostream& os, const std::vector<T>& column)
+{
+  os.write(reinterpret_cast<const char*>(column.data()), column.size() * sizeof(T));
+}
+
+const size_t ReadChunkSize = 1024 * 1024; // bytes we allocate before we know they're there
+
+/**
+ * Returns how many bytes are left in is, or UINT64_MAX if it can't seek.
+ */
+uint64_t
+remainingBytes(std::istream& is)
+{
+  const std::istream::pos_type position = is.tellg();
+  if (position == std::istream::pos_type(-1)) return UINT64_MAX;
+
+  is.seekg(0, std::istream::end);
+  const std::istream::pos_type end = is.tellg();
+  is.seekg(position);
+  if (end == std::istream::pos_type(-1) || !is) {
+    is.clear();
+    is.seekg(position);
+    return UINT64_MAX;
+  }
+  return static_cast<uint64_t>(end - position);
+}
+
+/**
+ * Reads size values, of the *remaining bytes in is.
+ *
+ * Sizes come from the file, so we check them before we allocate: against
+ * *remaining, and -- when we can't tell how long the stream is -- by growing
+ * the column a chunk at a time, so a bogus size runs into EOF first.
+ */
+template<typename T>
+void
+readColumn(std::istream& is, uint64_t size, uint64_t* remaining, std::vector<T>* column)
+{
+  if (size > *remaining / sizeof(T)) throw std::runtime_error("Truncated results block");
+  *remaining -= size * sizeof(T);
+
+  column->clear();
+  while (column->size() < size) {
+    const size_t begin = column->size();
+    const size_t chunk = std::min(static_cast<uint64_t>(ReadChunkSize / sizeof(T)), size - begin);
+    column->resize(begin + chunk);
+    is.read(reinterpret_cast<char*>(column->data() + begin), chunk * sizeof(T));
+    if (static_cast<size_t>(is.gcount()) != chunk * sizeof(T)) throw std::runtime_error("Truncated results block");
+  }
+}
+
+/**
+ * Throws unless offsets start at 0, never decrease and end at end.
+ */
+void
+checkOffsets(const std::vector<uint64_t>& offsets, uint64_t end)
+{
+  if (offsets.front() != 0 || offsets.back() != end) throw std::runtime_error("Invalid offsets in results block");
+  for (size_t i = 1; i < offsets.size(); i++) {
+    if (offsets[i] < offsets[i - 1]) throw std::runtime_error("Invalid offsets in results block");
+  }
+}
+
+template<typename T>
+void
+appendColumn(std::vector<T>* column, const std::vector<T>& rhs)
+{
+  column->insert(column->end(), rhs.begin(), rhs.end());
+}
+
+/**
+ * Appends rhs's offsets (which start at 0) to ours, starting at our end.
+ */
+void
+appendOffsets(std::vector<uint64_t>* offsets, const std::vector<uint64_t>& rhs)
+{
+  const uint64_t base = offsets->back();
+  for (size_t i = 1; i < rhs.size(); i++) {
+    offsets->push_back(base + rhs[i]);
+  }
+}
+
+} // namespace ""
+
+void
+ResultsBlock::addRecord(const NgramInfo& info, const char* key, size_t keySize)
+{
+  n.push_back(info.nTotal());
+  nClinton.push_back(info.nClinton);
+  nTrump.push_back(info.nTrump);
+  nBoth.push_back(info.nBoth);
+  nVariants.push_back(info.nVariants());
+  keys.insert(keys.end(), key, key + keySize);
+  keyBegin.push_back(keys.size());
+  spellingBegin.push_back(spellingBegin.back());
+}
+
+void
+ResultsBlock::addSpelling(const char* data, size_t size, uint64_t spellingCount)
+{
+  spellingN.push_back(spellingCount);
+  strings.insert(strings.end(), data, data + size);
+  stringBegin.push_back(strings.size());
+  spellingBegin.back()++;
+}
+
+void
+ResultsBlock::append(const ResultsBlock& rhs)
+{
+  appendColumn(&n, rhs.n);
+  appendColumn(&nClinton, rhs.nClinton);
+  appendColumn(&nTrump, rhs.nTrump);
+  appendColumn(&nBoth, rhs.nBoth);
+  appendColumn(&nVariants, rhs.nVariants);
+  appendOffsets(&keyBegin, rhs.keyBegin);
+  appendOffsets(&spellingBegin, rhs.spellingBegin);
+  appendColumn(&spellingN, rhs.spellingN);
+  appendOffsets(&stringBegin, rhs.stringBegin);
+  appendColumn(&keys, rhs.keys);
+  appendColumn(&strings, rhs.strings);
+}
+
+void
+ResultsBlock::writeText(std::ostream& os) const
+{
+  for (size_t i = 0; i < size(); i++) {
+    bool wroteHeader = false;
+
+    for (uint64_t j = spellingBegin[i]; j < spellingBegin[i + 1]; j++) {
+      const char* spelling = strings.data() + stringBegin[j];
+      const size_t spellingSize = stringBegin[j + 1] - stringBegin[j];
+
+      // Completely ignore anything with a special character that breaks
+      // output. These stay in "nVariants" because we do _count_ each
+      // occurrence as an alternate spelling. We just won't output all of them.
+      if (memchr(spelling, '\n', spellingSize) || memchr(spelling, '\t', spellingSize)) continue;
+
+      if (!wroteHeader) {
+        os << nClinton[i] << "\t" << nTrump[i] << "\t" << nBoth[i] << "\t" << nVariants[i] << "\n";
+        wroteHeader = true;
+      }
+      os.write(spelling, spellingSize) << "\n";
+    }
+  }
+}
+
+void
+ResultsBlock::write(std::ostream& os) const
+{
+  const uint64_t header[5] = { ngramSize, size(), nSpellings(), keys.size(), strings.size() };
+  os.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+  writeColumn(os, n);
+  writeColumn(os, nClinton);
+  writeColumn(os, nTrump);
+  writeColumn(os, nBoth);
+  writeColumn(os, nVariants);
+  writeColumn(os, keyBegin);
+  writeColumn(os, spellingBegin);
+  writeColumn(os, spellingN);
+  writeColumn(os, stringBegin);
+  writeColumn(os, keys);
+  writeColumn(os, strings);
+}
+
+bool
+ResultsBlock::read(std::istream& is)
+{
+  uint64_t header[5];
+  is.read(reinterpret_cast<char*>(header), sizeof(header));
+  if (is.gcount() == 0 && is.eof()) return false;
+  if (static_cast<size_t>(is.gcount()) != sizeof(header)) throw std::runtime_error("Truncated results block");
+
+  ngramSize = header[0];
+  const uint64_t nRecords = header[1];
+  const uint64_t nSpellings = header[2];
+  const uint64_t nKeyBytes = header[3];
+  const uint64_t nStringBytes = header[4];
+
+  // The offset columns hold one more than their count: if that overflows,
+  // readColumn() would take UINT64_MAX + 1 == 0 values and carry on.
+  if (nRecords == UINT64_MAX || nSpellings == UINT64_MAX) throw std::runtime_error("Truncated results block");
+
+  uint64_t remaining = remainingBytes(is);
+  readColumn(is, nRecords, &remaining, &n);
+  readColumn(is, nRecords, &remaining, &nClinton);
+  readColumn(is, nRecords, &remaining, &nTrump);
+  readColumn(is, nRecords, &remaining, &nBoth);
+  readColumn(is, nRecords, &remaining, &nVariants);
+  readColumn(is, nRecords + 1, &remaining, &keyBegin);
+  readColumn(is, nRecords + 1, &remaining, &spellingBegin);
+  readColumn(is, nSpellings, &remaining, &spellingN);
+  readColumn(is, nSpellings + 1, &remaining, &stringBegin);
+  readColumn(is, nKeyBytes, &remaining, &keys);
+  readColumn(is, nStringBytes, &remaining, &strings);
+
+  checkOffsets(keyBegin, nKeyBytes);
+  checkOffsets(spellingBegin, nSpellings);
+  checkOffsets(stringBegin, nStringBytes);
+
+  return true;
+}
+
+void
+writeBinaryResultsHeader(std::ostream& os, const BioCounts& counts)
+{
+  const uint64_t header[6] = {
+    counts.nClinton,
+    counts.nTrump,
+    counts.nBoth,
+    counts.nClintonWithBio,
+    counts.nTrumpWithBio,
+    counts.nBothWithBio
+  };
+
+  os.write(Magic, sizeof(Magic));
+  os.write(reinterpret_cast<const char*>(header), sizeof(header));
+}
+
+BioCounts
+readBinaryResultsHeader(std::istream& is)
+{
+  char magic[sizeof(Magic)];
+  is.read(magic, sizeof(magic));
+  if (static_cast<size_t>(is.gcount()) != sizeof(magic) || memcmp(magic, Magic, sizeof(Magic)) != 0) {
+    throw std::runtime_error("Not a binary twittok results file");
+  }
+
+  uint64_t header[6];
+  is.read(reinterpret_cast<char*>(header), sizeof(header));
+  if (static_cast<size_t>(is.gcount()) != sizeof(header)) throw std::runtime_error("Truncated results header");
+
+  BioCounts counts;
+  counts.nClinton = header[0];
+  counts.nTrump = header[1];
+  counts.nBoth = header[2];
+  counts.nClintonWithBio = header[3];
+  counts.nTrumpWithBio = header[4];
+  counts.nBothWithBio = header[5];
+  return counts;
+}
+
+} // namespace twittok
@@ -0,0 +1,132 @@
+#ifndef RESULTS_FILE_H
+#define RESULTS_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+#include "bio_counts.h"
+#include "ngram_info.h"
+
+namespace twittok {
+
+/**
+ * How we write our output file.
+ *
+ * Text is what we've always written: BioCounts::dump()'s header, then each
+ * ngram's counts and spellings, one per line. It's slow to write and slow to
+ * parse, and it can't hold spellings with newlines or tabs.
+ *
+ * A binary results file holds the same things, column by column:
+ *
+ *   "twittok\x02": 8 bytes of magic, including a version
+ *   nClinton, nTrump, nBoth, nClintonWithBio, nTrumpWithBio, nBothWithBio
+ *   Blocks, one per NgramPass::dump(), until EOF
+ *
+ * A block is a ResultsBlock:
+ *
+ *   ngramSize, nRecords, nSpellings, nKeyBytes, nStringBytes
+ *   n[nRecords], nClinton[nRecords], nTrump[nRecords], nBoth[nRecords]
+ *   nVariants[nRecords]
+ *   keyBegin[nRecords + 1]: record i's key is keys[keyBegin[i], keyBegin[i + 1])
+ *   spellingBegin[nRecords + 1]: record i's spellings are
+ *     [spellingBegin[i], spellingBegin[i + 1])
+ *   spellingN[nSpellings]: how often each spelling's variant occurs
+ *   stringBegin[nSpellings + 1]: spelling j is
+ *     strings[stringBegin[j], stringBegin[j + 1])
+ *   keys[nKeyBytes]: each record's stems, separated by spaces
+ *   strings[nStringBytes]
+ *
+ * Every number is a uint64_t in host byte order. twittok-to-text converts a
+ * binary file to text, byte for byte what twittok would have written.
+ */
+enum class ResultsFormat {
+  Text,
+  Binary
+};
+
+/**
+ * One NgramPass::dump()'s output, in binary.
+ *
+ * Records are ngrams, in dump() order. Each has its key -- its stems,
+ * separated by spaces, as NgramIndex looks them up -- and the spellings
+ * dump() writes: one per variant, most common first, including the ones with
+ * newlines or tabs, which the text format leaves out.
+ */
+struct ResultsBlock {
+  uint64_t ngramSize; // N
+
+  std::vector<uint64_t> n;
+  std::vector<uint64_t> nClinton;
+  std::vector<uint64_t> nTrump;
+  std::vector<uint64_t> nBoth;
+  std::vector<uint64_t> nVariants; // distinct spellings we counted, written or not
+  std::vector<uint64_t> keyBegin; // starts {0}
+  std::vector<uint64_t> spellingBegin; // starts {0}
+
+  std::vector<uint64_t> spellingN;
+  std::vector<uint64_t> stringBegin; // starts {0}
+
+  std::vector<char> keys;
+  std::vector<char> strings;
+
+  explicit ResultsBlock(uint64_t ngramSize = 0) : ngramSize(ngramSize), keyBegin(1, 0), spellingBegin(1, 0), stringBegin(1, 0) {}
+
+  inline size_t size() const { return n.size(); }
+  inline size_t nSpellings() const { return spellingN.size(); }
+
+  /**
+   * Starts a record for info, whose stems (separated by spaces) are key.
+   * Call addSpelling() for each of its spellings.
+   */
+  void addRecord(const NgramInfo& info, const char* key, size_t keySize);
+
+  /**
+   * Adds a spelling to the last record.
+   */
+  void addSpelling(const char* data, size_t size, uint64_t spellingCount);
+
+  /**
+   * Appends rhs's records to ours.
+   */
+  void append(const ResultsBlock& rhs);
+
+  /**
+   * Writes the text NgramPass::dump() writes for these records.
+   *
+   * Spellings with a newline or tab are left out, and so is any record with
+   * nothing left to write.
+   */
+  void writeText(std::ostream& os) const;
+
+  /**
+   * Writes the block, one column at a time.
+   */
+  void write(std::ostream& os) const;
+
+  /**
+   * Reads a block that write() wrote, replacing our contents.
+   *
+   * Returns false at EOF. Throws std::runtime_error if the block is
+   * truncated or inconsistent, including when its header claims more than
+   * the stream holds: we check before we allocate.
+   */
+  bool read(std::istream& is);
+};
+
+/**
+ * Writes the start of a binary results file: magic and counts.
+ */
+void writeBinaryResultsHeader(std::ostream& os, const BioCounts& counts);
+
+/**
+ * Reads what writeBinaryResultsHeader() wrote. Throws std::runtime_error if
+ * this isn't a binary results file.
+ */
+BioCounts readBinaryResultsHeader(std::istream& is);
+
+} // namespace twittok
+
+#endif /* RESULTS_FILE_H */
@@ -0,0 +1,51 @@
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include "results_file.h"
+
+/**
+ * Converts a binary results file (twittok --format=binary) to the text
+ * twittok writes by default.
+ *
+ * Usage: twittok-to-text RESULTS.bin OUT-TOKENS.txt
+ */
+int
+main(int argc, char** argv)
+{
+  if (argc != 3) {
+    std::cerr << "Usage: " << argv[0] << " RESULTS.bin OUT-TOKENS.txt" << std::endl;
+    return 1;
+  }
+
+  std::ifstream in(argv[1], std::ifstream::in | std::ifstream::binary);
+  if (!in) {
+    std::cerr << "Could not open " << argv[1] << std::endl;
+    return 1;
+  }
+
+  std::vector<char> outBuffer(1024 * 1024); // so we write in big pieces
+  std::ofstream out;
+  out.rdbuf()->pubsetbuf(outBuffer.data(), outBuffer.size());
+  out.open(argv[2], std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+  if (!out) {
+    std::cerr << "Could not open " << argv[2] << std::endl;
+    return 1;
+  }
+
+  try {
+    twittok::readBinaryResultsHeader(in).dump(out);
+
+    // One block at a time: we never hold more than one pass's results
+    twittok::ResultsBlock block;
+    while (block.read(in)) {
+      block.writeText(out);
+    }
+  } catch (const std::exception& err) { // runtime_error for a bad file, or bad_alloc
+    std::cerr << argv[1] << ": " << err.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
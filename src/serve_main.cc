@@ -0,0 +1,98 @@
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "casefold.h"
+#include "ngram_index.h"
+#include "ngram_query.h"
+#include "query_server.h"
+
+namespace {
+
+twittok::QueryServer* server = NULL; // for the signal handler
+
+void
+onSignal(int)
+{
+  if (server) server->stop();
+}
+
+void
+usage(const char* program)
+{
+  std::cerr << "Usage: " << program << " [--threads=N] INDEX SOCKET" << std::endl;
+  exit(1);
+}
+
+} // namespace ""
+
+/**
+ * Answers lookups in an index (from twittok-index) on a Unix domain socket,
+ * until SIGINT or SIGTERM. See QueryServer for the protocol and
+ * NgramQueryEngine for the requests.
+ *
+ * Usage: twittok-serve [--threads=N] INDEX SOCKET
+ */
+int
+main(int argc, char** argv)
+{
+  size_t nThreads = std::thread::hardware_concurrency();
+  std::vector<const char*> args;
+
+  for (int i = 1; i < argc; i++) {
+    const std::string arg(argv[i]);
+    if (arg.compare(0, 10, "--threads=") == 0) {
+      nThreads = strtoul(arg.c_str() + 10, NULL, 10);
+      if (nThreads == 0) usage(argv[0]);
+    } else if (arg.compare(0, 2, "--") == 0) {
+      usage(argv[0]);
+    } else {
+      args.push_back(argv[i]);
+    }
+  }
+
+  if (args.size() != 2) usage(argv[0]);
+  const char* indexFilename = args[0];
+  const char* socketPath = args[1];
+
+  // Fail now if ICU is broken, not in a worker thread
+  twittok::casefold_init();
+
+  std::unique_ptr<twittok::NgramIndex> index;
+  std::unique_ptr<twittok::QueryServer> queryServer;
+  try {
+    index.reset(new twittok::NgramIndex(indexFilename));
+  } catch (const std::runtime_error& err) {
+    std::cerr << indexFilename << ": " << err.what() << std::endl;
+    return 1;
+  } catch (const char* err) { // MappedFile's
+    std::cerr << indexFilename << ": " << err << std::endl;
+    return 1;
+  }
+
+  const twittok::NgramQueryEngine engine(*index);
+
+  try {
+    queryServer.reset(new twittok::QueryServer(engine, socketPath, nThreads));
+  } catch (const std::runtime_error& err) {
+    std::cerr << err.what() << std::endl;
+    return 1;
+  }
+
+  server = queryServer.get();
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+
+  std::cerr << "Serving " << index->size() << " ngrams on " << socketPath << " with " << nThreads << " threads" << std::endl;
+  queryServer->run();
+  std::cerr << "Stopped" << std::endl;
+
+  server = NULL;
+  return 0;
+}
@@ -0,0 +1,79 @@
+#include "stem_cache.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "stemmer.h"
+
+namespace twittok {
+
+const size_t StemCache::DefaultMaxEntries;
+const size_t StemCache::NShards;
+const TokenId StemCache::NoStem;
+
+bool
+StemCache::Key::operator<(const Key& rhs) const
+{
+  const int cmp = memcmp(token.data(), rhs.token.data(), std::min(token.size(), rhs.token.size()));
+  return cmp < 0 || (cmp == 0 && token.size() < rhs.token.size());
+}
+
+StemCache::StemCache(Vocabulary& vocabulary, size_t maxEntries)
+  : vocabulary_(vocabulary)
+  , maxEntriesPerShard_((maxEntries + NShards - 1) / NShards)
+  , nHits_(0)
+  , nMisses_(0)
+{
+}
+
+bool
+StemCache::stem(const char* utf8, size_t len, TokenId* id)
+{
+  const Key key{ StringRef(utf8, len) };
+
+  // FlatHashMap picks slots with the hash's low bits, so we use high ones.
+  Shard& shard(shards_[(static_cast<uint64_t>(key.token.hash()) >> 32) % NShards]);
+
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    const TokenId* found = shard.ids.find(key);
+    if (found) {
+      nHits_.fetch_add(1, std::memory_order_relaxed);
+      if (*found == NoStem) return false;
+      *id = *found;
+      return true;
+    }
+  }
+
+  // Stem without the lock: it's the slow part. Two threads may both stem the
+  // same token; they'll agree.
+  nMisses_.fetch_add(1, std::memory_order_relaxed);
+  const std::string stemmed = stemmer::stem(utf8, len);
+  const TokenId ret = stemmed.empty() ? NoStem : vocabulary_.intern(stemmed);
+
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.ids.size() < maxEntriesPerShard_ && !shard.ids.contains(key)) {
+      shard.tokens.emplace_back(utf8, len);
+      const std::string& token(shard.tokens.back());
+      shard.ids[Key{ StringRef(token.data(), token.size()) }] = ret;
+    }
+  }
+
+  if (ret == NoStem) return false;
+  *id = ret;
+  return true;
+}
+
+size_t
+StemCache::size() const
+{
+  size_t ret = 0;
+  for (size_t i = 0; i < NShards; i++) {
+    std::lock_guard<std::mutex> lock(shards_[i].mutex);
+    ret += shards_[i].ids.size();
+  }
+  return ret;
+}
+
+} // namespace twittok
@@ -0,0 +1,101 @@
+#ifndef STEM_CACHE_H
+#define STEM_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+
+#include "flat_hash_map.h"
+#include "string_ref.h"
+#include "vocabulary.h"
+
+namespace twittok {
+
+/**
+ * Remembers what stemmer::stem() made of each raw token, as a TokenId.
+ *
+ * Stemming costs an ICU call and a Porter2 run, and bios are very Zipfian:
+ * "love", "mom" and "#MAGA" appear millions of times each. With this cache in
+ * front, we stem each distinct token (byte for byte, before case-folding)
+ * roughly once, and intern its stem once.
+ *
+ * stem() is safe to call from any number of threads at once. Like
+ * Vocabulary, we shard by hash, with a mutex per shard.
+ *
+ * The cache holds at most maxEntries tokens. Once a shard is full we stop
+ * adding to it, rather than evicting: the tokens we see first are mostly the
+ * common ones, and the rare ones we'd evict them for are rarely seen again.
+ */
+class StemCache {
+public:
+  static const size_t DefaultMaxEntries = 4 * 1024 * 1024;
+
+  /**
+   * Creates an empty cache. The Vocabulary must outlive it.
+   */
+  StemCache(Vocabulary& vocabulary, size_t maxEntries = DefaultMaxEntries);
+
+  StemCache(const StemCache&) = delete;
+  StemCache& operator=(const StemCache&) = delete;
+
+  /**
+   * Stems the token and sets *id to its stem's id, as
+   * vocabulary().intern(stemmer::stem(utf8, len)) would.
+   *
+   * Returns false (and leaves *id alone) if stemmer::stem() returns the empty
+   * string: that is, if the token should be skipped.
+   */
+  bool stem(const char* utf8, size_t len, TokenId* id);
+
+  inline const Vocabulary& vocabulary() const { return vocabulary_; }
+  inline Vocabulary& vocabulary() { return vocabulary_; }
+
+  /**
+   * Returns the number of stem() calls that found their token in the cache.
+   */
+  inline size_t nHits() const { return nHits_.load(std::memory_order_relaxed); }
+
+  /**
+   * Returns the number of stem() calls that had to call stemmer::stem().
+   */
+  inline size_t nMisses() const { return nMisses_.load(std::memory_order_relaxed); }
+
+  /**
+   * Returns the number of distinct tokens in the cache.
+   */
+  size_t size() const;
+
+private:
+  static const size_t NShards = 64;
+  static const TokenId NoStem = static_cast<TokenId>(-1); // stemmer::stem() returned ""
+
+  struct Key {
+    StringRef token; // points into Shard::tokens
+
+    inline bool operator==(const Key& rhs) const { return token == rhs.token; }
+    bool operator<(const Key& rhs) const; // only called on hash collisions
+  };
+
+  struct KeyHash {
+    inline size_t operator()(const Key& key) const { return key.token.hash(); }
+  };
+
+  struct Shard {
+    mutable std::mutex mutex;
+    FlatHashMap<Key, TokenId, KeyHash> ids;
+    std::deque<std::string> tokens; // never moves its strings, so Keys stay valid
+  };
+
+  Vocabulary& vocabulary_;
+  size_t maxEntriesPerShard_;
+  Shard shards_[NShards];
+  std::atomic<size_t> nHits_;
+  std::atomic<size_t> nMisses_;
+};
+
+} // namespace twittok
+
+#endif /* STEM_CACHE_H */
@@ -7,7 +7,7 @@
 #include <unicode/utf8.h>
 
 #include "casefold.h"
-#include "porter2_stemmer.h"
+#include "porter2_buffer_stemmer.h"
 
 namespace {
 bool is_too_long(size_t len)
@@ -107,7 +107,8 @@ stem(const char* utf8, size_t len)
     return std::string();
 	}
 
-  std::string normalized = twittok::casefold_and_normalize(std::string(utf8, len));
+  std::string normalized;
+  twittok::casefold_and_normalize(utf8, len, &normalized);
 
 	// stem, pass-through, or return empty string
 	switch (calculate_normalized_token_type(normalized)) {
@@ -117,8 +118,10 @@ stem(const char* utf8, size_t len)
 		case Other:
       return normalized;
 		case AsciiLetters:
-      Porter2Stemmer::stem(normalized); // ick! edits in-place
-      return normalized;
+      {
+        twittok::porter2::Buffer buffer;
+        return twittok::porter2::stem(normalized.data(), normalized.size(), &buffer).to_string();
+      }
     default:
       assert(false);
 	}
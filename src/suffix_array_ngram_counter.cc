@@ -0,0 +1,263 @@
+#include "suffix_array_ngram_counter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "ngram_pass.h"
+
+namespace twittok {
+
+const size_t SuffixArrayNgramCounter::MaxN;
+
+SuffixArrayNgramCounter::SuffixArrayNgramCounter(const BioStore& bios, size_t minCount)
+  : bios_(bios)
+  , minCount_(minCount)
+{
+}
+
+/**
+ * Returns how many tokens of the suffix we consider: up to MaxN, and never
+ * past the end of its bio.
+ */
+inline size_t
+SuffixArrayNgramCounter::length(const Suffix& suffix) const
+{
+  return std::min(MaxN, static_cast<size_t>(bios_.tokenEnd(suffix.bio) - suffix.token));
+}
+
+void
+SuffixArrayNgramCounter::count(size_t nThreads)
+{
+  static const uint64_t Skipped = std::numeric_limits<uint64_t>::max();
+
+  const TokenId* tokenIds = bios_.tokenIds();
+
+  if (bios_.nTokens() > std::numeric_limits<uint32_t>::max() || bios_.size() > std::numeric_limits<uint32_t>::max()) {
+    throw std::length_error("Too many tokens for a suffix array");
+  }
+
+  // 1. Bucket every position by its first token. Skip infrequent tokens: no
+  // ngram that starts with one can be frequent. (A token's count is at most
+  // the followers whose bios contain it.)
+  std::vector<uint64_t> cursors(bios_.vocabulary().size(), 0);
+  for (uint64_t i = 0; i < bios_.nTokens(); i++) cursors[tokenIds[i]]++;
+
+  std::vector<uint64_t> weights; // if bios_.weighted(), followers per token
+  if (bios_.weighted()) {
+    weights.resize(cursors.size(), 0);
+    for (size_t bio = 0; bio < bios_.size(); bio++) {
+      const uint32_t n = bios_.weight(bio).n;
+      for (uint64_t token = bios_.tokenBegin(bio); token < bios_.tokenEnd(bio); token++) weights[tokenIds[token]] += n;
+    }
+  }
+
+  std::vector<std::pair<uint64_t, uint64_t> > buckets; // [begin, end) in suffixes
+  uint64_t nSuffixes = 0;
+  for (size_t id = 0; id < cursors.size(); id++) {
+    uint64_t& cursor(cursors[id]);
+    const uint64_t size = cursor;
+    if (size == 0 || (weights.empty() ? size : weights[id]) < minCount_) {
+      cursor = Skipped;
+    } else {
+      buckets.push_back(std::make_pair(nSuffixes, nSuffixes + size));
+      cursor = nSuffixes;
+      nSuffixes += size;
+    }
+  }
+
+  std::vector<Suffix> suffixes(nSuffixes);
+  for (size_t bio = 0; bio < bios_.size(); bio++) {
+    for (uint64_t token = bios_.tokenBegin(bio); token < bios_.tokenEnd(bio); token++) {
+      uint64_t& cursor(cursors[tokenIds[token]]);
+      if (cursor == Skipped) continue;
+      suffixes[cursor++] = { static_cast<uint32_t>(token), static_cast<uint32_t>(bio) };
+    }
+  }
+  cursors = std::vector<uint64_t>();
+  weights = std::vector<uint64_t>();
+
+  // 2. Sort and walk each bucket. Biggest first, so threads finish together.
+  std::sort(buckets.begin(), buckets.end(), [](const std::pair<uint64_t, uint64_t>& a, const std::pair<uint64_t, uint64_t>& b) {
+    return a.second - a.first > b.second - b.first;
+  });
+
+  const size_t nWorkers = std::max(static_cast<size_t>(1), std::min(nThreads, buckets.size()));
+  std::vector<Worker> workers(nWorkers);
+  std::atomic<size_t> nextBucket(0);
+
+  auto work = [&](Worker* worker) {
+    while (true) {
+      const size_t i = nextBucket.fetch_add(1);
+      if (i >= buckets.size()) return;
+      countBucket(&suffixes[buckets[i].first], &suffixes[0] + buckets[i].second, worker);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < nWorkers; i++) threads.emplace_back(work, &workers[i]);
+  work(&workers[0]);
+  for (auto& thread : threads) thread.join();
+
+  // 3. Gather. Order doesn't matter: dump() puts every ngram in a FlatHashMap.
+  for (auto& worker : workers) {
+    for (size_t n = 1; n <= MaxN; n++) {
+      found_[n].insert(found_[n].end(), std::make_move_iterator(worker.found[n].begin()), std::make_move_iterator(worker.found[n].end()));
+      worker.found[n] = std::vector<Found>();
+    }
+  }
+}
+
+/**
+ * Sorts and walks the suffixes that start with one (frequent) token.
+ */
+void
+SuffixArrayNgramCounter::countBucket(Suffix* begin, Suffix* end, Worker* worker) const
+{
+  const TokenId* tokenIds = bios_.tokenIds();
+
+  // Every suffix here has the same first token, so compare from the second.
+  // Shorter suffixes sort before longer ones that start the same way.
+  std::sort(begin, end, [this, tokenIds](const Suffix& a, const Suffix& b) {
+    const size_t aLength = length(a);
+    const size_t bLength = length(b);
+    const size_t common = std::min(aLength, bLength);
+    for (size_t i = 1; i < common; i++) {
+      const TokenId aId = tokenIds[a.token + i];
+      const TokenId bId = tokenIds[b.token + i];
+      if (aId != bId) return aId < bId;
+    }
+    if (aLength != bLength) return aLength < bLength;
+    return a.token < b.token;
+  });
+
+  const size_t size = end - begin;
+  worker->lcp.resize(size);
+  worker->lcp[0] = 0;
+  for (size_t i = 1; i < size; i++) {
+    const Suffix& a(begin[i - 1]);
+    const Suffix& b(begin[i]);
+    const size_t common = std::min(length(a), length(b));
+    size_t lcp = 1;
+    while (lcp < common && tokenIds[a.token + lcp] == tokenIds[b.token + lcp]) lcp++;
+    worker->lcp[i] = lcp;
+  }
+
+  NgramInfo info = countRange(begin, end, 1, worker);
+  if (info.nTotal() >= minCount_) {
+    worker->found[1].push_back({ begin->token, std::move(info) });
+    visit(begin, 0, size, 1, worker);
+  }
+}
+
+/**
+ * Finds the frequent (n+1)-grams within [begin, end), a range of suffixes
+ * that share a frequent n-gram, and recurses into each.
+ */
+void
+SuffixArrayNgramCounter::visit(const Suffix* suffixes, size_t begin, size_t end, size_t n, Worker* worker) const
+{
+  if (n == MaxN) return;
+
+  size_t i = begin;
+  while (i < end) {
+    // Suffixes that end here sort first; they have no (n+1)-gram.
+    if (length(suffixes[i]) <= n) {
+      i++;
+      continue;
+    }
+
+    size_t j = i + 1;
+    while (j < end && worker->lcp[j] > n) j++;
+
+    if (j - i >= minCount_ || (bios_.weighted() && weight(suffixes + i, suffixes + j) >= minCount_)) {
+      NgramInfo info = countRange(suffixes + i, suffixes + j, n + 1, worker);
+      if (info.nTotal() >= minCount_) {
+        worker->found[n + 1].push_back({ suffixes[i].token, std::move(info) });
+        visit(suffixes, i, j, n + 1, worker);
+      }
+    }
+
+    i = j;
+  }
+}
+
+/**
+ * Returns how many followers the suffixes' bios stand for, counting a bio
+ * once per suffix: an upper bound on the nTotal() of the ngram they share.
+ */
+uint64_t
+SuffixArrayNgramCounter::weight(const Suffix* begin, const Suffix* end) const
+{
+  uint64_t ret = 0;
+  for (const Suffix* suffix = begin; suffix != end; ++suffix) ret += bios_.weight(suffix->bio).n;
+  return ret;
+}
+
+/**
+ * Tallies one ngram of length n, given every suffix it starts.
+ *
+ * Like Bio::ngrams(), each bio counts once, with its first spelling.
+ */
+NgramInfo
+SuffixArrayNgramCounter::countRange(const Suffix* begin, const Suffix* end, size_t n, Worker* worker) const
+{
+  std::vector<Suffix>& scratch(worker->scratch);
+  scratch.assign(begin, end);
+  std::sort(scratch.begin(), scratch.end(), [](const Suffix& a, const Suffix& b) {
+    return a.bio < b.bio || (a.bio == b.bio && a.token < b.token);
+  });
+
+  NgramInfo info = NgramInfo();
+
+  for (size_t i = 0; i < scratch.size(); i++) {
+    const Suffix& suffix(scratch[i]);
+    if (i > 0 && scratch[i - 1].bio == suffix.bio) continue;
+
+    const BioWeight weight = bios_.weight(suffix.bio);
+    info.nClinton += weight.nClinton;
+    info.nTrump += weight.nTrump;
+    info.nBoth += weight.nBoth;
+    info.originalTexts[bios_.originalText(suffix.bio, suffix.token, n)] += weight.n;
+  }
+
+  return info;
+}
+
+template<size_t N>
+void
+SuffixArrayNgramCounter::dumpN(std::ostream& os, size_t nThreads, ResultsFormat format) const
+{
+  const TokenId* tokenIds = bios_.tokenIds();
+
+  NgramPass<N> pass((typename NgramPass<N>::PrefixSet()));
+  for (const auto& found : found_[N]) {
+    NgramKey<N> key{};
+    std::copy(tokenIds + found.token, tokenIds + found.token + N, key.begin());
+    pass.gramToInfo[key] = found.info;
+  }
+
+  pass.dump(os, bios_.vocabulary(), minCount_, nThreads, format);
+}
+
+void
+SuffixArrayNgramCounter::dump(std::ostream& os, size_t nThreads, ResultsFormat format) const
+{
+  static_assert(MaxN == 10, "dump() must call dumpN<1..MaxN>");
+
+  dumpN<1>(os, nThreads, format);
+  dumpN<2>(os, nThreads, format);
+  dumpN<3>(os, nThreads, format);
+  dumpN<4>(os, nThreads, format);
+  dumpN<5>(os, nThreads, format);
+  dumpN<6>(os, nThreads, format);
+  dumpN<7>(os, nThreads, format);
+  dumpN<8>(os, nThreads, format);
+  dumpN<9>(os, nThreads, format);
+  dumpN<10>(os, nThreads, format);
+}
+
+} // namespace twittok
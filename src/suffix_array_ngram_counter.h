@@ -0,0 +1,98 @@
+#ifndef SUFFIX_ARRAY_NGRAM_COUNTER_H
+#define SUFFIX_ARRAY_NGRAM_COUNTER_H
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "bio_store.h"
+#include "ngram_info.h"
+#include "results_file.h"
+
+namespace twittok {
+
+/**
+ * Finds every frequent ngram of length 1 through MaxN in one traversal,
+ * instead of one NgramPass per length.
+ *
+ * We build a suffix array over every bio's tokens: one entry per token
+ * position, sorted by the (at most MaxN) tokens that start there. A suffix
+ * never extends past the end of its bio. Sorted like this, the occurrences
+ * of any ngram are a contiguous range, and the occurrences of its
+ * extensions are sub-ranges of it. With the longest common prefix (LCP) of
+ * each pair of neighbors, we walk those ranges depth-first.
+ *
+ * We prune exactly like the NgramPass chain: we only sort positions whose
+ * first token is frequent, and we only descend into an ngram's range if the
+ * ngram itself is frequent. Counting is the same, too -- a bio counts once
+ * per ngram, with the spelling of its first occurrence -- so dump() writes
+ * the same file as NgramPass<1>::dump() through NgramPass<MaxN>::dump().
+ *
+ * Bios that stand for several followers (see BioWeight) count that many
+ * times, in both the counts and the pruning.
+ *
+ * The suffix array costs 8 bytes per token.
+ */
+class SuffixArrayNgramCounter {
+public:
+  static const size_t MaxN = 10;
+
+  /**
+   * Prepares to count ngrams that appear in at least minCount bios.
+   *
+   * The BioStore must outlive this counter.
+   */
+  SuffixArrayNgramCounter(const BioStore& bios, size_t minCount);
+
+  /**
+   * Builds the suffix array and finds every frequent ngram, on nThreads
+   * threads.
+   *
+   * Each first token's range is sorted and walked independently, so threads
+   * never share work.
+   */
+  void count(size_t nThreads);
+
+  /**
+   * Writes what NgramPass<1..MaxN>::dump() would, in the same order and
+   * format, formatting on nThreads threads.
+   */
+  void dump(std::ostream& os, size_t nThreads = 1, ResultsFormat format = ResultsFormat::Text) const;
+
+  /**
+   * Returns the number of frequent ngrams of length n.
+   */
+  inline size_t nFrequent(size_t n) const { return found_[n].size(); }
+
+private:
+  struct Suffix {
+    uint32_t token; // index into bios_.tokenIds()
+    uint32_t bio;
+  };
+
+  struct Found {
+    uint32_t token; // where one occurrence starts
+    NgramInfo info;
+  };
+
+  struct Worker {
+    std::vector<Found> found[MaxN + 1];
+    std::vector<uint8_t> lcp; // lcp[i] = common prefix of suffixes i-1 and i
+    std::vector<Suffix> scratch;
+  };
+
+  inline size_t length(const Suffix& suffix) const;
+  void countBucket(Suffix* begin, Suffix* end, Worker* worker) const;
+  void visit(const Suffix* suffixes, size_t begin, size_t end, size_t n, Worker* worker) const;
+  NgramInfo countRange(const Suffix* begin, const Suffix* end, size_t n, Worker* worker) const;
+  uint64_t weight(const Suffix* begin, const Suffix* end) const;
+  template<size_t N> void dumpN(std::ostream& os, size_t nThreads, ResultsFormat format) const;
+
+  const BioStore& bios_;
+  size_t minCount_;
+  std::vector<Found> found_[MaxN + 1]; // by ngram length
+};
+
+} // namespace twittok
+
+#endif /* SUFFIX_ARRAY_NGRAM_COUNTER_H */
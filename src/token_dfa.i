@@ -0,0 +1,122 @@
+// Generated by ../build-regex/generate-dfa.rb from token_regex.i
+
+static const size_t token_dfa_n_states = 84;
+static const size_t token_dfa_n_classes = 39;
+static const uint16_t token_dfa_dead = 0;
+static const uint16_t token_dfa_start = 1;
+static const uint8_t token_dfa_not_ascii = 255;
+
+// token_dfa_byte_classes[byte]: byte's column in token_dfa_transitions
+static const uint8_t token_dfa_byte_classes[256] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  1, 2, 0, 3, 2, 2, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13,
+  14, 14, 14, 15, 14, 14, 14, 14, 16, 14, 17, 18, 19, 20, 21, 22,
+  23, 24, 24, 24, 25, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24,
+  25, 24, 24, 25, 24, 24, 24, 24, 24, 24, 24, 26, 27, 26, 0, 28,
+  0, 29, 29, 29, 30, 29, 29, 29, 31, 29, 29, 29, 29, 29, 32, 33,
+  34, 29, 29, 35, 36, 29, 29, 29, 37, 29, 29, 38, 26, 38, 2, 0,
+  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255
+};
+
+// token_dfa_accepting[state]: whether a token ends just before the next byte
+static const uint8_t token_dfa_accepting[84] = {
+  0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 1, 1, 1, 0, 1, 0, 0, 0, 0,
+  1, 1, 0, 1, 0, 1, 1, 0, 1, 1, 0, 0, 0, 1, 1, 0, 0, 1, 1, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 0, 1, 1,
+  1, 1, 0, 0, 1, 0, 0, 1, 1, 1, 0, 1, 1, 0, 1, 0, 0, 1, 0, 1
+};
+
+// token_dfa_transitions[state * token_dfa_n_classes + class]: the next state
+static const uint16_t token_dfa_transitions[3276] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  2, 0, 2, 3, 2, 2, 4, 4, 2, 5, 2, 6, 2, 4, 7, 7, 8, 9, 10, 11, 10, 12, 2, 13, 14, 15, 4, 16, 17, 14, 15, 18, 14, 14, 15, 14, 14, 14, 4,
+  2, 0, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 0, 0, 0, 2, 2, 2, 2, 2, 2, 2, 0, 0, 2, 2, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2,
+  2, 0, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 19, 19, 19, 2, 2, 2, 2, 2, 2, 2, 19, 19, 2, 2, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 2,
+  2, 0, 2, 2, 2, 20, 2, 2, 20, 2, 2, 20, 2, 2, 0, 0, 21, 21, 21, 2, 21, 2, 2, 2, 0, 0, 2, 2, 2, 0, 0, 0, 0, 22, 0, 0, 0, 0, 2,
+  2, 0, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 23, 23, 23, 2, 2, 2, 2, 2, 2, 2, 0, 0, 2, 2, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2,
+  2, 0, 2, 2, 2, 2, 2, 2, 2, 2, 2, 24, 2, 2, 23, 23, 23, 2, 2, 2, 2, 25, 2, 2, 0, 0, 2, 2, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 25, 26, 27, 28, 26, 7, 7, 7, 26, 0, 0, 0, 0, 0, 0, 29, 29, 0, 29, 30, 29, 29, 29, 29, 29, 29, 29, 29, 29, 0,
+  0, 0, 0, 0, 0, 31, 25, 25, 31, 25, 26, 32, 28, 25, 7, 7, 7, 25, 0, 0, 0, 0, 0, 25, 29, 33, 25, 33, 30, 29, 33, 29, 29, 34, 33, 29, 29, 29, 25,
+  2, 0, 2, 2, 2, 35, 25, 25, 35, 2, 2, 35, 2, 25, 0, 0, 21, 25, 21, 2, 21, 2, 2, 25, 0, 25, 25, 25, 2, 0, 25, 0, 0, 36, 25, 0, 0, 0, 25,
+  2, 0, 2, 2, 2, 37, 25, 25, 37, 2, 2, 37, 2, 25, 0, 0, 0, 25, 2, 2, 2, 2, 2, 25, 0, 25, 25, 25, 2, 0, 25, 0, 0, 31, 25, 0, 0, 0, 25,
+  2, 0, 2, 2, 2, 2, 2, 2, 2, 2, 2, 38, 2, 2, 0, 25, 39, 10, 10, 2, 10, 2, 2, 2, 0, 0, 2, 2, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2,
+  2, 0, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 0, 0, 39, 10, 10, 2, 10, 2, 2, 2, 0, 0, 2, 2, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2,
+  2, 0, 2, 2, 2, 20, 2, 2, 20, 2, 2, 20, 2, 2, 40, 40, 21, 21, 21, 2, 21, 2, 2, 2, 40, 40, 2, 2, 40, 40, 40, 40, 40, 41, 40, 40, 40, 40, 2,
+  0, 0, 0, 0, 0, 42, 0, 0, 0, 0, 0, 43, 44, 0, 45, 45, 45, 0, 0, 0, 0, 0, 0, 0, 14, 14, 0, 29, 46, 14, 14, 14, 14, 14, 14, 14, 14, 14, 0,
+  0, 0, 0, 0, 0, 47, 0, 0, 22, 0, 0, 48, 44, 0, 45, 45, 49, 21, 21, 0, 21, 0, 0, 0, 14, 14, 0, 29, 46, 14, 14, 14, 14, 50, 14, 14, 14, 14, 0,
+  2, 0, 2, 2, 2, 20, 2, 2, 20, 2, 2, 51, 52, 2, 29, 29, 49, 21, 21, 2, 21, 2, 2, 2, 29, 29, 2, 53, 54, 29, 29, 29, 29, 55, 29, 29, 29, 29, 2,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 17, 17, 17, 0, 0, 0, 0, 0, 0, 0, 17, 17, 0, 0, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 0,
+  0, 0, 0, 0, 0, 42, 0, 0, 0, 0, 0, 43, 44, 0, 45, 45, 45, 0, 0, 0, 0, 0, 0, 0, 14, 14, 0, 29, 46, 14, 14, 14, 14, 14, 14, 14, 56, 14, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 19, 19, 19, 0, 0, 0, 0, 0, 0, 0, 19, 19, 0, 0, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 0,
+  2, 0, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 0, 0, 21, 21, 21, 2, 21, 2, 2, 2, 0, 0, 2, 2, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 25, 0, 25, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 21, 21, 21, 0, 21, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 25, 26, 57, 26, 26, 23, 23, 23, 26, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  2, 0, 2, 2, 2, 2, 2, 2, 2, 2, 2, 24, 2, 2, 0, 0, 0, 2, 2, 2, 2, 25, 2, 2, 0, 0, 2, 2, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 58, 58, 58, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 30, 0, 0, 59, 59, 59, 0, 0, 0, 0, 0, 0, 0, 29, 29, 0, 29, 30, 29, 29, 29, 29, 29, 29, 29, 29, 29, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 60, 60, 60, 0, 0, 0, 0, 0, 0, 0, 60, 60, 0, 60, 0, 60, 60, 60, 60, 60, 60, 60, 60, 60, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 30, 44, 0, 29, 29, 29, 0, 0, 0, 0, 0, 0, 0, 29, 29, 0, 29, 30, 29, 29, 29, 29, 29, 29, 29, 29, 29, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 30, 0, 0, 29, 29, 29, 0, 0, 0, 0, 0, 0, 0, 29, 29, 0, 29, 30, 29, 29, 29, 29, 29, 29, 29, 29, 29, 0,
+  0, 0, 0, 0, 0, 0, 25, 25, 0, 0, 0, 0, 0, 25, 0, 0, 0, 25, 0, 0, 0, 0, 0, 25, 0, 25, 25, 25, 0, 0, 25, 0, 0, 0, 25, 0, 0, 0, 25,
+  0, 0, 0, 0, 0, 0, 25, 25, 0, 0, 0, 30, 0, 25, 59, 59, 59, 25, 0, 0, 0, 0, 0, 25, 29, 33, 25, 33, 30, 29, 33, 29, 29, 29, 33, 29, 29, 29, 25,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 30, 44, 0, 29, 29, 29, 0, 0, 0, 0, 0, 0, 0, 29, 29, 0, 29, 30, 29, 29, 29, 29, 29, 29, 29, 29, 29, 0,
+  0, 0, 0, 0, 0, 0, 25, 25, 0, 0, 0, 30, 44, 25, 29, 29, 29, 25, 0, 0, 0, 0, 0, 25, 29, 33, 25, 33, 30, 29, 33, 29, 29, 29, 33, 29, 29, 29, 25,
+  2, 0, 2, 2, 2, 2, 25, 25, 2, 2, 2, 2, 2, 25, 0, 0, 21, 25, 21, 2, 21, 2, 2, 25, 0, 25, 25, 25, 2, 0, 25, 0, 0, 0, 25, 0, 0, 0, 25,
+  0, 0, 0, 0, 0, 0, 25, 25, 0, 0, 0, 0, 0, 25, 0, 0, 21, 25, 21, 0, 21, 0, 0, 25, 0, 25, 25, 25, 0, 0, 25, 0, 0, 0, 25, 0, 0, 0, 25,
+  2, 0, 2, 2, 2, 2, 25, 25, 2, 2, 2, 2, 2, 25, 0, 0, 0, 25, 2, 2, 2, 2, 2, 25, 0, 25, 25, 25, 2, 0, 25, 0, 0, 0, 25, 0, 0, 0, 25,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 38, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 31, 25, 25, 31, 0, 0, 31, 0, 25, 0, 0, 0, 25, 0, 0, 0, 0, 0, 25, 0, 25, 25, 25, 0, 0, 25, 0, 0, 31, 25, 0, 0, 0, 25,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 61, 40, 40, 40, 0, 0, 0, 0, 0, 0, 0, 40, 40, 0, 0, 40, 40, 40, 40, 40, 40, 40, 40, 40, 40, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 61, 40, 40, 21, 21, 21, 0, 21, 0, 0, 0, 40, 40, 0, 0, 40, 40, 40, 40, 40, 40, 40, 40, 40, 40, 0,
+  0, 0, 0, 0, 0, 42, 0, 0, 0, 0, 0, 42, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 62, 62, 0, 0, 42, 62, 62, 62, 62, 62, 62, 62, 62, 62, 0,
+  0, 0, 0, 0, 0, 42, 0, 0, 0, 0, 0, 43, 0, 0, 29, 29, 29, 0, 0, 0, 0, 0, 0, 0, 63, 63, 0, 29, 43, 63, 63, 63, 63, 63, 63, 63, 63, 63, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 60, 60, 60, 0, 0, 0, 0, 0, 0, 0, 60, 60, 0, 60, 0, 60, 60, 60, 60, 60, 60, 60, 60, 60, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 30, 44, 0, 45, 45, 45, 0, 0, 0, 0, 0, 0, 0, 45, 45, 0, 29, 64, 45, 45, 45, 45, 45, 45, 45, 45, 45, 0,
+  0, 0, 0, 0, 0, 42, 0, 0, 0, 0, 0, 43, 0, 0, 45, 45, 45, 0, 0, 0, 0, 0, 0, 0, 63, 63, 0, 29, 46, 63, 63, 63, 63, 63, 63, 63, 63, 63, 0,
+  0, 0, 0, 0, 0, 42, 0, 0, 0, 0, 0, 42, 0, 0, 0, 0, 21, 21, 21, 0, 21, 0, 0, 0, 62, 62, 0, 0, 42, 62, 62, 62, 62, 62, 62, 62, 62, 62, 0,
+  0, 0, 0, 0, 0, 42, 0, 0, 0, 0, 0, 43, 0, 0, 29, 29, 49, 21, 21, 0, 21, 0, 0, 0, 63, 63, 0, 29, 43, 63, 63, 63, 63, 63, 63, 63, 63, 63, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 30, 44, 0, 29, 29, 29, 0, 0, 25, 0, 25, 0, 0, 29, 29, 0, 29, 30, 29, 29, 29, 29, 29, 29, 29, 29, 29, 0,
+  0, 0, 0, 0, 0, 42, 0, 0, 0, 0, 0, 43, 44, 0, 45, 45, 49, 21, 21, 0, 21, 0, 0, 0, 14, 14, 0, 29, 46, 14, 14, 14, 14, 14, 14, 14, 14, 14, 0,
+  2, 0, 2, 2, 2, 2, 2, 2, 2, 2, 2, 54, 2, 2, 29, 29, 49, 21, 21, 2, 21, 2, 2, 2, 29, 29, 2, 53, 54, 29, 29, 29, 29, 29, 29, 29, 29, 29, 2,
+  2, 0, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 60, 60, 60, 2, 2, 2, 2, 2, 2, 2, 60, 60, 2, 60, 2, 60, 60, 60, 60, 60, 60, 60, 60, 60, 2,
+  2, 0, 2, 2, 2, 2, 2, 2, 2, 2, 2, 54, 52, 2, 29, 29, 29, 2, 2, 2, 2, 2, 2, 2, 29, 29, 2, 53, 54, 29, 29, 29, 29, 29, 29, 29, 29, 29, 2,
+  2, 0, 2, 2, 2, 2, 2, 2, 2, 2, 2, 54, 2, 2, 29, 29, 29, 2, 2, 2, 2, 2, 2, 2, 29, 29, 2, 53, 54, 29, 29, 29, 29, 29, 29, 29, 29, 29, 2,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 30, 44, 0, 29, 29, 49, 21, 21, 0, 21, 0, 0, 0, 29, 29, 0, 29, 30, 29, 29, 29, 29, 29, 29, 29, 29, 29, 0,
+  0, 0, 0, 0, 0, 42, 0, 0, 0, 0, 0, 43, 44, 0, 45, 45, 45, 0, 0, 0, 0, 0, 0, 0, 14, 14, 0, 29, 46, 14, 14, 14, 14, 14, 14, 14, 65, 14, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 58, 58, 58, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 25, 26, 57, 26, 26, 58, 58, 58, 26, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 25, 26, 27, 28, 26, 59, 59, 59, 26, 0, 0, 0, 0, 0, 0, 29, 29, 0, 29, 30, 29, 29, 29, 29, 29, 29, 29, 29, 29, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 66, 67, 68, 60, 60, 60, 69, 0, 0, 0, 0, 70, 0, 60, 60, 0, 60, 30, 60, 60, 60, 60, 60, 60, 60, 60, 60, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 71, 71, 0, 0, 0, 71, 71, 71, 71, 71, 71, 71, 71, 71, 0,
+  0, 0, 0, 0, 0, 42, 0, 0, 0, 0, 0, 42, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 62, 62, 0, 0, 42, 62, 62, 62, 62, 62, 62, 62, 62, 62, 0,
+  0, 0, 0, 0, 0, 42, 0, 0, 0, 0, 0, 43, 44, 0, 29, 29, 29, 0, 0, 0, 0, 0, 0, 0, 63, 63, 0, 29, 43, 63, 63, 63, 63, 63, 63, 63, 63, 63, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 30, 0, 0, 45, 45, 45, 0, 0, 0, 0, 0, 0, 0, 45, 45, 0, 29, 64, 45, 45, 45, 45, 45, 45, 45, 45, 45, 0,
+  0, 0, 0, 0, 0, 42, 0, 0, 0, 0, 0, 43, 44, 0, 45, 45, 45, 0, 0, 0, 0, 0, 0, 0, 14, 14, 0, 29, 46, 14, 14, 14, 14, 14, 72, 14, 14, 14, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 66, 0, 0, 60, 60, 60, 0, 0, 0, 0, 0, 0, 0, 60, 60, 0, 60, 30, 60, 60, 60, 60, 60, 60, 60, 60, 60, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 60, 60, 60, 0, 0, 0, 0, 0, 0, 0, 60, 60, 0, 60, 0, 60, 60, 60, 60, 60, 60, 60, 60, 60, 0,
+  0, 0, 73, 73, 73, 73, 74, 0, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 0, 73, 0, 70, 73, 73, 73, 73, 0, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 75, 75, 75, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 70, 76, 76, 70, 70, 70, 70, 70, 70, 76, 70, 76, 76, 76, 76, 70, 70, 0, 76, 0, 70, 70, 76, 76, 70, 0, 76, 76, 76, 76, 76, 76, 76, 76, 76, 76, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 71, 0, 0, 71, 71, 71, 0, 0, 0, 0, 0, 0, 0, 71, 71, 0, 0, 71, 71, 71, 71, 71, 71, 71, 71, 71, 71, 0,
+  0, 0, 0, 0, 0, 42, 0, 0, 0, 0, 0, 43, 44, 0, 45, 45, 45, 77, 0, 0, 0, 0, 0, 0, 14, 14, 0, 29, 46, 14, 14, 14, 14, 14, 14, 78, 14, 14, 0,
+  0, 0, 73, 73, 73, 73, 74, 0, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 0, 73, 0, 70, 73, 73, 73, 73, 0, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 0,
+  0, 0, 79, 79, 79, 79, 0, 0, 79, 79, 79, 79, 79, 79, 79, 79, 79, 79, 79, 0, 79, 0, 0, 79, 79, 79, 79, 0, 79, 79, 79, 79, 79, 79, 79, 79, 79, 79, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 68, 75, 75, 75, 0, 0, 0, 0, 0, 70, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 70, 76, 76, 70, 70, 70, 70, 70, 70, 76, 70, 76, 76, 76, 76, 70, 70, 0, 76, 0, 70, 70, 76, 76, 70, 0, 76, 76, 76, 76, 76, 76, 76, 76, 76, 76, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 42, 0, 0, 0, 0, 0, 43, 44, 0, 45, 45, 45, 77, 0, 0, 0, 0, 0, 0, 14, 14, 0, 29, 46, 14, 14, 14, 14, 14, 14, 14, 14, 14, 0,
+  0, 0, 79, 79, 79, 79, 0, 81, 79, 79, 79, 79, 79, 79, 79, 79, 79, 79, 79, 0, 79, 0, 0, 79, 79, 79, 79, 0, 79, 79, 79, 79, 79, 79, 79, 79, 79, 79, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 82, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 81, 83, 81, 81, 74, 0, 81, 83, 81, 83, 81, 83, 83, 83, 83, 81, 81, 0, 83, 0, 70, 81, 83, 83, 81, 0, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 29, 29, 29, 0, 0, 0, 0, 0, 0, 0, 29, 29, 0, 29, 0, 29, 29, 29, 29, 29, 29, 29, 29, 29, 0,
+  0, 0, 83, 83, 83, 83, 74, 0, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 0, 83, 0, 70, 83, 83, 83, 83, 0, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 0
+};
@@ -2,6 +2,7 @@
 
 #include <re2/re2.h>
 
+#include <cstdint>
 #include <iostream>
 
 namespace {
@@ -9,18 +10,63 @@ namespace {
 // static const LazyRE2 token_re = ...
 #include "token_regex.i"
 
+// static const uint16_t token_dfa_transitions[] = ...
+#include "token_dfa.i"
+
 }; // namespace
 
 namespace twittok {
 
 struct Tokenizer_priv {
-  Tokenizer_priv(const re2::RE2* re_) : re(re_) {}
+  Tokenizer_priv(const re2::RE2* re_, Tokenizer::Backend backend_) : re(re_), backend(backend_) {}
   ~Tokenizer_priv() { delete re; }
 
   const re2::RE2* re;
+  Tokenizer::Backend backend;
 };
 
-Tokenizer::Tokenizer()
+namespace {
+
+/**
+ * Returns the end of the token that starts at text[pos], or pos if none
+ * does. RE2 decides.
+ */
+size_t
+matchRe2(const re2::RE2& re, const re2::StringPiece& text, size_t pos)
+{
+  re2::StringPiece match;
+  if (!re.Match(text, pos, text.size(), re2::RE2::Anchor::ANCHOR_START, &match, 1)) return pos;
+  return match.end() - text.begin();
+}
+
+/**
+ * Returns the end of the token that starts at text[pos], or pos if none
+ * does. The DFA decides, unless it meets a non-ASCII byte.
+ */
+inline size_t
+matchDfa(const re2::RE2& re, const re2::StringPiece& text, size_t pos)
+{
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(text.data());
+  const size_t size = text.size();
+
+  uint16_t state = token_dfa_start;
+  size_t end = pos;
+
+  for (size_t i = pos; i < size; i++) {
+    const uint8_t byteClass = token_dfa_byte_classes[bytes[i]];
+    if (byteClass == token_dfa_not_ascii) return matchRe2(re, text, pos);
+
+    state = token_dfa_transitions[state * token_dfa_n_classes + byteClass];
+    if (state == token_dfa_dead) break;
+    if (token_dfa_accepting[state]) end = i + 1;
+  }
+
+  return end;
+}
+
+} // namespace
+
+Tokenizer::Tokenizer(Backend backend)
   : priv(0)
 {
   re2::RE2::Options options;
@@ -28,7 +74,7 @@ Tokenizer::Tokenizer()
   options.set_never_capture(true);
   options.set_dot_nl(true);
   auto re = new re2::RE2(token_re, options);
-  priv = new Tokenizer_priv(re);
+  priv = new Tokenizer_priv(re, backend);
 
   std::cerr << "RE2 program size: " << this->priv->re->ProgramSize() << std::endl;
 }
@@ -42,16 +88,46 @@ std::vector<re2::StringPiece>
 Tokenizer::tokenize(const re2::StringPiece& text) const
 {
   std::vector<re2::StringPiece> tokens;
+  tokenize(text, &tokens);
+  return tokens;
+}
 
-  re2::StringPiece match; // set every iteration
-  size_t pos(0);
-
-  while (priv->re->Match(text, pos, text.size(), re2::RE2::Anchor::UNANCHORED, &match, 1)) {
-    tokens.push_back(match); // a copy of the StringPiece we just found
-    pos = match.end() - text.begin();
+void
+Tokenizer::tokenizeBatch(const re2::StringPiece* texts, size_t n, Batch* batch) const
+{
+  for (size_t i = 0; i < n; i++) {
+    tokenize(texts[i], &batch->tokens);
+    batch->offsets.push_back(batch->tokens.size());
   }
+}
 
-  return tokens;
+void
+Tokenizer::tokenize(const re2::StringPiece& text, std::vector<re2::StringPiece>* tokens) const
+{
+  if (priv->backend == Backend::Re2) {
+    re2::StringPiece match; // set every iteration
+    size_t pos(0);
+
+    while (priv->re->Match(text, pos, text.size(), re2::RE2::Anchor::UNANCHORED, &match, 1)) {
+      tokens->push_back(match); // a copy of the StringPiece we just found
+      pos = match.end() - text.begin();
+    }
+  } else {
+    // An unanchored search finds the first position where an anchored match
+    // succeeds. token_re never matches the empty string, so we can try each
+    // position in turn; failing is cheap, because whitespace kills the DFA
+    // on its first byte.
+    size_t pos(0);
+    while (pos < text.size()) {
+      const size_t end = matchDfa(*priv->re, text, pos);
+      if (end == pos) {
+        pos++;
+      } else {
+        tokens->push_back(re2::StringPiece(text.data() + pos, end - pos));
+        pos = end;
+      }
+    }
+  }
 }
 
 }; // namespace twittok
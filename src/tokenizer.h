@@ -1,6 +1,8 @@
 #ifndef TWITTOK_H
 #define TWITTOK_H
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <re2/stringpiece.h>
 
@@ -8,15 +10,64 @@ namespace twittok {
 
 class Tokenizer_priv;
 
+/**
+ * Splits text into tokens: URLs, emoticons, mentions, hashtags, words,
+ * numbers and runs of punctuation. The grammar is token_re, in
+ * token_regex.i.
+ */
 class Tokenizer {
 public:
   typedef re2::StringPiece Token;
 
-  Tokenizer();
+  enum class Backend {
+    /**
+     * Runs RE2 from each position. RE2 searches forward for where the next
+     * token ends, then backward for where it starts.
+     */
+    Re2,
+
+    /**
+     * Walks token_dfa.i's tables -- a DFA for token_re, generated by
+     * build-regex/generate-dfa.rb -- one byte at a time, and asks RE2 only
+     * about tokens that contain non-ASCII bytes. Same tokens, much faster.
+     */
+    Dfa
+  };
+
+  /**
+   * The tokens of many texts, in one contiguous array.
+   *
+   * Text i's tokens are tokens[offsets[i]] through tokens[offsets[i + 1] - 1].
+   * Reuse a batch -- clear() it between uses -- and it stops allocating once
+   * it's grown to fit.
+   */
+  struct Batch {
+    Batch() : offsets(1, 0) {}
+
+    std::vector<Token> tokens;
+    std::vector<uint32_t> offsets;
+
+    inline size_t size() const { return offsets.size() - 1; }
+    inline void clear() { tokens.clear(); offsets.resize(1); }
+  };
+
+  Tokenizer(Backend backend = Backend::Dfa);
   ~Tokenizer();
 
   std::vector<Token> tokenize(const re2::StringPiece& text) const;
 
+  /**
+   * Appends text's tokens to *tokens.
+   *
+   * If *tokens has room, this doesn't allocate.
+   */
+  void tokenize(const re2::StringPiece& text, std::vector<Token>* tokens) const;
+
+  /**
+   * Appends each of the n texts' tokens to *batch.
+   */
+  void tokenizeBatch(const re2::StringPiece* texts, size_t n, Batch* batch) const;
+
 private:
   Tokenizer_priv* priv;
 };
@@ -1,8 +1,30 @@
 #ifndef UNTOKENIZED_BIO_H
 #define UNTOKENIZED_BIO_H
 
+#include "util/string_view.h"
+
 namespace twittok {
 
+/**
+ * A Twitter bio and accompanying information, pointing to bytes owned by
+ * somebody else (usually a MmapCsvBioReader).
+ *
+ * Beware: if the owner of those bytes is freed, this is invalid.
+ */
+struct UntokenizedBioRef {
+  UntokenizedBioRef() : id(0), followsClinton(false), followsTrump(false) {}
+  UntokenizedBioRef(uint64_t id_, bool followsClinton_, bool followsTrump_, meta::util::string_view utf8_)
+    : id(id_), followsClinton(followsClinton_), followsTrump(followsTrump_), utf8(utf8_) {}
+
+  bool isNull() const { return id == 0; }
+  bool empty() const { return utf8.empty(); }
+
+  uint64_t id;
+  bool followsClinton;
+  bool followsTrump;
+  meta::util::string_view utf8;
+};
+
 /**
  * A Twitter bio and accompanying information, untokenized.
  *
@@ -18,6 +40,7 @@ struct UntokenizedBio {
 
   bool isNull() const { return id == 0; }
   bool empty() const { return utf8.empty(); }
+  UntokenizedBioRef ref() const { return { id, followsClinton, followsTrump, utf8 }; }
 
   uint64_t id;
   bool followsClinton;
@@ -0,0 +1,72 @@
+#include "vocabulary.h"
+
+#include <functional>
+#include <stdexcept>
+
+namespace twittok {
+
+Vocabulary::Vocabulary()
+  : size_(0)
+  , chunks_(new std::atomic<const std::string**>[MaxChunks]())
+{
+}
+
+Vocabulary::~Vocabulary()
+{
+  for (size_t i = 0; i < MaxChunks; i++) {
+    delete[] chunks_[i].load(std::memory_order_relaxed);
+  }
+}
+
+const std::string**
+Vocabulary::chunkFor(TokenId id)
+{
+  std::atomic<const std::string**>& slot(chunks_[id >> ChunkBits]);
+
+  const std::string** chunk = slot.load(std::memory_order_acquire);
+  if (chunk) return chunk;
+
+  std::lock_guard<std::mutex> lock(chunksMutex_);
+  chunk = slot.load(std::memory_order_relaxed);
+  if (!chunk) {
+    chunk = new const std::string*[ChunkSize]();
+    slot.store(chunk, std::memory_order_release);
+  }
+  return chunk;
+}
+
+TokenId
+Vocabulary::intern(const std::string& string)
+{
+  Shard& shard(shards_[std::hash<std::string>()(string) % NShards]);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+
+  auto it = shard.ids.find(string);
+  if (it != shard.ids.end()) return it->second;
+
+  const size_t id = size_.fetch_add(1, std::memory_order_acq_rel);
+  if (id >= MaxChunks * ChunkSize) throw std::length_error("Too many distinct tokens");
+
+  it = shard.ids.emplace(string, static_cast<TokenId>(id)).first;
+  chunkFor(id)[id & (ChunkSize - 1)] = &it->first; // unordered_map never moves its keys
+  return id;
+}
+
+size_t
+Vocabulary::nBytes() const
+{
+  size_t ret = MaxChunks * sizeof(chunks_[0]);
+
+  for (size_t i = 0; i < NShards; i++) {
+    for (const auto& pair : shards_[i].ids) {
+      ret += sizeof(pair) + pair.first.capacity() + sizeof(void*) * 2; // + node and bucket overhead
+    }
+  }
+
+  const size_t nChunks = (size() + ChunkSize - 1) / ChunkSize;
+  ret += nChunks * ChunkSize * sizeof(const std::string*);
+
+  return ret;
+}
+
+} // namespace twittok
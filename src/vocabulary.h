@@ -0,0 +1,81 @@
+#ifndef VOCABULARY_H
+#define VOCABULARY_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace twittok {
+
+/**
+ * Identifies a stemmed token within a Vocabulary.
+ */
+typedef uint32_t TokenId;
+
+/**
+ * Interns each distinct stemmed token once, as a dense TokenId.
+ *
+ * intern() and string() are safe to call from any number of threads at once.
+ * We split the dictionary into shards by hash, each with its own mutex, so
+ * threads rarely wait on one another. The id-to-string table is an array of
+ * fixed-size chunks that never move, so string() needs no lock.
+ *
+ * Ids are handed out in the order strings are first interned. With several
+ * threads, that order isn't deterministic: never let ids leak into output
+ * order.
+ */
+class Vocabulary {
+public:
+  Vocabulary();
+  ~Vocabulary();
+
+  Vocabulary(const Vocabulary&) = delete;
+  Vocabulary& operator=(const Vocabulary&) = delete;
+
+  /**
+   * Returns the id for the given string, assigning one if it's new.
+   */
+  TokenId intern(const std::string& string);
+
+  /**
+   * Returns the string for an id that intern() returned.
+   */
+  inline const std::string& string(TokenId id) const {
+    return *chunks_[id >> ChunkBits].load(std::memory_order_acquire)[id & (ChunkSize - 1)];
+  }
+
+  /**
+   * Returns the number of distinct strings.
+   */
+  inline size_t size() const { return size_.load(std::memory_order_acquire); }
+
+  /**
+   * Returns roughly how many bytes of heap we use.
+   */
+  size_t nBytes() const;
+
+private:
+  static const size_t NShards = 64;
+  static const size_t ChunkBits = 16;
+  static const size_t ChunkSize = static_cast<size_t>(1) << ChunkBits;
+  static const size_t MaxChunks = static_cast<size_t>(1) << (32 - ChunkBits);
+
+  struct Shard {
+    std::mutex mutex;
+    std::unordered_map<std::string, TokenId> ids;
+  };
+
+  const std::string** chunkFor(TokenId id);
+
+  Shard shards_[NShards];
+  std::atomic<size_t> size_;
+  std::mutex chunksMutex_; // held while allocating a chunk
+  std::unique_ptr<std::atomic<const std::string**>[]> chunks_; // MaxChunks pointers to ChunkSize keys of shards_[].ids
+};
+
+} // namespace twittok
+
+#endif /* VOCABULARY_H */
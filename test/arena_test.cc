@@ -0,0 +1,72 @@
+#include "arena.h"
+
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using twittok::Arena;
+using twittok::ArenaAllocator;
+
+TEST(ArenaTest, reuses_freed_allocations) {
+  Arena arena;
+
+  void* a = arena.allocate(24);
+  void* b = arena.allocate(32); // same size class
+  EXPECT_NE(a, b);
+  arena.deallocate(a, 24);
+  EXPECT_EQ(a, arena.allocate(30));
+  EXPECT_NE(a, arena.allocate(100)); // a different class
+
+  const Arena::Stats stats = arena.stats();
+  EXPECT_EQ(1, stats.nBlocks);
+  EXPECT_EQ(4, stats.nAllocations);
+  EXPECT_EQ(1, stats.nReused);
+  EXPECT_EQ(0, stats.nLarge);
+}
+
+TEST(ArenaTest, allocations_do_not_overlap) {
+  Arena arena;
+
+  // Enough to fill several blocks, in every size class
+  std::vector<std::pair<char*, size_t> > allocations;
+  for (size_t i = 0; i < 4000; i++) {
+    const size_t size = 1 + (i * 7919) % Arena::MaxClassSize / (1 + i % 64);
+    char* p = static_cast<char*>(arena.allocate(size));
+    memset(p, static_cast<int>(i), size);
+    allocations.push_back(std::make_pair(p, size));
+  }
+
+  for (size_t i = 0; i < allocations.size(); i++) {
+    const char* p = allocations[i].first;
+    for (size_t j = 0; j < allocations[i].second; j++) ASSERT_EQ(static_cast<char>(i), p[j]) << i;
+  }
+  EXPECT_GT(arena.stats().nBlocks, 1);
+}
+
+TEST(ArenaTest, large_allocations_use_heap) {
+  Arena arena;
+  void* p = arena.allocate(Arena::MaxClassSize + 1);
+  arena.deallocate(p, Arena::MaxClassSize + 1);
+  EXPECT_EQ(1, arena.stats().nLarge);
+  EXPECT_EQ(0, arena.stats().nBlocks);
+}
+
+TEST(ArenaTest, scope_sets_default_allocator) {
+  Arena arena;
+  typedef std::vector<int, ArenaAllocator<int> > Vector;
+
+  EXPECT_EQ(NULL, Vector().get_allocator().arena());
+  {
+    Arena::Scope scope(&arena);
+    Vector v;
+    EXPECT_EQ(&arena, v.get_allocator().arena());
+    for (int i = 0; i < 100; i++) v.push_back(i);
+
+    const Vector copy(v); // copies may outlive the Arena, so they use the heap
+    EXPECT_EQ(NULL, copy.get_allocator().arena());
+    EXPECT_EQ(v, copy);
+  }
+  EXPECT_EQ(NULL, Vector().get_allocator().arena());
+  EXPECT_GT(arena.stats().nReused, 0); // the vector grew: 1, 2, 4...
+}
@@ -0,0 +1,109 @@
+#include "bio_deduplicator.h"
+
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "bio_store.h"
+#include "ngram_pass.h"
+
+using twittok::BioDeduplicator;
+using twittok::BioStore;
+using twittok::BioWeight;
+using twittok::NgramPass;
+using twittok::Tokenizer;
+using twittok::UntokenizedBioRef;
+using twittok::Vocabulary;
+
+namespace {
+
+template<size_t N>
+typename NgramPass<N>::NgramSet
+doPass(const typename NgramPass<N>::PrefixSet& prefixes, const BioStore& bios, std::ostream& os, size_t minCount)
+{
+  NgramPass<N> pass(prefixes);
+  pass.scanBios(bios);
+  pass.dump(os, bios.vocabulary(), minCount);
+  return pass.ngramKeys(minCount);
+}
+
+std::string
+dump(const BioStore& bios, size_t minCount)
+{
+  std::ostringstream os;
+  const auto grams1 = doPass<1>(NgramPass<1>::PrefixSet(), bios, os, minCount);
+  const auto grams2 = doPass<2>(grams1, bios, os, minCount);
+  doPass<3>(grams2, bios, os, minCount);
+  return os.str();
+}
+
+} // namespace ""
+
+TEST(BioDeduplicatorTest, weights) {
+  BioDeduplicator deduplicator;
+  deduplicator.add(UntokenizedBioRef(1, true, false, "Proud mom"));
+  deduplicator.add(UntokenizedBioRef(2, false, true, "#MAGA"));
+  deduplicator.add(UntokenizedBioRef(3, true, true, "Proud mom"));
+  deduplicator.add(UntokenizedBioRef(4, false, true, "proud mom")); // different bytes
+  deduplicator.add(UntokenizedBioRef(5, false, true, "Proud mom"));
+
+  EXPECT_EQ(5, deduplicator.nAdded());
+  ASSERT_EQ(3, deduplicator.bios().size());
+  EXPECT_EQ(1, deduplicator.bios()[0].id); // first one wins
+  EXPECT_EQ(2, deduplicator.bios()[1].id);
+  EXPECT_EQ(4, deduplicator.bios()[2].id);
+
+  const BioWeight& weight(deduplicator.weights()[0]);
+  EXPECT_EQ(3, weight.n);
+  EXPECT_EQ(2, weight.nClinton);
+  EXPECT_EQ(2, weight.nTrump);
+  EXPECT_EQ(1, weight.nBoth);
+
+  EXPECT_EQ(1, deduplicator.weights()[1].n);
+  EXPECT_EQ(0, deduplicator.weights()[1].nClinton);
+}
+
+TEST(BioDeduplicatorTest, counts_match_undeduplicated) {
+  const char* templates[] = {
+    "Proud mom of two, proud wife", "#MAGA #MAGA Trump 2016", "God, family, country",
+    "Love love LOVE dogs", "I'm With Her", "Wife. Mom. Teacher.", "NFL fan | #ImWithHer",
+  };
+  const size_t nTemplates = sizeof(templates) / sizeof(templates[0]);
+
+  std::srand(1);
+  std::vector<std::string> texts;
+  for (int i = 0; i < 2000; i++) {
+    // Mostly templates, plus a tail of one-off bios
+    const size_t t = std::rand() % (nTemplates + 3);
+    texts.push_back(t < nTemplates ? templates[t] : templates[std::rand() % nTemplates] + std::string(" #") + std::to_string(i));
+  }
+
+  std::vector<UntokenizedBioRef> untokenized;
+  for (size_t i = 0; i < texts.size(); i++) {
+    untokenized.push_back(UntokenizedBioRef(i + 1, i % 3 != 1, i % 3 != 0, texts[i]));
+  }
+
+  Tokenizer tokenizer;
+
+  Vocabulary vocabulary;
+  BioStore store(vocabulary);
+  store.addBatch(untokenized.data(), untokenized.size(), tokenizer);
+  EXPECT_FALSE(store.weighted());
+
+  BioDeduplicator deduplicator;
+  for (const auto& bio : untokenized) deduplicator.add(bio);
+  Vocabulary dedupVocabulary;
+  BioStore dedupStore(dedupVocabulary);
+  dedupStore.addBatch(deduplicator.bios().data(), deduplicator.weights().data(), deduplicator.bios().size(), tokenizer);
+  EXPECT_TRUE(dedupStore.weighted());
+  EXPECT_LT(dedupStore.size(), store.size() / 2);
+
+  for (size_t minCount : { 1, 10, 100 }) {
+    const std::string expected = dump(store, minCount);
+    ASSERT_NE("", expected);
+    EXPECT_EQ(expected, dump(dedupStore, minCount)) << "minCount " << minCount;
+  }
+}
@@ -0,0 +1,158 @@
+#include "bio_pipeline.h"
+
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "mmap_csv_bio_reader.h"
+
+using twittok::BioPipeline;
+using twittok::BioStore;
+using twittok::CsvBioReader;
+using twittok::MmapCsvBioReader;
+using twittok::NgramPass;
+using twittok::Tokenizer;
+using twittok::Vocabulary;
+
+namespace {
+
+std::string
+makeCsv(size_t nBios)
+{
+  const char* texts[] = {
+    "Proud mom and wife",
+    "\"Mom, wife, \"\"patriot\"\"\"",
+    "",
+    "\"Two\nlines, proud\"",
+    "Wife. Mom. Proud American.",
+  };
+
+  std::string csv;
+  for (size_t i = 0; i < nBios; i++) {
+    csv += std::to_string(i + 1) + "," + (i % 2 ? "1" : "0") + "," + (i % 3 ? "0" : "1") + ",";
+    csv += texts[i % (sizeof(texts) / sizeof(texts[0]))];
+    csv += "\n";
+  }
+  return csv;
+}
+
+std::string
+pass1Dump(const NgramPass<1>& pass, const Vocabulary& vocabulary)
+{
+  std::ostringstream os;
+  pass.dump(os, vocabulary, 10);
+  return os.str();
+}
+
+} // namespace ""
+
+class BioPipelineTest : public ::testing::Test {
+protected:
+  BioPipelineTest() : expected(expectedVocabulary) {}
+
+  void readSerially(const std::string& csv) {
+    MmapCsvBioReader reader(csv.data(), csv.data() + csv.size());
+    Tokenizer tokenizer;
+    while (true) {
+      CsvBioReader::Error error;
+      const auto bio = reader.nextBio(&error);
+      if (error != CsvBioReader::Error::Success) break;
+      expectedCounts.add(bio);
+      if (!bio.empty()) expected.add(bio, tokenizer);
+    }
+  }
+
+  Vocabulary expectedVocabulary;
+  BioStore expected;
+  twittok::BioCounts expectedCounts;
+};
+
+TEST_F(BioPipelineTest, same_as_serial) {
+  const std::string csv = makeCsv(10000);
+  readSerially(csv);
+
+  for (size_t nTokenizers = 1; nTokenizers <= 4; nTokenizers++) {
+    Vocabulary vocabulary;
+    BioStore bios(vocabulary);
+    NgramPass<1> pass1((NgramPass<1>::PrefixSet()));
+    BioPipeline pipeline(csv.data(), csv.data() + csv.size(), nTokenizers);
+
+    CsvBioReader::Error error;
+    pipeline.run(&bios, &pass1, &error);
+
+    EXPECT_EQ(CsvBioReader::Error::Success, error);
+    EXPECT_EQ(expected.size(), bios.size());
+    EXPECT_EQ(expected.nTokens(), bios.nTokens());
+    EXPECT_EQ(expectedCounts.n(), pipeline.counts().n());
+    EXPECT_EQ(expectedCounts.nWithBio(), pipeline.counts().nWithBio());
+    EXPECT_EQ(expectedCounts.nBothWithBio, pipeline.counts().nBothWithBio);
+
+    NgramPass<1> expectedPass1((NgramPass<1>::PrefixSet()));
+    expectedPass1.scanBios(expected);
+    ASSERT_EQ(expectedPass1.gramToInfo.size(), pass1.gramToInfo.size());
+    for (const auto& entry : expectedPass1.gramToInfo) {
+      const auto* info = pass1.gramToInfo.find({ vocabulary.intern(expectedVocabulary.string(entry.key[0])) });
+      ASSERT_TRUE(info != NULL);
+      EXPECT_EQ(entry.value.nClinton, info->nClinton);
+      EXPECT_EQ(entry.value.nTrump, info->nTrump);
+      EXPECT_EQ(entry.value.nBoth, info->nBoth);
+      EXPECT_EQ(entry.value.nVariants(), info->nVariants());
+    }
+
+    // Several tokenizers hand out ids in another order, but dump() ignores ids
+    EXPECT_EQ(pass1Dump(expectedPass1, expectedVocabulary), pass1Dump(pass1, vocabulary));
+  }
+}
+
+TEST_F(BioPipelineTest, dump_is_identical_for_any_number_of_tokenizers) {
+  // Each run of 24 bios has its own word, so tokenizers intern new words in
+  // every batch, racing each other. Every word's counts tie.
+  std::string csv;
+  for (size_t i = 0; i < 40000; i++) {
+    csv += std::to_string(i + 1) + "," + (i % 2 ? "1" : "0") + "," + (i % 3 ? "0" : "1") + ",";
+    csv += "w" + std::to_string(i / 24) + " proud\n";
+  }
+
+  std::string expectedDump;
+  for (size_t nTokenizers = 1; nTokenizers <= 8; nTokenizers++) {
+    Vocabulary vocabulary;
+    BioStore bios(vocabulary);
+    BioPipeline pipeline(csv.data(), csv.data() + csv.size(), nTokenizers);
+    CsvBioReader::Error error;
+    pipeline.run(&bios, NULL, &error);
+    ASSERT_EQ(CsvBioReader::Error::Success, error);
+
+    NgramPass<1> pass1((NgramPass<1>::PrefixSet()));
+    pass1.scanBios(bios, nTokenizers);
+    NgramPass<2> pass2(pass1.ngramKeys(10));
+    pass2.scanBios(bios, nTokenizers);
+
+    std::ostringstream os;
+    pass1.dump(os, vocabulary, 10, nTokenizers);
+    pass2.dump(os, vocabulary, 10, nTokenizers);
+
+    if (nTokenizers == 1) {
+      expectedDump = os.str();
+      ASSERT_NE("", expectedDump);
+    } else {
+      EXPECT_EQ(expectedDump, os.str()) << nTokenizers << " tokenizers";
+    }
+  }
+}
+
+TEST_F(BioPipelineTest, stops_at_error) {
+  const std::string csv = makeCsv(3000) + "oops\n" + makeCsv(10);
+  readSerially(csv);
+
+  Vocabulary vocabulary;
+  BioStore bios(vocabulary);
+  BioPipeline pipeline(csv.data(), csv.data() + csv.size(), 2);
+
+  CsvBioReader::Error error;
+  pipeline.run(&bios, NULL, &error);
+
+  EXPECT_NE(CsvBioReader::Error::Success, error);
+  EXPECT_EQ(expected.size(), bios.size());
+  EXPECT_EQ(expectedCounts.n(), pipeline.counts().n());
+}
@@ -0,0 +1,212 @@
+#include "bio_store.h"
+
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using twittok::Bio;
+using twittok::BioStore;
+using twittok::Tokenizer;
+using twittok::UntokenizedBioRef;
+using twittok::Vocabulary;
+
+namespace {
+
+/**
+ * Returns each distinct ngram's first start, the slow way.
+ */
+template<size_t N>
+std::map<twittok::NgramKey<N>, uint32_t>
+firstStarts(const Bio& bio, size_t nTokens)
+{
+  std::map<twittok::NgramKey<N>, uint32_t> ret;
+  for (size_t i = 0; i + N <= nTokens; i++) ret.insert(std::make_pair(bio.gramsAt<N>(i), static_cast<uint32_t>(i)));
+  return ret;
+}
+
+template<size_t N>
+void
+expectDistinctNgramStarts(const BioStore& store)
+{
+  std::vector<uint32_t> starts;
+  for (size_t i = 0; i < store.size(); i++) {
+    const Bio bio(store[i]);
+    const auto expected = firstStarts<N>(bio, store.tokenEnd(i) - store.tokenBegin(i));
+
+    bio.distinctNgramStarts<N>(&starts);
+    std::map<twittok::NgramKey<N>, uint32_t> actual;
+    for (const uint32_t start : starts) actual.insert(std::make_pair(bio.gramsAt<N>(start), start));
+
+    ASSERT_EQ(expected.size(), starts.size()) << "bio " << i << ", N=" << N;
+    ASSERT_EQ(expected, actual) << "bio " << i << ", N=" << N;
+  }
+}
+
+} // namespace
+
+class BioStoreTest : public ::testing::Test {
+protected:
+  BioStoreTest() : store(vocabulary) {}
+
+  void add(bool followsClinton, bool followsTrump, const char* utf8) {
+    store.add(UntokenizedBioRef(1, followsClinton, followsTrump, utf8), tokenizer);
+  }
+
+  std::string stem(const twittok::Unigram& unigram) {
+    return vocabulary.string(unigram.grams[0]);
+  }
+
+  Tokenizer tokenizer;
+  Vocabulary vocabulary;
+  BioStore store;
+};
+
+TEST_F(BioStoreTest, flags) {
+  add(true, false, "one");
+  add(false, true, "two");
+  add(true, true, "three");
+
+  ASSERT_EQ(3, store.size());
+  EXPECT_TRUE(store[0].followsClinton);
+  EXPECT_FALSE(store[0].followsTrump);
+  EXPECT_FALSE(store[1].followsClinton);
+  EXPECT_TRUE(store[1].followsTrump);
+  EXPECT_TRUE(store[2].followsClinton);
+  EXPECT_TRUE(store[2].followsTrump);
+}
+
+TEST_F(BioStoreTest, unigrams) {
+  add(true, false, "Running dogs");
+
+  const auto ngrams = store[0].ngrams<1>();
+  ASSERT_EQ(2, ngrams.size());
+  EXPECT_EQ("run", stem(ngrams[0])); // ids are in order of first appearance
+  EXPECT_EQ("Running", ngrams[0].original.to_string());
+  EXPECT_EQ("dog", stem(ngrams[1]));
+  EXPECT_EQ("dogs", ngrams[1].original.to_string());
+}
+
+TEST_F(BioStoreTest, bigram_original_spans_whitespace) {
+  add(true, false, "Running  dogs");
+
+  const auto ngrams = store[0].ngrams<2>();
+  ASSERT_EQ(1, ngrams.size());
+  EXPECT_EQ("run dog", ngrams[0].gramsString(vocabulary));
+  EXPECT_EQ("Running  dogs", ngrams[0].original.to_string());
+}
+
+TEST_F(BioStoreTest, too_few_tokens) {
+  add(true, false, "dogs");
+
+  EXPECT_EQ(0, store[0].ngrams<2>().size());
+}
+
+TEST_F(BioStoreTest, dedupes_ngrams_within_bio) {
+  add(true, false, "Dogs dog dogs");
+
+  const auto ngrams = store[0].ngrams<1>();
+  ASSERT_EQ(1, ngrams.size());
+  EXPECT_EQ("dog", stem(ngrams[0]));
+  EXPECT_EQ("Dogs", ngrams[0].original.to_string()); // first spelling wins
+}
+
+TEST_F(BioStoreTest, stems_are_shared) {
+  add(true, false, "dogs");
+  add(false, true, "dog");
+
+  EXPECT_EQ(2, store.nTokens());
+  EXPECT_EQ(1, vocabulary.size());
+}
+
+TEST_F(BioStoreTest, bios_stay_valid_after_source_is_freed) {
+  {
+    std::string utf8("cats eat dogs");
+    store.add(UntokenizedBioRef(1, true, false, utf8), tokenizer);
+    utf8.assign(utf8.size(), 'x');
+  }
+  add(true, false, "more");
+  store.shrinkToFit();
+
+  const auto ngrams = store[0].ngrams<3>();
+  ASSERT_EQ(1, ngrams.size());
+  EXPECT_EQ("cats eat dogs", ngrams[0].original.to_string());
+}
+
+TEST_F(BioStoreTest, add_batch_matches_add) {
+  const std::vector<UntokenizedBioRef> untokenized = {
+    UntokenizedBioRef(1, true, false, "Running dogs"),
+    UntokenizedBioRef(2, false, true, "!!!"),
+    UntokenizedBioRef(3, true, true, "Mom of 3 dogs #MAGA")
+  };
+
+  Vocabulary batchVocabulary;
+  BioStore batchStore(batchVocabulary);
+  batchStore.addBatch(untokenized.data(), untokenized.size(), tokenizer);
+  for (const auto& bio : untokenized) store.add(bio, tokenizer);
+
+  ASSERT_EQ(store.size(), batchStore.size());
+  ASSERT_EQ(store.nTokens(), batchStore.nTokens());
+  for (size_t i = 0; i < store.size(); i++) {
+    EXPECT_EQ(store.tokenBegin(i), batchStore.tokenBegin(i));
+    EXPECT_EQ(store.flags(i), batchStore.flags(i));
+  }
+  for (size_t i = 0; i < store.nTokens(); i++) {
+    EXPECT_EQ(vocabulary.string(store.tokenIds()[i]), batchVocabulary.string(batchStore.tokenIds()[i]));
+  }
+  EXPECT_EQ("Mom of 3", batchStore.originalText(2, batchStore.tokenBegin(2), 3).to_string());
+}
+
+TEST_F(BioStoreTest, weights) {
+  add(true, false, "one");
+  EXPECT_FALSE(store.weighted());
+
+  const UntokenizedBioRef bio(2, true, true, "two");
+  const twittok::BioWeight weight{ 5, 3, 4, 2 };
+  store.addBatch(&bio, &weight, 1, tokenizer);
+  add(false, true, "three");
+
+  ASSERT_TRUE(store.weighted());
+  EXPECT_EQ(1, store.weight(0).n);
+  EXPECT_EQ(1, store.weight(0).nClinton);
+  EXPECT_EQ(0, store.weight(0).nTrump);
+  EXPECT_EQ(5, store[1].weight.n);
+  EXPECT_EQ(2, store[1].weight.nBoth);
+  EXPECT_TRUE(store[1].followsClinton);
+  EXPECT_EQ(1, store.weight(2).nTrump);
+
+  // append() keeps them, whichever side is weighted
+  BioStore appended(vocabulary);
+  add(true, true, "four");
+  appended.add(UntokenizedBioRef(5, true, false, "five"), tokenizer);
+  appended.append(store);
+  ASSERT_EQ(5, appended.size());
+  EXPECT_EQ(1, appended.weight(0).n);
+  EXPECT_EQ(5, appended.weight(2).n);
+  EXPECT_EQ(1, appended.weight(4).nBoth);
+}
+
+TEST_F(BioStoreTest, distinct_ngram_starts) {
+  // Few distinct words, so bios repeat ngrams. Some bios are longer than
+  // the windows Bio keeps on the stack.
+  const char* words[] = { "mom", "wife", "dog", "love", "god", "family" };
+
+  std::srand(4);
+  std::vector<std::string> texts;
+  for (int i = 0; i < 300; i++) {
+    std::string text;
+    const size_t nTokens = i % 10 == 0 ? 100 + std::rand() % 50 : std::rand() % 20;
+    for (size_t t = 0; t < nTokens; t++) text += std::string(words[std::rand() % 6]) + ' ';
+    texts.push_back(text);
+  }
+  for (const auto& text : texts) add(true, false, text.c_str());
+
+  expectDistinctNgramStarts<1>(store); // 64-bit keys
+  expectDistinctNgramStarts<3>(store);
+  expectDistinctNgramStarts<4>(store); // 128-bit keys
+  expectDistinctNgramStarts<6>(store);
+  expectDistinctNgramStarts<7>(store); // token by token
+  expectDistinctNgramStarts<10>(store);
+}
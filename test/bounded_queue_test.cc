@@ -0,0 +1,79 @@
+#include "bounded_queue.h"
+
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using twittok::BoundedQueue;
+
+TEST(BoundedQueueTest, fifo) {
+  BoundedQueue<int> queue(4);
+
+  for (int i = 0; i < 4; i++) {
+    int value = i;
+    EXPECT_TRUE(queue.tryPush(value));
+  }
+
+  int overflow = 4;
+  EXPECT_FALSE(queue.tryPush(overflow));
+  EXPECT_EQ(4, overflow);
+
+  for (int i = 0; i < 4; i++) {
+    int value;
+    EXPECT_TRUE(queue.tryPop(&value));
+    EXPECT_EQ(i, value);
+  }
+
+  int value;
+  EXPECT_FALSE(queue.tryPop(&value));
+}
+
+TEST(BoundedQueueTest, capacity_rounds_up) {
+  BoundedQueue<int> queue(3);
+
+  for (int i = 0; i < 4; i++) {
+    int value = i;
+    EXPECT_TRUE(queue.tryPush(value));
+  }
+}
+
+TEST(BoundedQueueTest, many_producers_and_consumers) {
+  const size_t NProducers = 3;
+  const size_t NConsumers = 3;
+  const size_t NPerProducer = 20000;
+
+  BoundedQueue<size_t> queue(8);
+  std::vector<std::vector<size_t> > popped(NConsumers);
+
+  std::vector<std::thread> threads;
+  for (size_t p = 0; p < NProducers; p++) {
+    threads.emplace_back([&queue, p, NPerProducer]() {
+      for (size_t i = 0; i < NPerProducer; i++) queue.push(p * NPerProducer + i + 1);
+    });
+  }
+  for (size_t c = 0; c < NConsumers; c++) {
+    threads.emplace_back([&queue, &popped, c]() {
+      while (size_t value = queue.pop()) popped[c].push_back(value); // 0 means stop
+    });
+  }
+
+  for (size_t p = 0; p < NProducers; p++) threads[p].join();
+  for (size_t c = 0; c < NConsumers; c++) queue.push(0);
+  for (size_t c = 0; c < NConsumers; c++) threads[NProducers + c].join();
+
+  std::vector<bool> seen(NProducers * NPerProducer + 1, false);
+  for (const auto& values : popped) {
+    size_t last[NProducers] = { 0 };
+    for (size_t value : values) {
+      ASSERT_FALSE(seen[value]);
+      seen[value] = true;
+
+      // Each consumer sees each producer's values in order
+      const size_t p = (value - 1) / NPerProducer;
+      EXPECT_LT(last[p], value);
+      last[p] = value;
+    }
+  }
+  for (size_t i = 1; i < seen.size(); i++) ASSERT_TRUE(seen[i]) << i;
+}
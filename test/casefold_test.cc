@@ -0,0 +1,141 @@
+#include "casefold.h"
+
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using twittok::casefold_and_normalize;
+using twittok::casefold_and_normalize_with_icu;
+using twittok::casefold_thread_stats;
+
+TEST(CasefoldTest, ascii) {
+  EXPECT_EQ("", casefold_and_normalize(""));
+  EXPECT_EQ("lgbt", casefold_and_normalize("LGBT"));
+  EXPECT_EQ("@hillaryclinton", casefold_and_normalize("@HillaryClinton"));
+  EXPECT_EQ("#imwithher", casefold_and_normalize("#ImWithHer"));
+  EXPECT_EQ("a longer token, so simd sees two whole blocks!!", casefold_and_normalize("A LONGER TOKEN, so SIMD sees two whole BLOCKS!!"));
+}
+
+TEST(CasefoldTest, non_ascii) {
+  EXPECT_EQ("cafe", casefold_and_normalize("CAFÉ"));
+  EXPECT_EQ("strasse", casefold_and_normalize("STRAßE"));
+  EXPECT_EQ("a very long ascii prefix then cafe", casefold_and_normalize("A very long ASCII prefix then café"));
+}
+
+TEST(CasefoldTest, ascii_matches_icu) {
+  std::srand(1);
+
+  // Every ASCII byte, at every position relative to a 16-byte block
+  for (int run = 0; run < 100000; run++) {
+    std::string token(std::rand() % 40, ' ');
+    for (auto& c : token) c = static_cast<char>(std::rand() % 128);
+
+    ASSERT_EQ(casefold_and_normalize_with_icu(token), casefold_and_normalize(token)) << "run " << run;
+  }
+}
+
+TEST(CasefoldTest, mixed_matches_icu) {
+  const char* pieces[] = { "a", "Z", "@", "0", "É", "é", "ß", "ﬁ", "K", "İ", "🇺🇸", "Ω", "\xcc\x81" /* combining acute */ };
+  const size_t nPieces = sizeof(pieces) / sizeof(pieces[0]);
+
+  std::srand(2);
+  for (int run = 0; run < 20000; run++) {
+    std::string token;
+    const size_t n = std::rand() % 30;
+    for (size_t i = 0; i < n; i++) token += pieces[std::rand() % nPieces];
+
+    ASSERT_EQ(casefold_and_normalize_with_icu(token), casefold_and_normalize(token)) << token;
+  }
+}
+
+TEST(CasefoldTest, utf8_matches_icu_on_random_code_points) {
+  // Code points from blocks with compatibility forms, marks, case pairs,
+  // expanding folds and Hangul syllables
+  const std::vector<std::pair<uint32_t, uint32_t> > ranges = {
+    { 0x20, 0x7e }, { 0xa0, 0x24f }, { 0x300, 0x36f }, { 0x370, 0x3ff }, { 0x400, 0x4ff },
+    { 0x1e00, 0x1fff }, { 0x2000, 0x215f }, { 0x2460, 0x24ff }, { 0x3000, 0x30ff }, { 0xac00, 0xac40 },
+    { 0xfb00, 0xfb06 }, { 0xff01, 0xff5e }, { 0x1d400, 0x1d4ff }, { 0x1f1e6, 0x1f1ff }
+  };
+
+  std::srand(3);
+  for (int run = 0; run < 50000; run++) {
+    icu::UnicodeString unicode;
+    const size_t n = std::rand() % 12;
+    for (size_t i = 0; i < n; i++) {
+      const auto& range(ranges[std::rand() % ranges.size()]);
+      unicode.append(static_cast<UChar32>(range.first + std::rand() % (range.second - range.first + 1)));
+    }
+    std::string token;
+    unicode.toUTF8String(token);
+
+    ASSERT_EQ(casefold_and_normalize_with_icu(token), casefold_and_normalize(token)) << token;
+  }
+}
+
+TEST(CasefoldTest, invalid_utf8_matches_icu) {
+  const char* tokens[] = { "caf\xc3", "\xff", "A\xe2\x82" "B", "\xed\xa0\x80" /* a surrogate */, "\xc3\xa9\x80" };
+  for (const char* token : tokens) {
+    EXPECT_EQ(casefold_and_normalize_with_icu(token), casefold_and_normalize(token)) << token;
+  }
+}
+
+TEST(CasefoldTest, reuses_output) {
+  std::string out("some old contents, longer than the result");
+
+  twittok::casefold_and_normalize("CAFÉ", 5, &out);
+  EXPECT_EQ("cafe", out);
+
+  twittok::casefold_and_normalize("LGBT", 4, &out);
+  EXPECT_EQ("lgbt", out);
+
+  twittok::casefold_and_normalize("", 0, &out);
+  EXPECT_EQ("", out);
+}
+
+TEST(CasefoldTest, counts_quick_checks) {
+  std::thread([]() {
+    casefold_and_normalize("lgbt");   // ASCII
+    casefold_and_normalize("ΣΟΦΙΑ");  // needs no NFKD: just folding
+    casefold_and_normalize("CAFÉ");   // needs NFKD
+  }).join();
+
+  const auto stats = casefold_thread_stats().back();
+  EXPECT_EQ(3, stats.nCalls);
+  EXPECT_EQ(2, stats.nIcuCalls);
+  EXPECT_EQ(1, stats.nQuickChecked);
+}
+
+TEST(CasefoldTest, threads_casefold_concurrently) {
+  twittok::casefold_init();
+
+  const std::vector<std::string> tokens = { "CAFÉ", "STRAßE", "Zoë", "ﬁsh", "lgbt" };
+  const std::vector<std::string> expected = { "cafe", "strasse", "zoe", "fish", "lgbt" };
+  const size_t nStatsBefore = casefold_thread_stats().size();
+
+  const size_t NThreads = 8;
+  std::vector<int> nWrong(NThreads, 0);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < NThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int run = 0; run < 2000; run++) {
+        const size_t i = (run + t) % tokens.size();
+        if (casefold_and_normalize(tokens[i]) != expected[i]) nWrong[t]++;
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  for (size_t t = 0; t < NThreads; t++) EXPECT_EQ(0, nWrong[t]) << "thread " << t;
+
+  // Stats outlive their threads
+  const auto stats = casefold_thread_stats();
+  ASSERT_EQ(nStatsBefore + NThreads, stats.size());
+  for (size_t t = nStatsBefore; t < stats.size(); t++) {
+    EXPECT_EQ(2000, stats[t].nCalls);
+    EXPECT_EQ(1600, stats[t].nIcuCalls); // every token but "lgbt"
+  }
+}
@@ -0,0 +1,50 @@
+#include "csv_structural_index.h"
+
+#include <cstdlib>
+#include <string>
+
+#include "gtest/gtest.h"
+
+using twittok::CsvStructuralIndex;
+
+TEST(CsvStructuralIndexTest, ScanBlockFindsEveryStructuralCharacter) {
+  std::srand(1);
+  const char alphabet[] = "ab,\"\n\r\x80\xff";
+
+  for (int run = 0; run < 1000; run++) {
+    char block[CsvStructuralIndex::BlockSize];
+    for (size_t i = 0; i < sizeof(block); i++) block[i] = alphabet[std::rand() % (sizeof(alphabet) - 1)];
+
+    auto result = CsvStructuralIndex::scanBlock(block);
+
+    for (size_t i = 0; i < sizeof(block); i++) {
+      EXPECT_EQ(block[i] == ',', (result.commas >> i) & 1) << "byte " << i;
+      EXPECT_EQ(block[i] == '"', (result.quotes >> i) & 1) << "byte " << i;
+      EXPECT_EQ(block[i] == '\n', (result.newlines >> i) & 1) << "byte " << i;
+    }
+  }
+}
+
+TEST(CsvStructuralIndexTest, FindCrossesBlocks) {
+  std::string input(200, 'x');
+  input[70] = '"';
+  input[150] = '\n';
+  input[199] = '"'; // in the last, partial block
+  const char* p = input.data();
+  CsvStructuralIndex index(p, p + input.size());
+
+  EXPECT_EQ(p + 70, index.findQuote(p, p + input.size()));
+  EXPECT_EQ(p + 199, index.findQuote(p + 71, p + input.size()));
+  EXPECT_EQ(p + 150, index.findNewline(p + 3, p + input.size()));
+  EXPECT_EQ(NULL, index.findNewline(p + 151, p + input.size()));
+  EXPECT_EQ(NULL, index.findComma(p, p + input.size()));
+}
+
+TEST(CsvStructuralIndexTest, FindRespectsLimit) {
+  std::string input = "abc,def";
+  const char* p = input.data();
+  CsvStructuralIndex index(p, p + input.size());
+
+  EXPECT_EQ(NULL, index.findComma(p, p + 3));
+  EXPECT_EQ(p + 3, index.findComma(p, p + 4));
+}
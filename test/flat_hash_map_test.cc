@@ -0,0 +1,149 @@
+#include "flat_hash_map.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "ngram.h"
+
+using twittok::FlatHashMap;
+using twittok::FlatHashSet;
+using twittok::NgramKey;
+using twittok::NgramKeyHash;
+
+namespace {
+
+typedef NgramKey<2> Key;
+
+/**
+ * A terrible hash, so every key collides with many others.
+ */
+struct BadHash {
+  size_t operator()(const Key& key) const { return key[0] % 4; }
+};
+
+template<typename Map>
+std::vector<Key>
+keysInOrder(const Map& map)
+{
+  std::vector<Key> ret;
+  for (const auto& entry : map) ret.push_back(entry.key);
+  return ret;
+}
+
+std::vector<Key>
+randomKeys(size_t n)
+{
+  std::srand(1);
+  std::vector<Key> ret;
+  for (size_t i = 0; i < n; i++) {
+    ret.push_back({ static_cast<uint32_t>(std::rand() % 1000), static_cast<uint32_t>(std::rand() % 1000) });
+  }
+  return ret;
+}
+
+} // namespace ""
+
+TEST(FlatHashMapTest, CountsLikeUnorderedMap) {
+  FlatHashMap<Key, size_t, NgramKeyHash> map;
+  std::unordered_map<Key, size_t, NgramKeyHash> expected;
+
+  for (const auto& key : randomKeys(100000)) {
+    map[key]++;
+    expected[key]++;
+  }
+
+  EXPECT_EQ(expected.size(), map.size());
+  for (const auto& pair : expected) {
+    const size_t* value = map.find(pair.first);
+    ASSERT_TRUE(value != NULL);
+    EXPECT_EQ(pair.second, *value);
+  }
+
+  size_t n = 0;
+  for (const auto& entry : map) {
+    EXPECT_EQ(expected[entry.key], entry.value);
+    n++;
+  }
+  EXPECT_EQ(expected.size(), n);
+}
+
+TEST(FlatHashMapTest, FindMissing) {
+  FlatHashMap<Key, size_t, NgramKeyHash> map;
+  EXPECT_TRUE(map.find({ 1, 2 }) == NULL);
+  EXPECT_FALSE(map.contains({ 1, 2 }));
+
+  map[{ 1, 2 }] = 3;
+  EXPECT_TRUE(map.find({ 2, 1 }) == NULL);
+  EXPECT_TRUE(map.contains({ 1, 2 }));
+}
+
+TEST(FlatHashMapTest, Collisions) {
+  FlatHashMap<Key, size_t, BadHash> map;
+
+  for (uint32_t i = 0; i < 1000; i++) map[{ i, i }] = i;
+
+  EXPECT_EQ(1000, map.size());
+  for (uint32_t i = 0; i < 1000; i++) {
+    ASSERT_TRUE(map.find({ i, i }) != NULL);
+    EXPECT_EQ(i, *map.find({ i, i }));
+    EXPECT_FALSE(map.contains({ i, i + 1 }));
+  }
+}
+
+TEST(FlatHashMapTest, IterationOrderIgnoresInsertionOrder) {
+  auto keys = randomKeys(5000);
+
+  FlatHashSet<Key, NgramKeyHash> forward;
+  for (const auto& key : keys) forward.insert(key);
+
+  std::reverse(keys.begin(), keys.end());
+  FlatHashSet<Key, NgramKeyHash> backward;
+  for (const auto& key : keys) backward.insert(key);
+
+  EXPECT_EQ(keysInOrder(forward), keysInOrder(backward));
+}
+
+TEST(FlatHashMapTest, IterationOrderIgnoresInsertionOrderWithCollisions) {
+  auto keys = randomKeys(500);
+
+  FlatHashSet<Key, BadHash> forward;
+  for (const auto& key : keys) forward.insert(key);
+
+  std::reverse(keys.begin(), keys.end());
+  FlatHashSet<Key, BadHash> backward;
+  for (const auto& key : keys) backward.insert(key);
+
+  EXPECT_EQ(keysInOrder(forward), keysInOrder(backward));
+}
+
+TEST(FlatHashMapTest, Reserve) {
+  FlatHashMap<Key, size_t, NgramKeyHash> map;
+  map.reserve(1000);
+  const size_t capacity = map.capacity();
+  EXPECT_LE(1000, capacity);
+
+  for (uint32_t i = 0; i < 1000; i++) map[{ i, 0 }] = i;
+  EXPECT_EQ(capacity, map.capacity());
+}
+
+TEST(FlatHashMapTest, Clear) {
+  FlatHashMap<Key, size_t, BadHash> map;
+  for (uint32_t i = 0; i < 100; i++) map[{ i, 0 }] = i + 1;
+  const size_t capacity = map.capacity();
+
+  map.clear();
+  EXPECT_EQ(0, map.size());
+  EXPECT_EQ(capacity, map.capacity());
+  EXPECT_EQ(map.end(), map.begin());
+  EXPECT_EQ(NULL, map.find({ 3, 0 }));
+
+  // Refilling gives what a fresh table would
+  for (uint32_t i = 50; i < 100; i++) map[{ i, 0 }] = i;
+  EXPECT_EQ(50, map.size());
+  EXPECT_EQ(NULL, map.find({ 3, 0 }));
+  EXPECT_EQ(70, *map.find({ 70, 0 }));
+}
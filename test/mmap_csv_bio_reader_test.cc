@@ -0,0 +1,124 @@
+#include "mmap_csv_bio_reader.h"
+
+#include <memory>
+#include <string>
+
+#include "gtest/gtest.h"
+
+class MmapCsvBioReaderTest : public testing::Test {
+protected:
+  std::string input;
+  std::unique_ptr<twittok::MmapCsvBioReader> reader; // lazily initialized
+  twittok::MmapCsvBioReader::Error error;
+
+  twittok::UntokenizedBioRef next() {
+    if (!reader) {
+      reader.reset(new twittok::MmapCsvBioReader(input.data(), input.data() + input.size()));
+    }
+
+    return reader->nextBio(&error);
+  }
+
+  bool pointsIntoInput(const twittok::UntokenizedBioRef& bio) {
+    return bio.utf8.data() >= input.data() && bio.utf8.data() + bio.utf8.size() <= input.data() + input.size();
+  }
+};
+
+#define EXPECT_ERROR(err) EXPECT_EQ(twittok::CsvBioReader::Error::err, error)
+
+TEST_F(MmapCsvBioReaderTest, ReturnsEndOfInput) {
+  input = "";
+  next();
+  EXPECT_ERROR(EndOfInput);
+}
+
+TEST_F(MmapCsvBioReaderTest, ReadsOneBio) {
+  input = "123,1,1,my bio\n";
+  auto bio = next();
+  EXPECT_ERROR(Success);
+  EXPECT_EQ(123, bio.id);
+  EXPECT_EQ(true, bio.followsClinton);
+  EXPECT_EQ(true, bio.followsTrump);
+  EXPECT_EQ("my bio", bio.utf8.to_string());
+  EXPECT_TRUE(pointsIntoInput(bio));
+}
+
+TEST_F(MmapCsvBioReaderTest, ErrorNoNewlineAfterBio) {
+  input = "123,1,1,my bio";
+  next();
+  EXPECT_ERROR(ExpectedNewline);
+}
+
+TEST_F(MmapCsvBioReaderTest, ErrorExpectedCommaInClinton) {
+  input = "123,11,1,my bio\n";
+  next();
+  EXPECT_ERROR(ExpectedComma);
+}
+
+TEST_F(MmapCsvBioReaderTest, ErrorExpectedCommaAfterId) {
+  input = "123!,1,1\n";
+  next();
+  EXPECT_ERROR(ExpectedComma);
+}
+
+TEST_F(MmapCsvBioReaderTest, ErrorUnterminatedQuote) {
+  input = "1,1,1,\"foo\n";
+  next();
+  EXPECT_ERROR(ExpectedEndQuote);
+}
+
+TEST_F(MmapCsvBioReaderTest, EmptyBio) {
+  input = "123,1,1,\n";
+  auto bio = next();
+  EXPECT_ERROR(Success);
+  EXPECT_EQ(123, bio.id);
+  EXPECT_EQ("", bio.utf8.to_string());
+}
+
+TEST_F(MmapCsvBioReaderTest, QuotedNewlineIsZeroCopy) {
+  input = "1,1,1,\"foo\nbar\"\n";
+  auto bio = next();
+  EXPECT_ERROR(Success);
+  EXPECT_EQ("foo\nbar", bio.utf8.to_string());
+  EXPECT_TRUE(pointsIntoInput(bio));
+}
+
+TEST_F(MmapCsvBioReaderTest, DoubleQuotesAreUnescaped) {
+  input = "1,1,1,\"foo\"\"bar\"\"\"\n";
+  auto bio = next();
+  EXPECT_ERROR(Success);
+  EXPECT_EQ("foo\"bar\"", bio.utf8.to_string());
+  EXPECT_FALSE(pointsIntoInput(bio));
+}
+
+TEST_F(MmapCsvBioReaderTest, MaxLengthBio) {
+  std::string utf8(twittok::UntokenizedBio::MaxBioBytes, 'x');
+  input = "1,0,1," + utf8 + "\n2,0,1,\"" + utf8 + "\"\n";
+  EXPECT_EQ(utf8, next().utf8.to_string());
+  EXPECT_ERROR(Success);
+  EXPECT_EQ(utf8, next().utf8.to_string());
+  EXPECT_ERROR(Success);
+}
+
+TEST_F(MmapCsvBioReaderTest, ErrorBioTooLong) {
+  input = "1,0,1," + std::string(twittok::UntokenizedBio::MaxBioBytes + 1, 'x') + "\n";
+  next();
+  EXPECT_ERROR(ExpectedNewline);
+}
+
+TEST_F(MmapCsvBioReaderTest, TwoBios) {
+  input = "1,1,0,foo\n2,0,1,\"b\"\"ar\"\n";
+  auto bio1 = next();
+  EXPECT_ERROR(Success);
+  auto bio2 = next();
+  EXPECT_ERROR(Success);
+  EXPECT_EQ(0, next().id);
+  EXPECT_ERROR(EndOfInput);
+
+  // Earlier bios stay valid after we read later ones
+  EXPECT_EQ("foo", bio1.utf8.to_string());
+  EXPECT_EQ(true, bio1.followsClinton);
+  EXPECT_EQ(false, bio1.followsTrump);
+  EXPECT_EQ("b\"ar", bio2.utf8.to_string());
+  EXPECT_EQ(2, bio2.id);
+}
@@ -0,0 +1,196 @@
+#include "ngram_index.h"
+
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "bio_store.h"
+#include "ngram_pass.h"
+
+using meta::util::string_view;
+using twittok::BioStore;
+using twittok::NgramIndex;
+using twittok::NgramIndexBuilder;
+using twittok::NgramInfo;
+using twittok::NgramPass;
+using twittok::ResultsBlock;
+using twittok::ResultsFormat;
+using twittok::Tokenizer;
+using twittok::UntokenizedBioRef;
+using twittok::Vocabulary;
+
+class NgramIndexTest : public ::testing::Test {
+protected:
+  NgramIndexTest() : store(vocabulary) {
+    const char* texts[] = {
+      "Proud mom and wife",
+      "proud MOM, wife",
+      "Wife. Mom. Proud American.",
+      "American patriot, proud mom",
+      "Mom of 3 | wife | patriot",
+      "proud mom proud mom",
+    };
+
+    for (size_t i = 0; i < 300; i++) {
+      const char* text = texts[i % (sizeof(texts) / sizeof(texts[0]))];
+      store.add(UntokenizedBioRef(i + 1, i % 2 == 0, i % 3 == 0, text), tokenizer);
+    }
+
+    NgramIndexBuilder builder;
+    for (const auto& block : dump()) builder.addBlock(block);
+
+    std::ostringstream os;
+    builder.write(os);
+    const std::string bytes = os.str();
+    nBytes = bytes.size();
+    aligned.resize((nBytes + 7) / 8); // NgramIndex reads uint64_ts in place
+    memcpy(aligned.data(), bytes.data(), nBytes);
+  }
+
+  /**
+   * Returns what twittok --format=binary writes for passes 1 and 2.
+   */
+  std::vector<ResultsBlock> dump() {
+    std::stringstream ss;
+
+    NgramPass<1> pass1((NgramPass<1>::PrefixSet()));
+    pass1.scanBios(store);
+    pass1.dump(ss, vocabulary, 10, 1, ResultsFormat::Binary);
+
+    NgramPass<2> pass2(pass1.ngramKeys(10));
+    pass2.scanBios(store);
+    pass2.dump(ss, vocabulary, 10, 1, ResultsFormat::Binary);
+
+    std::vector<ResultsBlock> blocks(1);
+    while (blocks.back().read(ss)) blocks.emplace_back();
+    blocks.pop_back();
+    return blocks;
+  }
+
+  inline const char* data() const { return reinterpret_cast<const char*>(aligned.data()); }
+
+  Tokenizer tokenizer;
+  Vocabulary vocabulary;
+  BioStore store;
+  std::vector<uint64_t> aligned;
+  size_t nBytes;
+};
+
+TEST_F(NgramIndexTest, finds_every_ngram) {
+  const NgramIndex index(data(), nBytes);
+
+  size_t nRecords = 0;
+  for (const auto& block : dump()) {
+    nRecords += block.size();
+
+    std::string key;
+    NgramIndex::Record record;
+    for (size_t i = 0; i < block.size(); i++) {
+      const uint64_t j = block.spellingBegin[i];
+      const string_view spelling(block.strings.data() + block.stringBegin[j], block.stringBegin[j + 1] - block.stringBegin[j]);
+      ASSERT_TRUE(index.findPhrase(tokenizer, spelling, &key, &record)) << spelling;
+      EXPECT_EQ(string_view(block.keys.data() + block.keyBegin[i], block.keyBegin[i + 1] - block.keyBegin[i]), record.key());
+      EXPECT_EQ(block.n[i], record.n());
+      EXPECT_EQ(block.nClinton[i], record.nClinton());
+      EXPECT_EQ(block.nTrump[i], record.nTrump());
+      EXPECT_EQ(block.nBoth[i], record.nBoth());
+      EXPECT_EQ(block.nVariants[i], record.nVariants());
+      EXPECT_EQ(spelling, record.spelling(0));
+      EXPECT_EQ(block.spellingN[j], record.spellingN(0));
+    }
+  }
+
+  EXPECT_EQ(nRecords, index.size());
+}
+
+TEST_F(NgramIndexTest, finds_phrase_by_stems) {
+  const NgramIndex index(data(), nBytes);
+
+  std::string key;
+  NgramIndex::Record record;
+  ASSERT_TRUE(index.findPhrase(tokenizer, "PROUD moms", &key, &record));
+  EXPECT_EQ("proud mom", key);
+  EXPECT_EQ(100, record.n());
+  ASSERT_EQ(1, record.nSpellings());
+  EXPECT_EQ("proud mom", record.spelling(0)); // "Proud mom" and "proud MOM" fold into it
+  EXPECT_EQ(200, record.spellingN(0));
+}
+
+TEST_F(NgramIndexTest, misses_strangers) {
+  const NgramIndex index(data(), nBytes);
+
+  std::string key;
+  NgramIndex::Record record;
+  EXPECT_FALSE(index.findPhrase(tokenizer, "proud dad", &key, &record));
+  EXPECT_FALSE(index.findPhrase(tokenizer, "wife proud", &key, &record));
+  EXPECT_FALSE(index.findPhrase(tokenizer, "", &key, &record));
+  EXPECT_FALSE(index.find("proud mom ", &record));
+}
+
+TEST_F(NgramIndexTest, empty_index) {
+  std::ostringstream os;
+  NgramIndexBuilder().write(os);
+  const std::string bytes = os.str();
+  std::vector<uint64_t> empty((bytes.size() + 7) / 8);
+  memcpy(empty.data(), bytes.data(), bytes.size());
+
+  const NgramIndex index(reinterpret_cast<const char*>(empty.data()), bytes.size());
+  NgramIndex::Record record;
+  EXPECT_EQ(0, index.size());
+  EXPECT_FALSE(index.find("mom", &record));
+}
+
+TEST_F(NgramIndexTest, indexes_by_stored_key) {
+  // We never re-stem spellings: a record is found by the key dump() gave it
+  ResultsBlock block(2);
+  NgramInfo info = NgramInfo();
+  info.nClinton = 10;
+  block.addRecord(info, "proud mom", 9);
+  block.addSpelling("the", 3, 10); // a stopword: it has no stems
+
+  NgramIndexBuilder builder;
+  builder.addBlock(block);
+  std::ostringstream os;
+  builder.write(os);
+  const std::string bytes = os.str();
+  std::vector<uint64_t> indexData((bytes.size() + 7) / 8);
+  memcpy(indexData.data(), bytes.data(), bytes.size());
+
+  const NgramIndex index(reinterpret_cast<const char*>(indexData.data()), bytes.size());
+  NgramIndex::Record record;
+  ASSERT_TRUE(index.find("proud mom", &record));
+  EXPECT_EQ(10, record.nClinton());
+  EXPECT_EQ("the", record.spelling(0));
+
+  EXPECT_THROW(builder.addBlock(block), std::runtime_error); // "proud mom" twice
+}
+
+TEST_F(NgramIndexTest, rejects_bad_input) {
+  EXPECT_THROW(NgramIndex(data(), nBytes - 8), std::runtime_error);
+
+  std::vector<uint64_t> corrupt(aligned);
+  reinterpret_cast<char*>(corrupt.data())[0] = 'x';
+  EXPECT_THROW(NgramIndex(reinterpret_cast<const char*>(corrupt.data()), nBytes), std::runtime_error);
+
+  // Sizes whose sum overflows: nKeys, then nSpellings
+  for (const size_t field : { 2, 3 }) {
+    for (const uint64_t size : { UINT64_MAX, UINT64_MAX / 8, UINT64_MAX / 8 * 7 }) {
+      std::vector<uint64_t> huge(aligned);
+      huge[field] = size;
+      EXPECT_THROW(NgramIndex(reinterpret_cast<const char*>(huge.data()), nBytes), std::runtime_error) << field << ": " << size;
+    }
+  }
+
+  // An offset in the middle of keyBegin, past the end of the keys
+  const uint64_t nKeys = aligned[2];
+  ASSERT_LT(1, nKeys);
+  const size_t keyBegin = 6 + (twittok::PerfectHash::nBucketsFor(nKeys) * sizeof(uint32_t) + 7) / 8;
+  std::vector<uint64_t> badOffset(aligned);
+  badOffset[keyBegin + 1] = UINT64_MAX / 2;
+  EXPECT_THROW(NgramIndex(reinterpret_cast<const char*>(badOffset.data()), nBytes), std::runtime_error);
+}
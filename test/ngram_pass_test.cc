@@ -0,0 +1,184 @@
+#include "ngram_pass.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using twittok::BioStore;
+using twittok::NgramPass;
+using twittok::Tokenizer;
+using twittok::UntokenizedBioRef;
+using twittok::Vocabulary;
+
+class NgramPassTest : public ::testing::Test {
+protected:
+  NgramPassTest() : store(vocabulary) {
+    const char* texts[] = {
+      "Proud mom and wife",
+      "proud MOM, wife",
+      "Wife. Mom. Proud American.",
+      "American patriot, proud mom",
+      "Mom of 3 | wife | patriot",
+      "proud mom proud mom",
+    };
+
+    for (size_t i = 0; i < 300; i++) {
+      const char* text = texts[i % (sizeof(texts) / sizeof(texts[0]))];
+      store.add(UntokenizedBioRef(i + 1, i % 2 == 0, i % 3 == 0, text), tokenizer);
+    }
+  }
+
+  template<size_t N>
+  std::string dump(const typename NgramPass<N>::PrefixSet& prefixes, size_t nThreads) {
+    NgramPass<N> pass(prefixes);
+    pass.scanBios(store, nThreads);
+    std::ostringstream os;
+    pass.dump(os, vocabulary, 10);
+    return os.str();
+  }
+
+  Tokenizer tokenizer;
+  Vocabulary vocabulary;
+  BioStore store;
+};
+
+TEST_F(NgramPassTest, counts) {
+  NgramPass<1> pass((NgramPass<1>::PrefixSet()));
+  pass.scanBios(store);
+
+  const auto* wife = pass.gramToInfo.find({ vocabulary.intern("wife") });
+  ASSERT_TRUE(wife != NULL);
+  // Bios 0, 2 and 4 (mod 6) mention a wife and follow somebody
+  EXPECT_EQ(150, wife->nTotal());
+  EXPECT_EQ(150, wife->nClinton);
+  EXPECT_EQ(50, wife->nTrump);
+  EXPECT_EQ(50, wife->nBoth);
+  EXPECT_EQ(2, wife->nVariants()); // "wife" and "Wife"
+}
+
+TEST_F(NgramPassTest, parallel_scan_is_identical_to_serial_scan) {
+  NgramPass<1> pass1((NgramPass<1>::PrefixSet()));
+  pass1.scanBios(store);
+  const auto prefixes = pass1.ngramKeys(10);
+
+  const std::string serial1 = dump<1>(NgramPass<1>::PrefixSet(), 1);
+  const std::string serial2 = dump<2>(prefixes, 1);
+  ASSERT_NE("", serial1);
+  ASSERT_NE("", serial2);
+
+  for (size_t nThreads = 2; nThreads <= 7; nThreads++) {
+    EXPECT_EQ(serial1, dump<1>(NgramPass<1>::PrefixSet(), nThreads)) << nThreads << " threads";
+    EXPECT_EQ(serial2, dump<2>(prefixes, nThreads)) << nThreads << " threads";
+  }
+}
+
+TEST_F(NgramPassTest, dump_folds_variants) {
+  // Spellings of the stem "run": "running" folds with "RUNNING" and
+  // "Running" into one variant, and "runs" into another
+  const struct { const char* text; size_t n; } spellings[] = {
+    { "Running", 8 },
+    { "running", 8 },
+    { "RUNNING", 3 },
+    { "runs", 6 },
+    { "Mom", 12 },
+    { "mom", 12 },
+  };
+
+  Vocabulary runVocabulary;
+  BioStore runStore(runVocabulary);
+  uint64_t id = 1;
+  for (const auto& spelling : spellings) {
+    for (size_t i = 0; i < spelling.n; i++) {
+      runStore.add(UntokenizedBioRef(id++, true, false, spelling.text), tokenizer);
+    }
+  }
+
+  NgramPass<1> pass((NgramPass<1>::PrefixSet()));
+  pass.scanBios(runStore);
+  std::ostringstream os;
+  pass.dump(os, runStore.vocabulary(), 10);
+  const std::string dumped = os.str();
+
+  // "runs" is too rare to write; "running" and "Running" tie, and "Running"
+  // sorts first. "Mom" and "mom" tie, too.
+  EXPECT_NE(std::string::npos, dumped.find("25\t0\t0\t4\nRunning\n")) << dumped;
+  EXPECT_EQ(std::string::npos, dumped.find("\nrunning")) << dumped;
+  EXPECT_NE(std::string::npos, dumped.find("24\t0\t0\t2\nMom\n")) << dumped;
+  EXPECT_EQ(std::string::npos, dumped.find("runs")) << dumped;
+}
+
+TEST(NgramPassDumpTest, dump_ignores_token_ids) {
+  // Intern the words in opposite orders, so ties would sort differently by id
+  const std::vector<std::string> words = { "proud", "mom", "wife", "american", "patriot", "3" };
+  Vocabulary vocabulary;
+  Vocabulary reversedVocabulary;
+  for (size_t i = 0; i < words.size(); i++) {
+    vocabulary.intern(words[i]);
+    reversedVocabulary.intern(words[words.size() - 1 - i]);
+  }
+  ASSERT_NE(vocabulary.intern("mom"), reversedVocabulary.intern("mom"));
+
+  // "mom" and "wife" tie; so do "american" and "patriot"
+  const char* texts[] = { "Proud mom and wife", "American patriot", "Mom of 3, wife" };
+  Tokenizer tokenizer;
+  BioStore store(vocabulary);
+  BioStore reversedStore(reversedVocabulary);
+  for (size_t i = 0; i < 300; i++) {
+    const UntokenizedBioRef bio(i + 1, i % 2 == 0, i % 3 == 0, texts[i % 3]);
+    store.add(bio, tokenizer);
+    reversedStore.add(bio, tokenizer);
+  }
+
+  NgramPass<1> pass((NgramPass<1>::PrefixSet()));
+  pass.scanBios(store);
+  std::ostringstream os;
+  pass.dump(os, vocabulary, 10);
+
+  NgramPass<1> reversedPass((NgramPass<1>::PrefixSet()));
+  reversedPass.scanBios(reversedStore);
+  std::ostringstream reversedOs;
+  reversedPass.dump(reversedOs, reversedVocabulary, 10);
+
+  EXPECT_EQ(os.str(), reversedOs.str());
+}
+
+TEST_F(NgramPassTest, parallel_dump_is_sorted_and_identical_to_serial_dump) {
+  // Enough distinct words to make several chunks, with assorted counts
+  Vocabulary wordVocabulary;
+  BioStore wordStore(wordVocabulary);
+  for (size_t i = 0; i < 3000; i++) {
+    const std::string text = "w" + std::to_string(i % 700) + " w" + std::to_string(i * i % 600);
+    wordStore.add(UntokenizedBioRef(i + 1, i % 2 == 0, i % 3 == 0, text), tokenizer);
+  }
+
+  NgramPass<1> pass((NgramPass<1>::PrefixSet()));
+  pass.scanBios(wordStore);
+
+  std::ostringstream serial;
+  pass.dump(serial, wordVocabulary, 1);
+
+  // Headers are "nClinton\tnTrump\tnBoth\tnVariants": most bios first
+  std::istringstream lines(serial.str());
+  std::string line;
+  size_t nNgrams = 0;
+  size_t lastTotal = SIZE_MAX;
+  while (std::getline(lines, line)) {
+    size_t nClinton, nTrump, nBoth, nVariants;
+    if (sscanf(line.c_str(), "%zu\t%zu\t%zu\t%zu", &nClinton, &nTrump, &nBoth, &nVariants) != 4) continue;
+    const size_t total = nClinton + nTrump - nBoth;
+    EXPECT_LE(total, lastTotal) << "ngram " << nNgrams;
+    lastTotal = total;
+    nNgrams++;
+  }
+  ASSERT_GT(nNgrams, 600);
+
+  for (size_t nThreads = 2; nThreads <= 7; nThreads++) {
+    std::ostringstream parallel;
+    pass.dump(parallel, wordVocabulary, 1, nThreads);
+    EXPECT_EQ(serial.str(), parallel.str()) << nThreads << " threads";
+  }
+}
@@ -0,0 +1,133 @@
+#include "ngram_query.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using twittok::NgramIndex;
+using twittok::NgramIndexBuilder;
+using twittok::NgramInfo;
+using twittok::NgramQueryEngine;
+using twittok::ResultsBlock;
+
+namespace {
+
+void
+addRecord(ResultsBlock* block, const std::string& key, size_t nClinton, size_t nTrump, size_t nBoth, const std::vector<std::pair<std::string, uint64_t> >& spellings)
+{
+  NgramInfo info = NgramInfo();
+  info.nClinton = nClinton;
+  info.nTrump = nTrump;
+  info.nBoth = nBoth;
+  block->addRecord(info, key.data(), key.size());
+  for (const auto& spelling : spellings) block->addSpelling(spelling.first.data(), spelling.first.size(), spelling.second);
+}
+
+} // namespace ""
+
+class NgramQueryTest : public ::testing::Test {
+protected:
+  NgramQueryTest() {
+    ResultsBlock unigrams(1);
+    addRecord(&unigrams, "mom", 300, 200, 100, { { "mom", 300 }, { "Mom", 100 } });
+    addRecord(&unigrams, "wife", 100, 400, 50, { { "wife", 450 } });
+    addRecord(&unigrams, "#imwithher", 500, 1, 0, { { "#ImWithHer", 501 } });
+    addRecord(&unigrams, "#maga", 2, 800, 1, { { "#MAGA", 801 } });
+
+    ResultsBlock bigrams(2);
+    addRecord(&bigrams, "proud mom", 150, 150, 100, { { "proud\tmom", 130 }, { "Proud mom", 120 } });
+
+    NgramIndexBuilder builder;
+    builder.addBlock(unigrams);
+    builder.addBlock(bigrams);
+
+    std::ostringstream os;
+    builder.write(os);
+    const std::string bytes = os.str();
+    aligned.resize((bytes.size() + 7) / 8); // NgramIndex reads uint64_ts in place
+    memcpy(aligned.data(), bytes.data(), bytes.size());
+
+    index.reset(new NgramIndex(reinterpret_cast<const char*>(aligned.data()), bytes.size()));
+    engine.reset(new NgramQueryEngine(*index));
+  }
+
+  std::string answer(const std::string& request) {
+    std::string response;
+    engine->answer(request, &context, &response);
+    return response;
+  }
+
+  std::vector<uint64_t> aligned;
+  std::unique_ptr<NgramIndex> index;
+  std::unique_ptr<NgramQueryEngine> engine;
+  NgramQueryEngine::Context context;
+};
+
+TEST_F(NgramQueryTest, lookup) {
+  EXPECT_EQ(
+    "ok\n"
+    "proud mom\t200\t150\t150\t100\t0\tProud mom\n" // "proud\tmom" won't fit on a line
+    "mom\t400\t300\t200\t100\t0\tmom\n"
+    "proud dad\t0\t0\t0\t0\t0\t\n",
+    answer("lookup\nPROUD moms\nMoms\nproud dad\n")
+  );
+
+  // Again, with stems the Context has cached
+  EXPECT_EQ("ok\nmom\t400\t300\t200\t100\t0\tmom\n", answer("lookup\nmom"));
+  EXPECT_EQ("ok\n", answer("lookup\n"));
+}
+
+TEST_F(NgramQueryTest, forgets_stems_past_bound) {
+  // Many more distinct words than the Context will hold on to
+  const size_t NWords = 100000;
+  std::string request("lookup\n");
+  for (size_t i = 0; i < NWords; i++) request += "word" + std::to_string(i) + "\n";
+  const std::string response = answer(request);
+  EXPECT_EQ(NWords + 1, std::count(response.begin(), response.end(), '\n'));
+
+  EXPECT_LT(context.stems.size(), NWords);
+  EXPECT_LE(context.nStemBytes, NgramQueryEngine::MaxStemBytes + 1024); // one stem past the bound, at most
+
+  EXPECT_EQ("ok\nmom\t400\t300\t200\t100\t0\tmom\n", answer("lookup\nMoms"));
+}
+
+TEST_F(NgramQueryTest, top) {
+  EXPECT_EQ(
+    "ok\n"
+    "#imwithher\t501\t500\t1\t0\t0\t#ImWithHer\n"
+    "mom\t400\t300\t200\t100\t0\tmom\n",
+    answer("top clinton 2")
+  );
+  EXPECT_EQ(
+    "ok\n"
+    "#maga\t801\t2\t800\t1\t0\t#MAGA\n"
+    "wife\t450\t100\t400\t50\t0\twife\n",
+    answer("top trump 2\n")
+  );
+
+  const std::string all = answer("top clinton 1000");
+  EXPECT_EQ(6, std::count(all.begin(), all.end(), '\n'));
+  EXPECT_EQ("ok\n", answer("top trump 0"));
+}
+
+TEST_F(NgramQueryTest, skew) {
+  NgramIndex::Record record;
+  ASSERT_TRUE(index->find("proud mom", &record));
+  EXPECT_DOUBLE_EQ(0.0, NgramQueryEngine::skew(record));
+  ASSERT_TRUE(index->find("#imwithher", &record));
+  EXPECT_DOUBLE_EQ(std::log2(501.0 / 2.0), NgramQueryEngine::skew(record));
+}
+
+TEST_F(NgramQueryTest, errors) {
+  for (const char* request : { "", "frobnicate", "lookup mom", "top", "top left 3", "top clinton", "top clinton -1", "top clinton 3 4", "top clinton 3\nmom" }) {
+    EXPECT_EQ(0, answer(request).compare(0, 6, "error\t")) << request;
+  }
+}
@@ -0,0 +1,89 @@
+#include "parallel_csv_bio_reader.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+class ParallelCsvBioReaderTest : public testing::Test {
+protected:
+  std::string input;
+
+  /**
+   * Asserts that with every number of threads, we read what
+   * MmapCsvBioReader reads.
+   */
+  void expectSameAsSerial() {
+    const char* begin = input.data();
+    const char* end = input.data() + input.size();
+
+    twittok::MmapCsvBioReader serial(begin, end);
+    std::vector<twittok::UntokenizedBioRef> expected;
+    twittok::CsvBioReader::Error expectedError;
+    while (true) {
+      auto bio = serial.nextBio(&expectedError);
+      if (expectedError != twittok::CsvBioReader::Error::Success) break;
+      expected.push_back(bio);
+    }
+    if (expectedError == twittok::CsvBioReader::Error::EndOfInput) {
+      expectedError = twittok::CsvBioReader::Error::Success;
+    }
+
+    for (size_t nThreads = 1; nThreads <= 12; nThreads++) {
+      twittok::ParallelCsvBioReader reader(begin, end, nThreads, 1);
+      twittok::CsvBioReader::Error error;
+      auto bios = reader.readAllBios(&error);
+
+      EXPECT_EQ(expectedError, error) << "with " << nThreads << " threads";
+      ASSERT_EQ(expected.size(), bios.size()) << "with " << nThreads << " threads";
+      for (size_t i = 0; i < bios.size(); i++) {
+        EXPECT_EQ(expected[i].id, bios[i].id);
+        EXPECT_EQ(expected[i].followsClinton, bios[i].followsClinton);
+        EXPECT_EQ(expected[i].followsTrump, bios[i].followsTrump);
+        EXPECT_EQ(expected[i].utf8.to_string(), bios[i].utf8.to_string());
+      }
+    }
+  }
+};
+
+TEST_F(ParallelCsvBioReaderTest, Empty) {
+  input = "";
+  expectSameAsSerial();
+}
+
+TEST_F(ParallelCsvBioReaderTest, SimpleBios) {
+  input = "1,1,0,foo\n2,0,1,bar\n3,1,1,\n4,0,0,baz\n5,1,0,a longer bio\n";
+  expectSameAsSerial();
+}
+
+TEST_F(ParallelCsvBioReaderTest, QuotedBiosThatLookLikeRecords) {
+  input =
+    "1,1,0,\"foo\n2,0,1,not a record\n3,1,1,nor this\"\n"
+    "4,0,1,\"\"\"quoted\"\"\n5,0,0,\"\"\"\"\n"
+    "6,1,1,\"\n\n\n\"\n"
+    "7,0,0,last\n";
+  expectSameAsSerial();
+}
+
+TEST_F(ParallelCsvBioReaderTest, StopsAtFirstError) {
+  input = "1,1,0,foo\n2,0,1,bar\n3,2,1,error\n4,1,1,ok\n5,1,1,ok\n";
+  expectSameAsSerial();
+}
+
+TEST_F(ParallelCsvBioReaderTest, StopsAtErrorInsideQuotes) {
+  input = "1,1,0,foo\n2,0,1,\"bar\n3,2,1,baz\"x\n4,1,1,ok\n5,1,1,ok\n";
+  expectSameAsSerial();
+}
+
+TEST_F(ParallelCsvBioReaderTest, ManyBios) {
+  for (int i = 1; i < 500; i++) {
+    input += std::to_string(i) + "," + std::to_string(i % 2) + "," + std::to_string(i % 3 == 0);
+    switch (i % 4) {
+      case 0: input += ",simple bio\n"; break;
+      case 1: input += ",\"quoted\n" + std::to_string(i + 1) + ",1,1,bio\"\n"; break;
+      case 2: input += ",\"escaped \"\" quote\"\n"; break;
+      case 3: input += ",\n"; break;
+    }
+  }
+  expectSameAsSerial();
+}
@@ -0,0 +1,56 @@
+#include "perfect_hash.h"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using meta::util::string_view;
+using twittok::PerfectHash;
+
+namespace {
+
+/**
+ * Builds a perfect hash for keys and returns each key's slot.
+ */
+std::vector<uint64_t>
+slots(const std::vector<std::string>& keys)
+{
+  const std::vector<string_view> views(keys.begin(), keys.end());
+  uint64_t seed;
+  std::vector<uint32_t> displacements;
+  PerfectHash::build(views, &seed, &displacements);
+  EXPECT_EQ(PerfectHash::nBucketsFor(keys.size()), displacements.size());
+
+  const PerfectHash hash(seed, keys.size(), displacements.data());
+  std::vector<uint64_t> ret;
+  for (const auto& key : keys) ret.push_back(hash(key.data(), key.size()));
+  return ret;
+}
+
+} // namespace ""
+
+TEST(PerfectHashTest, no_keys) {
+  EXPECT_EQ(std::vector<uint64_t>(), slots({}));
+}
+
+TEST(PerfectHashTest, one_key) {
+  EXPECT_EQ(std::vector<uint64_t>({ 0 }), slots({ "proud mom" }));
+}
+
+TEST(PerfectHashTest, each_key_gets_its_own_slot) {
+  std::vector<std::string> keys;
+  for (size_t i = 0; i < 10000; i++) keys.push_back("key " + std::to_string(i));
+
+  std::vector<bool> taken(keys.size(), false);
+  for (const uint64_t slot : slots(keys)) {
+    ASSERT_LT(slot, keys.size());
+    ASSERT_FALSE(taken[slot]) << slot;
+    taken[slot] = true;
+  }
+}
+
+TEST(PerfectHashTest, duplicate_keys_throw) {
+  EXPECT_THROW(slots({ "mom", "wife", "mom" }), std::runtime_error);
+}
@@ -0,0 +1,98 @@
+#include "porter2_buffer_stemmer.h"
+
+#include <cstdlib>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "porter2_stemmer.h"
+
+using twittok::porter2::Buffer;
+
+namespace {
+
+std::string
+stem(const std::string& word)
+{
+  Buffer buffer;
+  return twittok::porter2::stem(word.data(), word.size(), &buffer).to_string();
+}
+
+std::string
+referenceStem(const std::string& word)
+{
+  std::string ret(word);
+  Porter2Stemmer::stem(ret);
+  return ret;
+}
+
+} // namespace
+
+TEST(Porter2BufferStemmerTest, examples) {
+  EXPECT_EQ("consist", stem("consisting"));
+  EXPECT_EQ("knackeri", stem("knackeries"));
+  EXPECT_EQ("generous", stem("generously"));
+  EXPECT_EQ("sky", stem("skies"));
+  EXPECT_EQ("news", stem("news"));
+  EXPECT_EQ("succeed", stem("succeeded"));
+  EXPECT_EQ("hope", stem("hoping"));
+  EXPECT_EQ("dog", stem("dog's"));
+  EXPECT_EQ("ab", stem("ab"));
+}
+
+TEST(Porter2BufferStemmerTest, truncates_like_reference) {
+  const std::string word("pneumonoultramicroscopicsilicovolcanoconiosis");
+  EXPECT_EQ(referenceStem(word), stem(word));
+}
+
+TEST(Porter2BufferStemmerTest, matches_reference) {
+  const char* words[] = {
+    "a", "is", "the", "caresses", "ponies", "ties", "cries", "gas", "gaps", "kiwis", "this",
+    "feed", "agreed", "disabled", "matting", "mating", "meeting", "milling", "messing",
+    "meetings", "happy", "sky", "cry", "by", "say", "relational", "conditional", "rational",
+    "valenci", "hesitanci", "digitizer", "conformabli", "radicalli", "differentli", "vileli",
+    "analogousli", "vietnamization", "predication", "operator", "feudalism", "decisiveness",
+    "hopefulness", "callousness", "formaliti", "sensitiviti", "sensibiliti", "triplicate",
+    "formative", "formalize", "electriciti", "electrical", "hopeful", "goodness", "revival",
+    "allowance", "inference", "airliner", "gyroscopic", "adjustable", "defensible",
+    "irritant", "replacement", "adjustment", "dependent", "adoption", "homologou",
+    "communism", "activate", "angulariti", "homologous", "effective", "bowdlerize",
+    "probate", "rate", "cease", "controll", "roll", "generate", "generously", "community",
+    "communication", "arsenal", "arsenic", "yelling", "yesterday", "playing", "obeying",
+    "enjoyed", "dying", "lying", "tying", "idly", "gently", "ugly", "early", "only", "singly",
+    "inning", "innings", "outings", "canning", "herring", "earrings", "proceed", "exceed",
+    "succeed", "skis", "atlas", "cosmos", "bias", "andes", "howe", "news", "<s>", "</s>",
+    "'tis", "dogs'", "dog's", "dog's'", "geology", "archaeology", "fluently", "luxuriating",
+    "hopping", "hopped", "filing", "trumpsters", "hillary", "clinton", "lovingly", "mothers",
+    "grandmother", "entrepreneurial", "conservatives", "progressive", "journalism",
+    "photographer", "musicians", "christians", "patriotic", "deplorables", "nationalists"
+  };
+
+  for (const char* word : words) {
+    EXPECT_EQ(referenceStem(word), stem(word)) << word;
+  }
+}
+
+TEST(Porter2BufferStemmerTest, matches_reference_on_random_words) {
+  // Random stems with real suffixes stacked on, so every step has work to do
+  const char* suffixes[] = {
+    "s", "es", "ies", "ied", "sses", "ed", "edly", "eed", "eedly", "ing", "ingly", "y", "ly",
+    "ational", "tional", "enci", "anci", "abli", "entli", "izer", "ization", "ation", "ator",
+    "alism", "aliti", "alli", "fulness", "ousli", "ousness", "iveness", "iviti", "biliti",
+    "bli", "fulli", "lessli", "logi", "li", "alize", "icate", "iciti", "ical", "ful", "ness",
+    "ative", "al", "ance", "ence", "er", "ic", "able", "ible", "ant", "ement", "ment", "ent",
+    "ism", "ate", "iti", "ous", "ive", "ize", "sion", "tion", "e", "l", "ll", "at", "bl", "iz"
+  };
+  const size_t nSuffixes = sizeof(suffixes) / sizeof(suffixes[0]);
+  const char letters[] = "aaabcdeeefghiiijklmnooopqrstuuuvwxyyz";
+
+  std::srand(3);
+  for (int run = 0; run < 200000; run++) {
+    std::string word(1 + std::rand() % 8, ' ');
+    for (auto& c : word) c = letters[std::rand() % (sizeof(letters) - 1)];
+    const int nSuffixesToAdd = std::rand() % 3;
+    for (int i = 0; i < nSuffixesToAdd; i++) word += suffixes[std::rand() % nSuffixes];
+
+    ASSERT_EQ(referenceStem(word), stem(word)) << word;
+  }
+}
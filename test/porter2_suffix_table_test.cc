@@ -0,0 +1,83 @@
+#include "porter2_suffix_table.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "gtest/gtest.h"
+
+using twittok::porter2::SuffixRule;
+using twittok::porter2::SuffixTable;
+
+namespace {
+
+/**
+ * Returns what Porter2Stemmer would: the first rule, in order, that ends
+ * the word at or after start.
+ */
+template<size_t NRules>
+const SuffixRule*
+findLinear(const SuffixRule (&rules)[NRules], const std::string& word, size_t start)
+{
+  for (const auto& rule : rules) {
+    if (rule.size > word.size() || word.size() - rule.size < start) continue;
+    if (memcmp(word.data() + word.size() - rule.size, rule.suffix, rule.size) == 0) return &rule;
+  }
+  return NULL;
+}
+
+template<size_t NRules>
+void
+expectSameAsLinear(const SuffixRule (&rules)[NRules], const SuffixTable<NRules>& table, const std::string& word, size_t start)
+{
+  const SuffixRule* expected = findLinear(rules, word, start);
+  const SuffixRule* actual = table.find(word.data(), word.size(), start);
+
+  if (expected == NULL) {
+    EXPECT_EQ(NULL, actual) << word << " from " << start;
+  } else {
+    ASSERT_NE(nullptr, actual) << word << " from " << start;
+    EXPECT_STREQ(expected->suffix, actual->suffix) << word << " from " << start;
+  }
+}
+
+} // namespace
+
+TEST(Porter2SuffixTableTest, find) {
+  const auto& table(twittok::porter2::Step2Table);
+
+  EXPECT_STREQ("ational", table.find("relational", 10, 0)->suffix);
+  EXPECT_STREQ("tional", table.find("relational", 10, 4)->suffix); // "ational" starts too early
+  EXPECT_EQ(NULL, table.find("relational", 10, 5));
+  EXPECT_EQ(NULL, table.find("dog", 3, 0));
+  EXPECT_EQ(NULL, table.find("i", 1, 0));
+  EXPECT_EQ(NULL, table.find("dog's", 5, 0));
+}
+
+TEST(Porter2SuffixTableTest, keeps_rule_order_within_bucket) {
+  // "bli" and "abli" are both in the "li" bucket, and "abli" comes first
+  EXPECT_STREQ("abli", twittok::porter2::Step2Table.find("conformabli", 11, 0)->suffix);
+  EXPECT_STREQ("bli", twittok::porter2::Step2Table.find("conformabli", 11, 8)->suffix);
+}
+
+TEST(Porter2SuffixTableTest, matches_linear_search) {
+  const char* endings[] = {
+    "ational", "tional", "enci", "anci", "abli", "entli", "izer", "ization", "ation", "ator",
+    "alism", "aliti", "alli", "fulness", "ousli", "ousness", "iveness", "iviti", "biliti", "bli",
+    "fulli", "lessli", "alize", "icate", "iciti", "ical", "ful", "ness", "al", "ance", "ence",
+    "er", "ic", "able", "ible", "ant", "ement", "ment", "ism", "ate", "iti", "ous", "ive", "ize",
+    "li", "i", "s", "Y", "'"
+  };
+  const size_t nEndings = sizeof(endings) / sizeof(endings[0]);
+
+  std::srand(4);
+  for (int run = 0; run < 50000; run++) {
+    std::string word(std::rand() % 5, 'a' + std::rand() % 26);
+    word += endings[std::rand() % nEndings];
+    const size_t start = std::rand() % (word.size() + 1);
+
+    expectSameAsLinear(twittok::porter2::Step2Rules, twittok::porter2::Step2Table, word, start);
+    expectSameAsLinear(twittok::porter2::Step3Rules, twittok::porter2::Step3Table, word, start);
+    expectSameAsLinear(twittok::porter2::Step4Rules, twittok::porter2::Step4Table, word, start);
+  }
+}
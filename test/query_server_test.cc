@@ -0,0 +1,192 @@
+#include "query_server.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+using twittok::NgramIndex;
+using twittok::NgramIndexBuilder;
+using twittok::NgramInfo;
+using twittok::NgramQueryEngine;
+using twittok::QueryServer;
+using twittok::ResultsBlock;
+
+namespace {
+
+std::string
+frame(const std::string& message)
+{
+  const uint32_t size = message.size();
+  return std::string(reinterpret_cast<const char*>(&size), sizeof(size)) + message;
+}
+
+/**
+ * A blocking client.
+ */
+class Client {
+public:
+  Client(const std::string& socketPath) : fd_(socket(AF_UNIX, SOCK_STREAM, 0)) {
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    memcpy(address.sun_path, socketPath.data(), socketPath.size());
+    if (connect(fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == -1) {
+      close(fd_);
+      fd_ = -1;
+    }
+  }
+
+  ~Client() { if (fd_ != -1) close(fd_); }
+
+  inline bool connected() const { return fd_ != -1; }
+
+  bool send(const std::string& bytes) {
+    return write(fd_, bytes.data(), bytes.size()) == static_cast<ssize_t>(bytes.size());
+  }
+
+  void shutdownWrite() { shutdown(fd_, SHUT_WR); }
+
+  /**
+   * Reads a response, or returns false if the server hung up.
+   */
+  bool receive(std::string* response) {
+    uint32_t size;
+    if (!readAll(reinterpret_cast<char*>(&size), sizeof(size))) return false;
+    response->resize(size);
+    return readAll(&(*response)[0], size);
+  }
+
+private:
+  bool readAll(char* data, size_t size) {
+    while (size > 0) {
+      const ssize_t nRead = read(fd_, data, size);
+      if (nRead <= 0) return false;
+      data += nRead;
+      size -= nRead;
+    }
+    return true;
+  }
+
+  int fd_;
+};
+
+} // namespace ""
+
+class QueryServerTest : public ::testing::Test {
+protected:
+  QueryServerTest() : socketPath("/tmp/twittok-query-server-test-" + std::to_string(getpid()) + ".sock") {
+    ResultsBlock unigrams(1);
+    NgramInfo info = NgramInfo();
+    info.nClinton = 300;
+    info.nTrump = 200;
+    info.nBoth = 100;
+    unigrams.addRecord(info, "mom", 3);
+    unigrams.addSpelling("mom", 3, 300);
+
+    NgramIndexBuilder builder;
+    builder.addBlock(unigrams);
+    std::ostringstream os;
+    builder.write(os);
+    const std::string bytes = os.str();
+    aligned.resize((bytes.size() + 7) / 8); // NgramIndex reads uint64_ts in place
+    memcpy(aligned.data(), bytes.data(), bytes.size());
+
+    index.reset(new NgramIndex(reinterpret_cast<const char*>(aligned.data()), bytes.size()));
+    engine.reset(new NgramQueryEngine(*index));
+    server.reset(new QueryServer(*engine, socketPath.c_str(), 4));
+    serverThread = std::thread([this]() { server->run(); });
+  }
+
+  ~QueryServerTest() {
+    server->stop();
+    serverThread.join();
+  }
+
+  std::string socketPath;
+  std::vector<uint64_t> aligned;
+  std::unique_ptr<NgramIndex> index;
+  std::unique_ptr<NgramQueryEngine> engine;
+  std::unique_ptr<QueryServer> server;
+  std::thread serverThread;
+};
+
+TEST_F(QueryServerTest, answers_pipelined_requests_in_order) {
+  Client client(socketPath);
+  ASSERT_TRUE(client.connected());
+  ASSERT_TRUE(client.send(frame("lookup\nMoms") + frame("frobnicate") + frame("lookup\ndad")));
+
+  std::string response;
+  ASSERT_TRUE(client.receive(&response));
+  EXPECT_EQ("ok\nmom\t400\t300\t200\t100\t0\tmom\n", response);
+  ASSERT_TRUE(client.receive(&response));
+  EXPECT_EQ(0, response.compare(0, 6, "error\t"));
+  ASSERT_TRUE(client.receive(&response));
+  EXPECT_EQ("ok\ndad\t0\t0\t0\t0\t0\t\n", response);
+}
+
+TEST_F(QueryServerTest, answers_request_split_across_writes) {
+  Client client(socketPath);
+  ASSERT_TRUE(client.connected());
+
+  const std::string request = frame("top clinton 1");
+  for (const char c : request) {
+    ASSERT_TRUE(client.send(std::string(1, c)));
+  }
+
+  std::string response;
+  ASSERT_TRUE(client.receive(&response));
+  EXPECT_EQ("ok\nmom\t400\t300\t200\t100\t0\tmom\n", response);
+}
+
+TEST_F(QueryServerTest, answers_clients_in_parallel) {
+  const size_t NClients = 8;
+  std::vector<int> nRight(NClients, 0);
+  std::vector<std::thread> clients;
+
+  for (size_t i = 0; i < NClients; i++) {
+    clients.emplace_back([&, i]() {
+      Client client(socketPath);
+      std::string response;
+      for (int j = 0; j < 100; j++) {
+        if (!client.send(frame("lookup\nmom\nmoms"))) return;
+        if (!client.receive(&response)) return;
+        if (response == "ok\nmom\t400\t300\t200\t100\t0\tmom\nmom\t400\t300\t200\t100\t0\tmom\n") nRight[i]++;
+      }
+    });
+  }
+  for (auto& client : clients) client.join();
+
+  for (size_t i = 0; i < NClients; i++) EXPECT_EQ(100, nRight[i]) << "client " << i;
+}
+
+TEST_F(QueryServerTest, answers_after_client_stops_writing) {
+  Client client(socketPath);
+  ASSERT_TRUE(client.connected());
+  ASSERT_TRUE(client.send(frame("lookup\nmom") + frame("lookup\nmom").substr(0, 5)));
+  client.shutdownWrite();
+
+  std::string response;
+  ASSERT_TRUE(client.receive(&response));
+  EXPECT_EQ("ok\nmom\t400\t300\t200\t100\t0\tmom\n", response);
+  EXPECT_FALSE(client.receive(&response)); // the half-sent request never finishes
+}
+
+TEST_F(QueryServerTest, hangs_up_on_huge_request) {
+  Client client(socketPath);
+  ASSERT_TRUE(client.connected());
+
+  const uint32_t size = QueryServer::MaxRequestSize + 1;
+  ASSERT_TRUE(client.send(std::string(reinterpret_cast<const char*>(&size), sizeof(size))));
+
+  std::string response;
+  EXPECT_FALSE(client.receive(&response));
+}
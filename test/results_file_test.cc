@@ -0,0 +1,215 @@
+#include "results_file.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "bio_store.h"
+#include "ngram_pass.h"
+
+using twittok::BioCounts;
+using twittok::BioStore;
+using twittok::NgramInfo;
+using twittok::NgramPass;
+using twittok::ResultsBlock;
+using twittok::ResultsFormat;
+using twittok::Tokenizer;
+using twittok::UntokenizedBioRef;
+using twittok::Vocabulary;
+
+namespace {
+
+NgramInfo
+makeInfo(size_t nClinton, size_t nTrump, size_t nBoth)
+{
+  NgramInfo info = NgramInfo();
+  info.nClinton = nClinton;
+  info.nTrump = nTrump;
+  info.nBoth = nBoth;
+  return info;
+}
+
+} // namespace ""
+
+class ResultsFileTest : public ::testing::Test {
+protected:
+  ResultsFileTest() : store(vocabulary) {
+    const char* texts[] = {
+      "Proud mom and wife",
+      "proud MOM, wife",
+      "proud\nmom", // the text format can't hold this spelling of "proud mom"
+      "proud\nmom",
+      "Mom of 3 | wife",
+      "",
+    };
+
+    for (size_t i = 0; i < 300; i++) {
+      const UntokenizedBioRef bio(i + 1, i % 2 == 0, i % 3 == 0, texts[i % (sizeof(texts) / sizeof(texts[0]))]);
+      counts.add(bio);
+      if (!bio.empty()) store.add(bio, tokenizer);
+    }
+  }
+
+  /**
+   * Writes what twittok would: counts, then passes 1 and 2.
+   */
+  std::string dump(ResultsFormat format, size_t nThreads) {
+    std::ostringstream os;
+    if (format == ResultsFormat::Text) {
+      counts.dump(os);
+    } else {
+      twittok::writeBinaryResultsHeader(os, counts);
+    }
+
+    NgramPass<1> pass1((NgramPass<1>::PrefixSet()));
+    pass1.scanBios(store);
+    pass1.dump(os, vocabulary, 10, nThreads, format);
+
+    NgramPass<2> pass2(pass1.ngramKeys(10));
+    pass2.scanBios(store);
+    pass2.dump(os, vocabulary, 10, nThreads, format);
+
+    return os.str();
+  }
+
+  Tokenizer tokenizer;
+  Vocabulary vocabulary;
+  BioStore store;
+  BioCounts counts;
+};
+
+TEST_F(ResultsFileTest, binary_converts_to_text) {
+  const std::string text = dump(ResultsFormat::Text, 1);
+
+  for (size_t nThreads = 1; nThreads <= 3; nThreads++) {
+    std::istringstream is(dump(ResultsFormat::Binary, nThreads));
+    std::ostringstream converted;
+    twittok::readBinaryResultsHeader(is).dump(converted);
+
+    ResultsBlock block;
+    std::vector<uint64_t> ngramSizes;
+    while (block.read(is)) {
+      ngramSizes.push_back(block.ngramSize);
+      block.writeText(converted);
+    }
+
+    EXPECT_EQ(text, converted.str()) << nThreads << " threads";
+    EXPECT_EQ(std::vector<uint64_t>({ 1, 2 }), ngramSizes);
+  }
+}
+
+TEST_F(ResultsFileTest, binary_keeps_spellings_with_newlines) {
+  std::istringstream is(dump(ResultsFormat::Binary, 1));
+  twittok::readBinaryResultsHeader(is);
+
+  ResultsBlock block;
+  ASSERT_TRUE(block.read(is)); // unigrams
+  ASSERT_TRUE(block.read(is)); // bigrams
+
+  std::vector<std::string> spellings;
+  for (size_t j = 0; j < block.nSpellings(); j++) {
+    spellings.push_back(std::string(block.strings.data() + block.stringBegin[j], block.stringBegin[j + 1] - block.stringBegin[j]));
+  }
+  EXPECT_NE(spellings.end(), std::find(spellings.begin(), spellings.end(), "proud\nmom"));
+  EXPECT_NE(spellings.end(), std::find(spellings.begin(), spellings.end(), "Proud mom"));
+
+  EXPECT_EQ(std::string::npos, dump(ResultsFormat::Text, 1).find("proud\nmom"));
+}
+
+TEST_F(ResultsFileTest, header_round_trips) {
+  std::stringstream ss;
+  twittok::writeBinaryResultsHeader(ss, counts);
+  const BioCounts read = twittok::readBinaryResultsHeader(ss);
+
+  EXPECT_EQ(counts.n(), read.n());
+  EXPECT_EQ(counts.nClinton, read.nClinton);
+  EXPECT_EQ(counts.nTrump, read.nTrump);
+  EXPECT_EQ(counts.nBoth, read.nBoth);
+  EXPECT_EQ(counts.nWithBio(), read.nWithBio());
+  EXPECT_EQ(counts.nClintonWithBio, read.nClintonWithBio);
+  EXPECT_EQ(counts.nTrumpWithBio, read.nTrumpWithBio);
+  EXPECT_EQ(counts.nBothWithBio, read.nBothWithBio);
+}
+
+TEST(ResultsBlockTest, append_and_round_trip) {
+  ResultsBlock a(2);
+  a.addRecord(makeInfo(30, 20, 10), "proud mom", 9);
+  a.addSpelling("Proud mom", 9, 25);
+  a.addSpelling("proud\tmom", 9, 15);
+
+  ResultsBlock b(2);
+  b.addRecord(makeInfo(12, 0, 0), "mom of", 6);
+  b.addSpelling("mom of", 6, 12);
+  b.addRecord(makeInfo(0, 11, 0), "wife and", 8);
+  b.addSpelling("wife and", 8, 11);
+
+  a.append(b);
+  ASSERT_EQ(3, a.size());
+  ASSERT_EQ(4, a.nSpellings());
+  EXPECT_EQ(std::vector<uint64_t>({ 40, 12, 11 }), a.n);
+  EXPECT_EQ(std::vector<uint64_t>({ 0, 9, 15, 23 }), a.keyBegin);
+  EXPECT_EQ(std::vector<uint64_t>({ 0, 2, 3, 4 }), a.spellingBegin);
+  EXPECT_EQ(std::vector<uint64_t>({ 25, 15, 12, 11 }), a.spellingN);
+  EXPECT_EQ(std::vector<uint64_t>({ 0, 9, 18, 24, 32 }), a.stringBegin);
+
+  std::stringstream ss;
+  a.write(ss);
+  ResultsBlock read;
+  ASSERT_TRUE(read.read(ss));
+  EXPECT_EQ(2, read.ngramSize);
+  EXPECT_EQ(a.n, read.n);
+  EXPECT_EQ(a.nClinton, read.nClinton);
+  EXPECT_EQ(a.nTrump, read.nTrump);
+  EXPECT_EQ(a.nBoth, read.nBoth);
+  EXPECT_EQ(a.nVariants, read.nVariants);
+  EXPECT_EQ(a.keyBegin, read.keyBegin);
+  EXPECT_EQ(a.spellingBegin, read.spellingBegin);
+  EXPECT_EQ(a.spellingN, read.spellingN);
+  EXPECT_EQ(a.stringBegin, read.stringBegin);
+  EXPECT_EQ(a.keys, read.keys);
+  EXPECT_EQ(a.strings, read.strings);
+  EXPECT_FALSE(read.read(ss));
+
+  std::ostringstream text;
+  read.writeText(text);
+  EXPECT_EQ("30\t20\t10\t0\nProud mom\n12\t0\t0\t0\nmom of\n0\t11\t0\t0\nwife and\n", text.str());
+}
+
+TEST(ResultsBlockTest, rejects_bad_input) {
+  ResultsBlock block(1);
+  block.addRecord(makeInfo(10, 0, 0), "wife", 4);
+  block.addSpelling("wife", 4, 10);
+
+  std::ostringstream os;
+  block.write(os);
+  const std::string bytes = os.str();
+
+  std::istringstream truncated(bytes.substr(0, bytes.size() - 1));
+  EXPECT_THROW(ResultsBlock().read(truncated), std::runtime_error);
+
+  // Start the first string at 1 instead of 0
+  std::string corrupt(bytes);
+  corrupt[corrupt.size() - 4 - 4 - 16] = 1;
+  std::istringstream corrupted(corrupt);
+  EXPECT_THROW(ResultsBlock().read(corrupted), std::runtime_error);
+
+  // Claim more records, spellings or bytes than the stream holds: we must
+  // throw, not allocate them
+  for (const size_t field : { 1, 2, 3, 4 }) {
+    for (const uint64_t size : { static_cast<uint64_t>(1) << 40, UINT64_MAX / 8, UINT64_MAX }) {
+      std::string huge(bytes);
+      memcpy(&huge[field * sizeof(uint64_t)], &size, sizeof(size));
+      std::istringstream hugeHeader(huge);
+      EXPECT_THROW(ResultsBlock().read(hugeHeader), std::runtime_error) << field << ": " << size;
+    }
+  }
+
+  std::istringstream text("n: 3\nnClinton: 3\n");
+  EXPECT_THROW(twittok::readBinaryResultsHeader(text), std::runtime_error);
+}
@@ -0,0 +1,85 @@
+#include "stem_cache.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "stemmer.h"
+
+using twittok::StemCache;
+using twittok::TokenId;
+using twittok::Vocabulary;
+
+namespace {
+
+std::string
+stemViaCache(StemCache& cache, const std::string& token)
+{
+  TokenId id;
+  if (!cache.stem(token.data(), token.size(), &id)) return std::string();
+  return cache.vocabulary().string(id);
+}
+
+} // namespace
+
+TEST(StemCacheTest, stems) {
+  Vocabulary vocabulary;
+  StemCache cache(vocabulary);
+
+  EXPECT_EQ("run", stemViaCache(cache, "running"));
+  EXPECT_EQ("#maga", stemViaCache(cache, "#MAGA"));
+  EXPECT_EQ("", stemViaCache(cache, "..."));
+  EXPECT_EQ("", stemViaCache(cache, "http://example.com"));
+}
+
+TEST(StemCacheTest, counts_hits_and_misses) {
+  Vocabulary vocabulary;
+  StemCache cache(vocabulary);
+
+  stemViaCache(cache, "Running");
+  stemViaCache(cache, "running");
+  stemViaCache(cache, "Running");
+  stemViaCache(cache, "...");
+  stemViaCache(cache, "...");
+
+  EXPECT_EQ(2, cache.nHits());
+  EXPECT_EQ(3, cache.nMisses());
+  EXPECT_EQ(3, cache.size());
+  EXPECT_EQ(1, vocabulary.size()); // "Running" and "running" share a stem
+}
+
+TEST(StemCacheTest, bounded) {
+  Vocabulary vocabulary;
+  StemCache cache(vocabulary, 64); // one entry per shard
+
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_EQ(std::to_string(i), stemViaCache(cache, std::to_string(i)));
+  }
+
+  EXPECT_LE(cache.size(), 64);
+  EXPECT_EQ(1000, vocabulary.size());
+}
+
+TEST(StemCacheTest, matches_stemmer_across_threads) {
+  const char* words[] = { "Love", "love", "LOVING", "mom", "Mom", "#MAGA", "@realDonaldTrump", "café", "...", "2016", "wife", "dogs" };
+  const size_t nWords = sizeof(words) / sizeof(words[0]);
+
+  Vocabulary vocabulary;
+  StemCache cache(vocabulary);
+
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < 4; t++) {
+    threads.emplace_back([&]() {
+      for (int i = 0; i < 1000; i++) {
+        const std::string word(words[i % nWords]);
+        EXPECT_EQ(twittok::stemmer::stem(word.data(), word.size()), stemViaCache(cache, word));
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  EXPECT_EQ(4000, cache.nHits() + cache.nMisses());
+  EXPECT_EQ(nWords, cache.size());
+}
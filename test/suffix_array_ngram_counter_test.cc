@@ -0,0 +1,144 @@
+#include "suffix_array_ngram_counter.h"
+
+#include <cstdlib>
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "bio_deduplicator.h"
+#include "ngram_pass.h"
+
+using twittok::BioDeduplicator;
+using twittok::BioStore;
+using twittok::NgramPass;
+using twittok::SuffixArrayNgramCounter;
+using twittok::Tokenizer;
+using twittok::UntokenizedBioRef;
+using twittok::Vocabulary;
+
+namespace {
+
+template<size_t N>
+typename NgramPass<N>::NgramSet
+doPass(const typename NgramPass<N>::PrefixSet& prefixes, const BioStore& bios, std::ostream& os, size_t minCount)
+{
+  NgramPass<N> pass(prefixes);
+  pass.scanBios(bios);
+  pass.dump(os, bios.vocabulary(), minCount);
+  return pass.ngramKeys(minCount);
+}
+
+std::string
+dumpApriori(const BioStore& bios, size_t minCount)
+{
+  std::ostringstream os;
+  const auto grams1 = doPass<1>(NgramPass<1>::PrefixSet(), bios, os, minCount);
+  const auto grams2 = doPass<2>(grams1, bios, os, minCount);
+  const auto grams3 = doPass<3>(grams2, bios, os, minCount);
+  const auto grams4 = doPass<4>(grams3, bios, os, minCount);
+  const auto grams5 = doPass<5>(grams4, bios, os, minCount);
+  const auto grams6 = doPass<6>(grams5, bios, os, minCount);
+  const auto grams7 = doPass<7>(grams6, bios, os, minCount);
+  const auto grams8 = doPass<8>(grams7, bios, os, minCount);
+  const auto grams9 = doPass<9>(grams8, bios, os, minCount);
+  doPass<10>(grams9, bios, os, minCount);
+  return os.str();
+}
+
+std::string
+dumpSuffixArray(const BioStore& bios, size_t minCount, size_t nThreads)
+{
+  std::ostringstream os;
+  SuffixArrayNgramCounter counter(bios, minCount);
+  counter.count(nThreads);
+  counter.dump(os);
+  return os.str();
+}
+
+} // namespace ""
+
+class SuffixArrayNgramCounterTest : public ::testing::Test {
+protected:
+  SuffixArrayNgramCounterTest() : store(vocabulary) {}
+
+  void add(uint64_t id, const std::string& text) {
+    texts.push_back(text);
+    store.add(UntokenizedBioRef(id, id % 3 != 1, id % 3 != 0, texts.back()), tokenizer);
+  }
+
+  Tokenizer tokenizer;
+  Vocabulary vocabulary;
+  BioStore store;
+  std::vector<std::string> texts;
+};
+
+TEST_F(SuffixArrayNgramCounterTest, repeated_phrase) {
+  for (uint64_t id = 1; id <= 20; id++) add(id, "Proud mom of two, proud wife");
+
+  const std::string expected = dumpApriori(store, 5);
+  ASSERT_NE("", expected);
+  EXPECT_EQ(expected, dumpSuffixArray(store, 5, 1));
+}
+
+TEST_F(SuffixArrayNgramCounterTest, ngrams_stop_at_bio_boundaries) {
+  for (uint64_t id = 1; id <= 10; id++) add(id, id % 2 ? "one two" : "three four");
+
+  SuffixArrayNgramCounter counter(store, 5);
+  counter.count(1);
+  EXPECT_EQ(4, counter.nFrequent(1));
+  EXPECT_EQ(2, counter.nFrequent(2)); // not "two three" or "four one"
+  EXPECT_EQ(0, counter.nFrequent(3));
+}
+
+TEST_F(SuffixArrayNgramCounterTest, matches_apriori_on_random_bios) {
+  const char* words[] = {
+    "Mom", "mom", "wife", "Wife", "proud", "Proud", "American", "patriot",
+    "God", "family", "country", "#MAGA", "#ImWithHer", "Love", "love", "and",
+    "of", "the", "dogs", "Dog", "teacher", "nurse", "🇺🇸", "|", "NFL", "fan",
+  };
+  const size_t nWords = sizeof(words) / sizeof(words[0]);
+
+  std::srand(1);
+  for (uint64_t id = 1; id <= 3000; id++) {
+    std::string text;
+    const size_t nTokens = std::rand() % 15;
+    for (size_t i = 0; i < nTokens; i++) {
+      // Skew toward the first few words, so long ngrams repeat
+      const size_t word = std::min(std::rand() % nWords, std::rand() % nWords);
+      if (i > 0) text += ' ';
+      text += words[word];
+    }
+    add(id, text);
+  }
+
+  for (size_t minCount : { 2, 10, 50 }) {
+    const std::string expected = dumpApriori(store, minCount);
+    ASSERT_NE("", expected);
+    for (size_t nThreads = 1; nThreads <= 4; nThreads++) {
+      EXPECT_EQ(expected, dumpSuffixArray(store, minCount, nThreads)) << "minCount " << minCount << ", " << nThreads << " threads";
+    }
+  }
+}
+
+TEST_F(SuffixArrayNgramCounterTest, counts_weighted_bios) {
+  // Each text appears 30 times: with minCount 20, a deduplicated store has
+  // too few bios to pass pruning unless we count weights.
+  for (uint64_t id = 1; id <= 90; id++) {
+    add(id, id % 3 == 0 ? "Proud mom of two" : (id % 3 == 1 ? "proud wife and mom" : "God family country"));
+  }
+
+  BioDeduplicator deduplicator;
+  for (size_t i = 0; i < store.size(); i++) {
+    deduplicator.add(UntokenizedBioRef(i + 1, (i + 1) % 3 != 1, (i + 1) % 3 != 0, texts[i]));
+  }
+  Vocabulary dedupVocabulary;
+  BioStore dedupStore(dedupVocabulary);
+  dedupStore.addBatch(deduplicator.bios().data(), deduplicator.weights().data(), deduplicator.bios().size(), tokenizer);
+  ASSERT_EQ(3, dedupStore.size());
+
+  const std::string expected = dumpApriori(store, 20);
+  ASSERT_NE("", expected);
+  EXPECT_EQ(expected, dumpApriori(dedupStore, 20));
+  EXPECT_EQ(expected, dumpSuffixArray(dedupStore, 20, 2));
+}
@@ -0,0 +1,130 @@
+#include "tokenizer.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using twittok::Tokenizer;
+
+namespace {
+
+std::vector<std::string>
+tokenize(const Tokenizer& tokenizer, const std::string& text)
+{
+  std::vector<std::string> ret;
+  for (const auto& token : tokenizer.tokenize(text)) ret.push_back(token.as_string());
+  return ret;
+}
+
+bool
+isAscii(const std::string& s)
+{
+  for (char c : s) {
+    if (static_cast<unsigned char>(c) >= 0x80) return false;
+  }
+  return true;
+}
+
+} // namespace
+
+class TokenizerTest : public testing::Test {
+protected:
+  TokenizerTest() : re2(Tokenizer::Backend::Re2), dfa(Tokenizer::Backend::Dfa) {}
+
+  void expectSame(const std::string& text) {
+    EXPECT_EQ(tokenize(re2, text), tokenize(dfa, text)) << text;
+  }
+
+  Tokenizer re2;
+  Tokenizer dfa;
+};
+
+TEST_F(TokenizerTest, tokens) {
+  const std::vector<std::string> expected = {
+    "Mom", "of", "3", ".", "#MAGA", "@realDonaldTrump", "http://example.com/a_(b)", ":)", "don't"
+  };
+  EXPECT_EQ(expected, tokenize(dfa, "Mom of 3. #MAGA @realDonaldTrump http://example.com/a_(b) :) don't"));
+}
+
+TEST_F(TokenizerTest, non_ascii_falls_back_to_re2) {
+  const std::vector<std::string> expected = { "Café", "lover", "🇺🇸", "#ImWithHer" };
+  EXPECT_EQ(expected, tokenize(dfa, "Café lover 🇺🇸 #ImWithHer"));
+}
+
+TEST_F(TokenizerTest, edge_cases) {
+  expectSame("");
+  expectSame(" ");
+  expectSame("a");
+  expectSame("8D 8Dogs Do8 <3 <-- --> ... !!! 1,000,000 +1 -5- U.S.A. e-mail rock'n'roll");
+  expectSame("www.example.com example.com/foo. https://t.co/abc?x=1&y=2, foo@bar.com a.b.c.xn--p1ai");
+  expectSame("@user/list-name @ @_ # #1 ## x:// http:// http://x");
+  expectSame(std::string("a\0b", 3)); // an embedded NUL
+  expectSame(std::string("\0\x01\x7f \t\r\n\v\f end", 13));
+  expectSame("tail with invalid utf-8 \xff\xfe and \xc3");
+}
+
+TEST_F(TokenizerTest, matches_re2_on_random_bios) {
+  // Bios made of realistic pieces, glued with and without whitespace, plus
+  // random bytes -- so the DFA sees every transition. Half the bios are
+  // pure ASCII, so the DFA decides every token; the rest fall back often.
+  const std::vector<std::string> pieces = {
+    "Mom", "wife", "lover", "of", "#MAGA", "#ImWithHer", "@HillaryClinton", "@user/list", "http://",
+    "https://", "www.", "example", ".com", "/path", "_(film)", "?q=1", "&a=b", ":)", ":-(", ";P", "8D",
+    "<3", "-->", "<--", "don't", "rock-n-roll", "snake_case", "2016", "1,000", "3.14", "+1", "-",
+    ".", "...", "!", "?", "'", "\"", "(", ")", "[", "]", "|", "/", "\\", "*", "café", "Zoë", "🇺🇸",
+    "❤️", "トランプ", "Привет", "\xc2\xa0", "\xe3\x80\x80", "\xff", "\t", "\n", " ", " ", " ", " "
+  };
+
+  std::mt19937 random(5);
+  for (int run = 0; run < 40000; run++) {
+    const bool asciiOnly = run % 2 == 0;
+    std::string bio;
+    const size_t nPieces = random() % 30;
+    for (size_t i = 0; i < nPieces; i++) {
+      if (random() % 10 == 0) {
+        bio += static_cast<char>(random() % (asciiOnly ? 128 : 256));
+      } else {
+        const std::string& piece(pieces[random() % pieces.size()]);
+        if (asciiOnly && !isAscii(piece)) continue;
+        bio += piece;
+      }
+    }
+
+    const auto expected = tokenize(re2, bio);
+    const auto actual = tokenize(dfa, bio);
+    ASSERT_EQ(expected, actual) << bio;
+  }
+}
+
+TEST_F(TokenizerTest, tokenize_appends) {
+  std::vector<Tokenizer::Token> tokens;
+  dfa.tokenize("Mom of 3", &tokens);
+  dfa.tokenize("#MAGA", &tokens);
+
+  ASSERT_EQ(4, tokens.size());
+  EXPECT_EQ("Mom", tokens[0].as_string());
+  EXPECT_EQ("3", tokens[2].as_string());
+  EXPECT_EQ("#MAGA", tokens[3].as_string());
+}
+
+TEST_F(TokenizerTest, tokenize_batch) {
+  const std::vector<std::string> texts = { "Mom of 3", "", "  ", "#MAGA @realDonaldTrump", "Café" };
+  const std::vector<re2::StringPiece> pieces(texts.begin(), texts.end());
+
+  Tokenizer::Batch batch;
+  dfa.tokenizeBatch(pieces.data(), 3, &batch);
+  dfa.tokenizeBatch(pieces.data() + 3, 2, &batch);
+
+  ASSERT_EQ(5, batch.size());
+  for (size_t i = 0; i < texts.size(); i++) {
+    std::vector<std::string> actual;
+    for (uint32_t t = batch.offsets[i]; t < batch.offsets[i + 1]; t++) actual.push_back(batch.tokens[t].as_string());
+    EXPECT_EQ(tokenize(dfa, texts[i]), actual) << texts[i];
+  }
+
+  batch.clear();
+  EXPECT_EQ(0, batch.size());
+  EXPECT_TRUE(batch.tokens.empty());
+}
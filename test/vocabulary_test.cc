@@ -0,0 +1,65 @@
+#include "vocabulary.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using twittok::TokenId;
+using twittok::Vocabulary;
+
+TEST(VocabularyTest, ids_are_dense) {
+  Vocabulary vocabulary;
+
+  EXPECT_EQ(0, vocabulary.intern("foo"));
+  EXPECT_EQ(1, vocabulary.intern("bar"));
+  EXPECT_EQ(0, vocabulary.intern("foo"));
+  EXPECT_EQ(2, vocabulary.size());
+}
+
+TEST(VocabularyTest, string) {
+  Vocabulary vocabulary;
+
+  const TokenId foo = vocabulary.intern("foo");
+  const TokenId empty = vocabulary.intern("");
+  EXPECT_EQ("foo", vocabulary.string(foo));
+  EXPECT_EQ("", vocabulary.string(empty));
+}
+
+TEST(VocabularyTest, many_chunks) {
+  Vocabulary vocabulary;
+
+  for (size_t i = 0; i < 200000; i++) {
+    ASSERT_EQ(i, vocabulary.intern(std::to_string(i)));
+  }
+  for (size_t i = 0; i < 200000; i += 997) {
+    ASSERT_EQ(std::to_string(i), vocabulary.string(i));
+  }
+}
+
+TEST(VocabularyTest, concurrent_intern) {
+  Vocabulary vocabulary;
+  const size_t NThreads = 4;
+  const size_t NStrings = 20000;
+  std::vector<std::vector<TokenId> > ids(NThreads, std::vector<TokenId>(NStrings));
+
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < NThreads; t++) {
+    threads.emplace_back([&vocabulary, &ids, t, NStrings]() {
+      for (size_t i = 0; i < NStrings; i++) {
+        const size_t n = (i * 7919 + t * 104729) % NStrings; // each thread in a different order
+        ids[t][n] = vocabulary.intern(std::to_string(n));
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  EXPECT_EQ(NStrings, vocabulary.size());
+  for (size_t i = 0; i < NStrings; i++) {
+    for (size_t t = 1; t < NThreads; t++) {
+      ASSERT_EQ(ids[0][i], ids[t][i]);
+    }
+    ASSERT_EQ(std::to_string(i), vocabulary.string(ids[0][i]));
+  }
+}